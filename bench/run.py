@@ -0,0 +1,182 @@
+#!/usr/bin/env python3
+
+"""Times the solver on a set of instances and checks its answers.
+
+Each instance is solved several times. Every run must give the expected
+result, and every model must satisfy the clauses. The median times and
+the search counters are written to a JSON file. When a baseline from an
+earlier run is given, instances that got slower by more than the allowed
+factor are reported, and the exit status is nonzero.
+"""
+
+import argparse
+import json
+import os
+import re
+import statistics
+import subprocess
+import sys
+
+# Differences below this many seconds are taken to be noise
+NOISE_FLOOR = 0.05
+
+STATS = {
+    'branches': re.compile(r'^c Attempted branches:\s*(\d+)'),
+    'propagations': re.compile(r'^c Unit propagations:\s*(\d+)'),
+    'conflicts': re.compile(r'^c Conflicts:\s*(\d+)'),
+}
+
+
+def read_instances(path, root):
+    instances = []
+    with open(path) as stream:
+        for line in stream:
+            line = line.split('#', 1)[0].strip()
+            if line:
+                name, expected = line.split()
+                instances.append((name, os.path.join(root, name), expected))
+    return instances
+
+
+def read_clauses(path):
+    clauses = []
+    clause = []
+    with open(path) as stream:
+        for line in stream:
+            if line.startswith(('c', 'p', '%')):
+                continue
+            for token in line.split():
+                lit = int(token)
+                if lit == 0:
+                    clauses.append(clause)
+                    clause = []
+                else:
+                    clause.append(lit)
+    if clause:
+        clauses.append(clause)
+    return clauses
+
+
+def check_model(clauses, model):
+    true_lits = set(model)
+    for clause in clauses:
+        if not any(lit in true_lits for lit in clause):
+            return clause
+    return None
+
+
+def solve(solver, args, path):
+    """Runs the solver once, returning its result and statistics."""
+    process = subprocess.run([solver] + args + [path],
+                             capture_output=True, text=True)
+    result = {'status': None, 'model': [], 'stats': {}}
+    for line in process.stdout.splitlines():
+        if line.startswith('s '):
+            result['status'] = line[2:].strip()
+        elif line.startswith('v '):
+            result['model'] += [int(x) for x in line[2:].split() if x != '0']
+        elif line.startswith('c Elapsed time:'):
+            result['time'] = float(line.split(':')[1].split()[0])
+        for name, pattern in STATS.items():
+            match = pattern.match(line)
+            if match:
+                result['stats'][name] = int(match.group(1))
+    return result
+
+
+def run_instance(solver, args, runs, name, path, expected):
+    times = []
+    stats = {}
+    clauses = read_clauses(path)
+
+    for _ in range(runs):
+        result = solve(solver, args, path)
+        if result['status'] != expected:
+            raise RuntimeError('%s: expected %s, got %s'
+                               % (name, expected, result['status']))
+        if expected == 'SATISFIABLE':
+            falsified = check_model(clauses, result['model'])
+            if falsified is not None:
+                raise RuntimeError('%s: model falsifies clause %s'
+                                   % (name, falsified))
+        times.append(result['time'])
+        stats = result['stats']
+
+    entry = {
+        'result': expected,
+        'median_time': statistics.median(times),
+        'min_time': min(times),
+        'max_time': max(times),
+    }
+    entry.update(stats)
+    return entry
+
+
+def compare(results, baseline, slowdown):
+    regressions = []
+    for name, entry in sorted(results.items()):
+        before = baseline.get(name)
+        if before is None:
+            continue
+        old = before['median_time']
+        new = entry['median_time']
+        if new - old > NOISE_FLOOR and new > old * slowdown:
+            regressions.append('%s: %.3f s -> %.3f s (%.2fx)'
+                               % (name, old, new, new / max(old, 0.001)))
+    return regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('--solver', required=True,
+                        help='path of the simplesat program')
+    parser.add_argument('--instances', required=True,
+                        help='file listing instances and expected results')
+    parser.add_argument('--root', default='.',
+                        help='directory the instance paths are relative to')
+    parser.add_argument('--runs', type=int, default=3,
+                        help='times each instance is solved (default 3)')
+    parser.add_argument('--output', default='bench.json',
+                        help='JSON file to write the results to')
+    parser.add_argument('--baseline', default='',
+                        help='JSON results of an earlier run to compare to')
+    parser.add_argument('--slowdown', type=float, default=1.25,
+                        help='largest factor an instance may slow down by '
+                             '(default 1.25)')
+    parser.add_argument('solver_args', nargs='*',
+                        help='options passed on to the solver, after --')
+    opts = parser.parse_args()
+
+    results = {}
+    try:
+        for name, path, expected in read_instances(opts.instances,
+                                                   opts.root):
+            entry = run_instance(opts.solver, opts.solver_args, opts.runs,
+                                 name, path, expected)
+            results[name] = entry
+            print('%-28s %-14s %8.3f s %10d branches %12d propagations'
+                  % (name, expected, entry['median_time'],
+                     entry.get('branches', 0), entry.get('propagations', 0)))
+    except RuntimeError as error:
+        print('FAIL', error, file=sys.stderr)
+        return 1
+
+    with open(opts.output, 'w') as stream:
+        json.dump({'solver_args': opts.solver_args, 'runs': opts.runs,
+                   'instances': results}, stream, indent=2, sort_keys=True)
+        stream.write('\n')
+
+    if opts.baseline:
+        with open(opts.baseline) as stream:
+            baseline = json.load(stream)['instances']
+        regressions = compare(results, baseline, opts.slowdown)
+        for regression in regressions:
+            print('SLOWER', regression, file=sys.stderr)
+        if regressions:
+            return 1
+
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,266 @@
+
+#include "batch.h"
+
+#include <errno.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "constants.h"
+#include "error.h"
+#include "format.h"
+#include "problem.h"
+#include "reader.h"
+#include "solver.h"
+#include "utils.h"
+#include "workers.h"
+
+// How often running instances are checked against the time limit
+#define BATCH_POLL_NSEC 10000000L
+
+typedef struct
+{
+    Batch *batch;
+    unsigned int index;
+}
+BatchTask;
+
+static void *run_batch_worker(void *);
+static void solve_instance(Batch *, unsigned int, const char *);
+static void watch_workers(Batch *);
+
+void create_batch(Batch *batch,
+                  const SolverConfig *config,
+                  unsigned int num_workers,
+                  double time_limit,
+                  FILE *stream)
+{
+    unsigned int i;
+
+    batch->n_files = 0;
+    batch->c_files = 16;
+    CREATE_ARRAY(batch->files, batch->c_files);
+
+    batch->config = *config;
+    batch->time_limit = time_limit;
+
+    batch->n_workers = num_workers > 0 ? num_workers : 1;
+    CREATE_ARRAY(batch->workers, batch->n_workers);
+    for (i = 0; i < batch->n_workers; ++i) {
+        batch->workers[i].busy = false;
+        batch->workers[i].start_time = 0.0;
+        atomic_init(&batch->workers[i].stop, false);
+        create_region(&batch->workers[i].region);
+    }
+
+    atomic_init(&batch->next_file, 0);
+    atomic_init(&batch->n_running, 0);
+
+    pthread_mutex_init(&batch->lock, NULL);
+    batch->stream = stream;
+}
+
+void delete_batch(Batch *batch)
+{
+    unsigned int i;
+
+    for (i = 0; i < batch->n_files; ++i) {
+        DELETE_ARRAY(batch->files[i]);
+    }
+
+    DELETE_ARRAY(batch->files);
+
+    for (i = 0; i < batch->n_workers; ++i) {
+        delete_region(&batch->workers[i].region);
+    }
+    DELETE_ARRAY(batch->workers);
+
+    pthread_mutex_destroy(&batch->lock);
+}
+
+void add_batch_file(Batch *batch, const char *path)
+{
+    size_t length = strlen(path);
+
+    if (batch->n_files == batch->c_files) {
+        batch->c_files *= 2;
+        RESIZE_ARRAY(batch->files, batch->c_files);
+    }
+
+    CREATE_ARRAY(batch->files[batch->n_files], length + 1);
+    memcpy(batch->files[batch->n_files], path, length + 1);
+    batch->n_files += 1;
+}
+
+Error read_manifest(Batch *batch, FILE *stream)
+{
+    char *line = NULL;
+    size_t c_line = 0;
+    ssize_t length;
+
+    while ((length = getline(&line, &c_line, stream)) != -1) {
+
+        // Trailing whitespace, including the newline, is not
+        // part of the path, and blank lines are skipped
+        while (length > 0 && strchr(" \t\r\n", line[length - 1]) != NULL) {
+            line[--length] = '\0';
+        }
+
+        if (length > 0) {
+            add_batch_file(batch, line);
+        }
+    }
+
+    free(line);
+
+    if (ferror(stream)) {
+        fprintf(stderr, PROGRAM_NAME ": Cannot read manifest: %s\n",
+                strerror(errno));
+        return ERROR_FILE_ACCESS;
+    }
+
+    return ERROR_OK;
+}
+
+void run_batch(Batch *batch)
+{
+    pthread_t *threads;
+    BatchTask *tasks;
+    unsigned int n_started;
+    unsigned int i;
+
+    CREATE_ARRAY(threads, batch->n_workers);
+    CREATE_ARRAY(tasks, batch->n_workers);
+
+    /*
+     * 1. Start a thread for every worker
+     */
+
+    atomic_store(&batch->n_running, batch->n_workers);
+
+    for (i = 0; i < batch->n_workers; ++i) {
+        tasks[i].batch = batch;
+        tasks[i].index = i;
+    }
+
+    n_started = start_threads(threads, run_batch_worker, tasks,
+                              sizeof(*tasks), 0, batch->n_workers);
+
+    atomic_fetch_sub(&batch->n_running, batch->n_workers - n_started);
+
+    /*
+     * 2. Keep the workers to the time limit until they are done
+     */
+
+    if (n_started == 0) {
+        // Without any threads the time limit cannot be kept
+        run_batch_worker(&tasks[0]);
+    } else if (batch->time_limit > 0.0) {
+        watch_workers(batch);
+    }
+
+    join_threads(threads, 0, n_started);
+
+    DELETE_ARRAY(threads);
+    DELETE_ARRAY(tasks);
+}
+
+static void *run_batch_worker(void *arg)
+{
+    BatchTask *task = arg;
+    Batch *batch = task->batch;
+    unsigned int file;
+
+    // Workers take the next instance nobody has started on
+    while ((file = atomic_fetch_add(&batch->next_file, 1)) <
+           batch->n_files) {
+        solve_instance(batch, task->index, batch->files[file]);
+    }
+
+    atomic_fetch_sub(&batch->n_running, 1);
+
+    return NULL;
+}
+
+static void solve_instance(Batch *batch,
+                           unsigned int index,
+                           const char *path)
+{
+    BatchWorker *worker = &batch->workers[index];
+    const char *status = "ERROR";
+    Problem problem;
+    Solver solver;
+    Reader reader;
+    double elapsed;
+    uint64_t branches = 0;
+    uint64_t unit_props = 0;
+
+    // The time limit counts from here, reading included
+    pthread_mutex_lock(&batch->lock);
+    worker->busy = true;
+    worker->start_time = wall_time();
+    atomic_store(&worker->stop, false);
+    pthread_mutex_unlock(&batch->lock);
+
+    if (open_reader(&reader, path)) {
+        goto finish;
+    }
+
+    if (read_problem(&problem, &reader)) {
+        close_reader(&reader);
+        goto finish;
+    }
+    close_reader(&reader);
+
+    create_solver_in(&solver, &problem, &worker->region);
+    solver.config = batch->config;
+    solver.worker = index;
+    solver.stop = &worker->stop;
+
+    solver.solution = solve(&solver);
+
+    status = status_name(solver.solution);
+    branches = solver.t_branches;
+    unit_props = solver.t_unit_props;
+
+    delete_solver(&solver);
+    reset_region(&worker->region);
+    delete_problem(&problem);
+
+finish:
+    pthread_mutex_lock(&batch->lock);
+    worker->busy = false;
+    elapsed = wall_time() - worker->start_time;
+    fprintf(batch->stream, "%s\t%s\t%.6f\t%" PRIu64 "\t%" PRIu64 "\n",
+            path, status, elapsed, branches, unit_props);
+    fflush(batch->stream);
+    pthread_mutex_unlock(&batch->lock);
+}
+
+static void watch_workers(Batch *batch)
+{
+    struct timespec pause = {0, BATCH_POLL_NSEC};
+    unsigned int i;
+
+    while (atomic_load(&batch->n_running) > 0) {
+
+        nanosleep(&pause, NULL);
+
+        // Instances over the limit give up where they are, and
+        // are reported as unknown along with their statistics
+        pthread_mutex_lock(&batch->lock);
+        for (i = 0; i < batch->n_workers; ++i) {
+            BatchWorker *worker = &batch->workers[i];
+            if (worker->busy &&
+                wall_time() - worker->start_time > batch->time_limit) {
+                atomic_store(&worker->stop, true);
+            }
+        }
+        pthread_mutex_unlock(&batch->lock);
+    }
+}
+
@@ -0,0 +1,72 @@
+
+#ifndef SIMPLESAT_BATCH_H
+#define SIMPLESAT_BATCH_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "error.h"
+#include "region.h"
+#include "solver.h"
+
+typedef struct
+{
+    // Whether an instance is being solved, and since when
+    bool busy;
+    double start_time;
+
+    // Set once the instance has run out of time
+    atomic_bool stop;
+
+    // Memory for each solver in turn, reset between instances
+    Region region;
+}
+BatchWorker;
+
+typedef struct
+{
+    // Paths of the instances, solved in the order given
+    unsigned int n_files;
+    unsigned int c_files;
+    char **files;
+
+    // Every instance is solved by a single solver with this
+    // configuration, for at most `time_limit` seconds if nonzero
+    SolverConfig config;
+    double time_limit;
+
+    unsigned int n_workers;
+    BatchWorker *workers;
+
+    // Index of the next instance to be taken by a worker,
+    // and the number of workers that have not yet run out
+    atomic_uint next_file;
+    atomic_uint n_running;
+
+    // Guards the timing of the workers and the results stream
+    pthread_mutex_t lock;
+    FILE *stream;
+}
+Batch;
+
+void create_batch(Batch *,
+                  const SolverConfig *,
+                  unsigned int,
+                  double,
+                  FILE *);
+void delete_batch(Batch *);
+
+void add_batch_file(Batch *, const char *);
+
+// Adds the path on each line of the stream that is not blank
+Error read_manifest(Batch *, FILE *);
+
+// Solves every instance, writing a line for each as it finishes:
+// the path, the status, the time taken in seconds, and the
+// numbers of branches and unit propagations, separated by tabs
+void run_batch(Batch *);
+
+#endif
+
@@ -0,0 +1,489 @@
+#include "component.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "preprocess.h"
+#include "problem.h"
+#include "solver.h"
+#include "utils.h"
+#include "workers.h"
+
+// Marks a variable outside every component
+#define COMPONENT_NONE ((unsigned int) -1)
+
+typedef struct
+{
+    ComponentPool *pool;
+    unsigned int index;
+}
+ComponentTask;
+
+typedef struct
+{
+    unsigned int n_clauses;
+    unsigned int component;
+}
+ComponentSize;
+
+static void find_components(ComponentPool *);
+static unsigned int find_root(unsigned int *, unsigned int);
+static int compare_sizes(const void *, const void *);
+static void solve_component(ComponentPool *, unsigned int, unsigned int);
+static void merge_models(ComponentPool *);
+static void *run_component_worker(void *);
+
+void create_component_pool(ComponentPool *pool,
+                           const Problem *problem,
+                           const SolverConfig *config,
+                           unsigned int num_workers)
+{
+    pool->problem = problem;
+    pool->config = *config;
+
+    // The components find their own XOR constraints
+    create_solver(&pool->root, problem);
+    pool->root.config = *config;
+    pool->root.config.gauss = false;
+
+    // The components are found once the clauses are simplified
+    pool->n_components = 0;
+    pool->var_starts = NULL;
+    pool->vars = NULL;
+    pool->clause_starts = NULL;
+    pool->clauses = NULL;
+    pool->indices = NULL;
+    pool->model = NULL;
+
+    pool->n_workers = num_workers > 0 ? num_workers : 1;
+
+    atomic_init(&pool->next, 0);
+    atomic_init(&pool->stop, false);
+    atomic_init(&pool->refuted, false);
+    atomic_init(&pool->abandoned, false);
+    pthread_mutex_init(&pool->lock, NULL);
+}
+
+void delete_component_pool(ComponentPool *pool)
+{
+    delete_solver(&pool->root);
+
+    DELETE_ARRAY(pool->var_starts);
+    DELETE_ARRAY(pool->vars);
+    DELETE_ARRAY(pool->clause_starts);
+    DELETE_ARRAY(pool->clauses);
+    DELETE_ARRAY(pool->indices);
+    DELETE_ARRAY(pool->model);
+
+    pthread_mutex_destroy(&pool->lock);
+}
+
+Solver *run_component_pool(ComponentPool *pool)
+{
+    Solver *root = &pool->root;
+    ComponentTask *tasks;
+    unsigned int i;
+
+    /*
+     * 1. Simplify the clauses and split them up
+     */
+
+    if (! start_search(root)) {
+        root->solution = SOLUTION_UNSATISFIABLE;
+        return root;
+    }
+
+    find_components(pool);
+
+    // There is no use in more workers than components
+    if (pool->n_workers > pool->n_components) {
+        pool->n_workers = pool->n_components > 0 ? pool->n_components : 1;
+    }
+
+    /*
+     * 2. Solve the components with a thread for each worker
+     *    but the first, which runs here
+     */
+
+    CREATE_ARRAY(tasks, pool->n_workers);
+
+    for (i = 0; i < pool->n_workers; ++i) {
+        tasks[i].pool = pool;
+        tasks[i].index = i;
+    }
+
+    // The workers that did start take the components of any that did not
+    run_workers(run_component_worker, tasks, sizeof(*tasks),
+                pool->n_workers);
+
+    DELETE_ARRAY(tasks);
+
+    /*
+     * 3. The problem is only satisfiable if every component is
+     */
+
+    if (atomic_load(&pool->refuted)) {
+        root->inconsistent = true;
+        root->solution = SOLUTION_UNSATISFIABLE;
+    } else if (atomic_load(&pool->abandoned)) {
+        root->solution = SOLUTION_UNKNOWN;
+    } else {
+        merge_models(pool);
+        root->solution = SOLUTION_SATISFIABLE;
+    }
+
+    return root;
+}
+
+static void find_components(ComponentPool *pool)
+{
+    const Solver *root = &pool->root;
+    unsigned int *parents;
+    unsigned int *firsts;
+    unsigned int *components;
+    unsigned int *ranks;
+    unsigned int *cursors;
+    ComponentSize *sizes;
+    unsigned int n_components;
+    unsigned int var;
+    unsigned int i;
+    unsigned int j;
+
+    /*
+     * 1. Join the variables of each clause still to be satisfied
+     */
+
+    CREATE_ARRAY(parents, root->n_vars);
+    for (var = 0; var < root->n_vars; ++var) {
+        parents[var] = var;
+    }
+
+    // Propagation leaves every such clause two unassigned literals,
+    // and the variable of the first stands for the clause afterwards
+    CREATE_ARRAY(firsts, root->n_clauses + 1);
+
+    for (i = 0; i < root->n_clauses; ++i) {
+
+        const ClauseState *cstate = get_clause(root, root->clauses[i]);
+        unsigned int first = COMPONENT_NONE;
+
+        for (j = 0; j < cstate->n_lits; ++j) {
+            if (root->values[cstate->lits[j]] == VALUE_TRUE) {
+                break;
+            }
+        }
+
+        // Clauses satisfied at level 0 stay satisfied
+        if (j < cstate->n_lits) {
+            firsts[i] = COMPONENT_NONE;
+            continue;
+        }
+
+        for (j = 0; j < cstate->n_lits; ++j) {
+
+            Literal lit = cstate->lits[j];
+            unsigned int a;
+            unsigned int b;
+
+            if (root->values[lit] != VALUE_UNSET) {
+                continue;
+            } else if (first == COMPONENT_NONE) {
+                first = var_from_lit(lit);
+                continue;
+            }
+
+            // The lower variable becomes the root of both sets
+            a = find_root(parents, first);
+            b = find_root(parents, var_from_lit(lit));
+            if (a < b) {
+                parents[b] = a;
+            } else if (b < a) {
+                parents[a] = b;
+            }
+        }
+
+        firsts[i] = first;
+    }
+
+    /*
+     * 2. Number the sets that have clauses, largest first
+     */
+
+    CREATE_ARRAY(components, root->n_vars);
+    for (var = 0; var < root->n_vars; ++var) {
+        components[var] = COMPONENT_NONE;
+    }
+
+    n_components = 0;
+    CREATE_ARRAY(sizes, root->n_vars);
+
+    for (i = 0; i < root->n_clauses; ++i) {
+
+        unsigned int set;
+
+        if (firsts[i] == COMPONENT_NONE) {
+            continue;
+        }
+
+        set = find_root(parents, firsts[i]);
+        if (components[set] == COMPONENT_NONE) {
+            components[set] = n_components;
+            sizes[n_components].n_clauses = 0;
+            sizes[n_components].component = n_components;
+            n_components += 1;
+        }
+        sizes[components[set]].n_clauses += 1;
+    }
+
+    // The largest components are handed out first, so that
+    // the workers are not left waiting on one at the end
+    qsort(sizes, n_components, sizeof(*sizes), compare_sizes);
+
+    CREATE_ARRAY(ranks, n_components + 1);
+    for (i = 0; i < n_components; ++i) {
+        ranks[sizes[i].component] = i;
+    }
+
+    // From here on every variable is labelled with its place in that
+    // order, or with none if it is in no component; each parent is a
+    // lower variable, so going down leaves the rest of a path intact
+    for (var = root->n_vars; var-- > 0; ) {
+        unsigned int set = components[find_root(parents, var)];
+        if (set != COMPONENT_NONE &&
+            root->values[var << 1] == VALUE_UNSET &&
+            ! root->vars[var].eliminated) {
+            parents[var] = ranks[set];
+        } else {
+            parents[var] = COMPONENT_NONE;
+        }
+    }
+
+    /*
+     * 3. Sort the variables and clauses by component
+     */
+
+    CREATE_ARRAY(pool->var_starts, n_components + 1);
+    CREATE_ARRAY(pool->clause_starts, n_components + 1);
+    for (i = 0; i <= n_components; ++i) {
+        pool->var_starts[i] = 0;
+        pool->clause_starts[i] = 0;
+    }
+
+    for (var = 0; var < root->n_vars; ++var) {
+        if (parents[var] != COMPONENT_NONE) {
+            pool->var_starts[parents[var] + 1] += 1;
+        }
+    }
+    for (i = 0; i < root->n_clauses; ++i) {
+        if (firsts[i] != COMPONENT_NONE) {
+            pool->clause_starts[parents[firsts[i]] + 1] += 1;
+        }
+    }
+    for (i = 0; i < n_components; ++i) {
+        pool->var_starts[i + 1] += pool->var_starts[i];
+        pool->clause_starts[i + 1] += pool->clause_starts[i];
+    }
+
+    CREATE_ARRAY(pool->vars, root->n_vars);
+    CREATE_ARRAY(pool->indices, root->n_vars);
+    CREATE_ARRAY(cursors, n_components + 1);
+
+    for (i = 0; i < n_components; ++i) {
+        cursors[i] = pool->var_starts[i];
+    }
+    for (var = 0; var < root->n_vars; ++var) {
+        unsigned int comp = parents[var];
+        if (comp != COMPONENT_NONE) {
+            pool->indices[var] = cursors[comp] - pool->var_starts[comp];
+            pool->vars[cursors[comp]++] = var;
+        }
+    }
+
+    CREATE_ARRAY(pool->clauses, root->n_clauses + 1);
+
+    for (i = 0; i < n_components; ++i) {
+        cursors[i] = pool->clause_starts[i];
+    }
+    for (i = 0; i < root->n_clauses; ++i) {
+        if (firsts[i] != COMPONENT_NONE) {
+            unsigned int comp = parents[firsts[i]];
+            pool->clauses[cursors[comp]++] = root->clauses[i];
+        }
+    }
+
+    pool->n_components = n_components;
+
+    // Variables left out of every component can take any value,
+    // so they are given the polarity the solver would try first
+    CREATE_ARRAY(pool->model, root->n_vars);
+    for (var = 0; var < root->n_vars; ++var) {
+        pool->model[var] = var << 1;
+        if (root->config.initial_phase != PHASE_POSITIVE) {
+            pool->model[var] = negate(pool->model[var]);
+        }
+    }
+
+    DELETE_ARRAY(parents);
+    DELETE_ARRAY(firsts);
+    DELETE_ARRAY(components);
+    DELETE_ARRAY(ranks);
+    DELETE_ARRAY(cursors);
+    DELETE_ARRAY(sizes);
+}
+
+static unsigned int find_root(unsigned int *parents, unsigned int var)
+{
+    // Halve the path on the way up
+    while (parents[var] != var) {
+        parents[var] = parents[parents[var]];
+        var = parents[var];
+    }
+
+    return var;
+}
+
+static int compare_sizes(const void *a, const void *b)
+{
+    const ComponentSize *x = a;
+    const ComponentSize *y = b;
+
+    // Most clauses first, then in order of appearance
+    if (x->n_clauses != y->n_clauses) {
+        return x->n_clauses < y->n_clauses ? 1 : -1;
+    } else {
+        return x->component < y->component ? -1 :
+               x->component > y->component;
+    }
+}
+
+static void solve_component(ComponentPool *pool,
+                            unsigned int comp,
+                            unsigned int index)
+{
+    Solver *root = &pool->root;
+    unsigned int first_var = pool->var_starts[comp];
+    unsigned int num_vars = pool->var_starts[comp + 1] - first_var;
+    unsigned int first_clause = pool->clause_starts[comp];
+    unsigned int num_clauses = pool->clause_starts[comp + 1] - first_clause;
+    Problem problem;
+    Solver solver;
+    Solution solution = SOLUTION_UNKNOWN;
+    unsigned int i;
+    unsigned int j;
+
+    /*
+     * 1. Copy out the clauses of the component, leaving
+     *    out the literals that are false at level 0
+     */
+
+    create_problem(&problem, num_vars, num_clauses);
+
+    for (i = first_clause; i < first_clause + num_clauses; ++i) {
+        const ClauseState *cstate = get_clause(root, pool->clauses[i]);
+        for (j = 0; j < cstate->n_lits; ++j) {
+            Literal lit = cstate->lits[j];
+            if (root->values[lit] == VALUE_UNSET) {
+                unsigned int local = pool->indices[var_from_lit(lit)];
+                push_problem_literal(&problem, (local << 1) | (lit & 1));
+            }
+        }
+        finish_problem_clause(&problem);
+    }
+
+    /*
+     * 2. Solve them with a solver of their own, within
+     *    whatever time is left of the whole search
+     */
+
+    create_solver(&solver, &problem);
+
+    // The root has already simplified these clauses
+    solver.config = pool->config;
+    solver.config.preprocess = false;
+    solver.worker = index;
+    solver.stop = &pool->stop;
+
+    if (pool->config.max_seconds > 0.0) {
+        solver.config.max_seconds = root->deadline - wall_time();
+    }
+
+    if (pool->config.max_seconds == 0.0 || solver.config.max_seconds > 0.0) {
+        solution = solve(&solver);
+    }
+
+    /*
+     * 3. Keep the values found, or stop the other workers,
+     *    since without this component there is no answer
+     */
+
+    if (solution == SOLUTION_SATISFIABLE) {
+        for (i = 0; i < num_vars; ++i) {
+            Literal lit = pool->vars[first_var + i] << 1;
+            if (solver.values[i << 1] != VALUE_TRUE) {
+                lit = negate(lit);
+            }
+            pool->model[var_from_lit(lit)] = lit;
+        }
+    } else if (solution == SOLUTION_UNSATISFIABLE) {
+        atomic_store(&pool->refuted, true);
+        atomic_store(&pool->stop, true);
+    } else {
+        atomic_store(&pool->abandoned, true);
+        atomic_store(&pool->stop, true);
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    root->n_learnts += solver.n_learnts;
+    root->t_branches += solver.t_branches;
+    root->t_unit_props += solver.t_unit_props;
+    root->t_conflicts += solver.t_conflicts;
+    root->t_restarts += solver.t_restarts;
+    root->t_flips += solver.t_flips;
+    root->t_failed += solver.t_failed;
+    root->t_hyper += solver.t_hyper;
+    root->t_vivified += solver.t_vivified;
+    root->t_deleted += solver.t_deleted;
+    pthread_mutex_unlock(&pool->lock);
+
+    delete_solver(&solver);
+    delete_problem(&problem);
+}
+
+static void merge_models(ComponentPool *pool)
+{
+    Solver *root = &pool->root;
+    unsigned int var;
+
+    // Each component's values are made facts of the root,
+    // which then gives the eliminated variables theirs
+    for (var = 0; var < root->n_vars; ++var) {
+        Literal lit = pool->model[var];
+        if (root->values[lit] == VALUE_UNSET &&
+            ! root->vars[var].eliminated) {
+            assign_literal(root, lit, CLAUSE_NONE);
+        }
+    }
+
+    extend_model(root);
+}
+
+static void *run_component_worker(void *arg)
+{
+    ComponentTask *task = arg;
+    ComponentPool *pool = task->pool;
+
+    while (! atomic_load_explicit(&pool->stop, memory_order_relaxed)) {
+
+        unsigned int comp = atomic_fetch_add(&pool->next, 1);
+
+        if (comp >= pool->n_components) {
+            break;
+        }
+
+        solve_component(pool, comp, task->index);
+    }
+
+    return NULL;
+}
@@ -0,0 +1,62 @@
+
+#ifndef SIMPLESAT_COMPONENT_H
+#define SIMPLESAT_COMPONENT_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+
+#include "problem.h"
+#include "solver.h"
+
+typedef struct
+{
+    const Problem *problem;
+    SolverConfig config;
+
+    // Solver that simplifies the clauses before they are split up,
+    // and that is given the values of every component in the end
+    Solver root;
+
+    // Variables and clauses of each component, each component ending
+    // where the next starts, with the most clauses first; variables
+    // are numbered from zero in the order they appear in their own
+    unsigned int n_components;
+    unsigned int *var_starts;
+    unsigned int *vars;
+    unsigned int *clause_starts;
+    ClauseRef *clauses;
+    unsigned int *indices;
+
+    // Literal that each variable was made true by the solver of its
+    // component, which workers only ever write for their own
+    Literal *model;
+
+    unsigned int n_workers;
+
+    // Next component to be taken by any worker
+    atomic_uint next;
+
+    // Set once a component has been refuted, after which the
+    // others are abandoned, or once one of them has been given up
+    atomic_bool stop;
+    atomic_bool refuted;
+    atomic_bool abandoned;
+
+    // Held while adding the statistics of a component to the root
+    pthread_mutex_t lock;
+}
+ComponentPool;
+
+void create_component_pool(ComponentPool *,
+                           const Problem *,
+                           const SolverConfig *,
+                           unsigned int);
+void delete_component_pool(ComponentPool *);
+
+// Splits the problem into parts that share no variables and solves
+// each on its own, returning the solver that holds the overall answer
+Solver *run_component_pool(ComponentPool *);
+
+#endif
+
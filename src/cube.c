@@ -0,0 +1,310 @@
+
+#include "cube.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+
+#include "exchange.h"
+#include "problem.h"
+#include "solver.h"
+#include "utils.h"
+#include "workers.h"
+
+typedef struct
+{
+    CubePool *pool;
+    unsigned int index;
+}
+CubeTask;
+
+static void split_problem(CubePool *, Solver *, unsigned int);
+static void add_cube(CubePool *, const Solver *);
+static void deal_cubes(CubePool *);
+static bool take_cube(CubePool *, unsigned int, unsigned int *);
+static void *run_cube_worker(void *);
+
+void create_cube_pool(CubePool *pool,
+                      const Problem *problem,
+                      const SolverConfig *config,
+                      unsigned int num_workers,
+                      unsigned int depth)
+{
+    unsigned int i;
+
+    pool->problem = problem;
+    pool->config = *config;
+
+    pool->depth = depth;
+    pool->n_cubes = 0;
+    pool->c_cubes = 16;
+    CREATE_ARRAY(pool->cube_starts, pool->c_cubes);
+    pool->cube_starts[0] = 0;
+    pool->n_lits = 0;
+    pool->c_lits = 16;
+    CREATE_ARRAY(pool->lits, pool->c_lits);
+
+    // The solvers are created by the threads that run them
+    pool->n_workers = num_workers > 0 ? num_workers : 1;
+    CREATE_ARRAY(pool->workers, pool->n_workers);
+    CREATE_ARRAY(pool->queues, pool->n_workers);
+    for (i = 0; i < pool->n_workers; ++i) {
+        pthread_mutex_init(&pool->queues[i].lock, NULL);
+        pool->queues[i].head = 0;
+        pool->queues[i].tail = 0;
+        pool->queues[i].cubes = NULL;
+    }
+
+    pool->sharing = pool->n_workers > 1 &&
+                    config->share_clauses &&
+                    config->search == SEARCH_CDCL;
+    if (pool->sharing) {
+        create_exchange(&pool->exchange, pool->n_workers);
+    }
+
+    atomic_init(&pool->winner, WINNER_NONE);
+    atomic_init(&pool->stop, false);
+    atomic_init(&pool->abandoned, WINNER_NONE);
+}
+
+void delete_cube_pool(CubePool *pool)
+{
+    unsigned int i;
+
+    for (i = 0; i < pool->n_workers; ++i) {
+        delete_solver(&pool->workers[i]);
+        pthread_mutex_destroy(&pool->queues[i].lock);
+        DELETE_ARRAY(pool->queues[i].cubes);
+    }
+
+    DELETE_ARRAY(pool->workers);
+    DELETE_ARRAY(pool->queues);
+    DELETE_ARRAY(pool->cube_starts);
+    DELETE_ARRAY(pool->lits);
+
+    if (pool->sharing) {
+        delete_exchange(&pool->exchange);
+    }
+}
+
+Solver *run_cube_pool(CubePool *pool)
+{
+    Solver splitter;
+    CubeTask *tasks;
+    unsigned int n_started;
+    unsigned int winner;
+    unsigned int i;
+
+    /*
+     * 1. Split the problem into cubes
+     */
+
+    // When the problem is refuted on the way there are no
+    // cubes at all, and each worker finds that out for itself
+    create_solver(&splitter, pool->problem);
+    splitter.config = pool->config;
+    if (start_search(&splitter)) {
+        split_problem(pool, &splitter, pool->depth);
+    }
+    delete_solver(&splitter);
+
+    deal_cubes(pool);
+
+    /*
+     * 2. Solve the cubes with a thread for each worker
+     *    but the first, which runs here
+     */
+
+    CREATE_ARRAY(tasks, pool->n_workers);
+
+    for (i = 0; i < pool->n_workers; ++i) {
+        tasks[i].pool = pool;
+        tasks[i].index = i;
+    }
+
+    // The workers that did start steal the cubes of any that did not
+    n_started = run_workers(run_cube_worker, tasks, sizeof(*tasks),
+                            pool->n_workers);
+
+    DELETE_ARRAY(tasks);
+
+    // Workers that never started have no solver to clean up
+    for (i = n_started; i < pool->n_workers; ++i) {
+        pthread_mutex_destroy(&pool->queues[i].lock);
+        DELETE_ARRAY(pool->queues[i].cubes);
+    }
+    pool->n_workers = n_started;
+
+    /*
+     * 3. Without a winner, every cube has been refuted,
+     *    unless a worker ran out of budget on one of them
+     */
+
+    winner = atomic_load(&pool->winner);
+    if (winner == WINNER_NONE) {
+        winner = atomic_load(&pool->abandoned);
+    }
+    if (winner == WINNER_NONE) {
+        pool->workers[0].solution = SOLUTION_UNSATISFIABLE;
+        winner = 0;
+    }
+
+    return &pool->workers[winner];
+}
+
+static void split_problem(CubePool *pool, Solver *solver, unsigned int depth)
+{
+    Literal lit;
+    unsigned int side;
+
+    // Stop at the requested depth, or once there is nothing to split on
+    if (depth == 0 || all_satisfied(solver)) {
+        add_cube(pool, solver);
+        return;
+    }
+
+    lit = choose_lookahead(solver);
+
+    for (side = 0; side < 2; ++side) {
+
+        make_decision(solver, side ? negate(lit) : lit);
+
+        // Branches refuted by propagation alone need no cube
+        if (propagate(solver) == CLAUSE_NONE) {
+            split_problem(pool, solver, depth - 1);
+        }
+
+        backtrack(solver, solver->n_levels - 1);
+    }
+}
+
+static void add_cube(CubePool *pool, const Solver *solver)
+{
+    unsigned int level;
+
+    // A cube is made of the decisions that led to it
+    for (level = 0; level < solver->n_levels; ++level) {
+        if (pool->n_lits == pool->c_lits) {
+            pool->c_lits *= 2;
+            RESIZE_ARRAY(pool->lits, pool->c_lits);
+        }
+        pool->lits[pool->n_lits++] =
+            solver->assigned[solver->level_starts[level]];
+    }
+
+    if (pool->n_cubes + 1 == pool->c_cubes) {
+        pool->c_cubes *= 2;
+        RESIZE_ARRAY(pool->cube_starts, pool->c_cubes);
+    }
+    pool->cube_starts[++pool->n_cubes] = pool->n_lits;
+}
+
+static void deal_cubes(CubePool *pool)
+{
+    unsigned int i;
+    unsigned int j;
+
+    // Neighbouring cubes share most of their decisions,
+    // so each worker starts out with a run of them
+    for (i = 0; i < pool->n_workers; ++i) {
+
+        CubeQueue *queue = &pool->queues[i];
+        unsigned int first = (unsigned long) pool->n_cubes * i /
+                             pool->n_workers;
+        unsigned int last = (unsigned long) pool->n_cubes * (i + 1) /
+                            pool->n_workers;
+
+        CREATE_ARRAY(queue->cubes, last - first + 1);
+        for (j = first; j < last; ++j) {
+            queue->cubes[j - first] = j;
+        }
+        queue->head = 0;
+        queue->tail = last - first;
+    }
+}
+
+static bool take_cube(CubePool *pool, unsigned int index, unsigned int *cube)
+{
+    CubeQueue *queue;
+    unsigned int i;
+    bool found = false;
+
+    if (atomic_load_explicit(&pool->stop, memory_order_relaxed)) {
+        return false;
+    }
+
+    /*
+     * 1. Take the next cube of this worker's own run
+     */
+
+    queue = &pool->queues[index];
+    pthread_mutex_lock(&queue->lock);
+    if (queue->head != queue->tail) {
+        *cube = queue->cubes[queue->head++];
+        found = true;
+    }
+    pthread_mutex_unlock(&queue->lock);
+
+    /*
+     * 2. Otherwise steal from the far end of another's
+     */
+
+    for (i = 1; i < pool->n_workers && ! found; ++i) {
+        queue = &pool->queues[(index + i) % pool->n_workers];
+        pthread_mutex_lock(&queue->lock);
+        if (queue->head != queue->tail) {
+            *cube = queue->cubes[--queue->tail];
+            found = true;
+        }
+        pthread_mutex_unlock(&queue->lock);
+    }
+
+    return found;
+}
+
+static void *run_cube_worker(void *arg)
+{
+    CubeTask *task = arg;
+    CubePool *pool = task->pool;
+    Solver *solver = &pool->workers[task->index];
+    unsigned int cube;
+
+    create_solver(solver, pool->problem);
+
+    solver->config = pool->config;
+    solver->worker = task->index;
+    solver->stop = &pool->stop;
+    if (pool->sharing) {
+        join_exchange(solver, &pool->exchange, task->index);
+    }
+
+    // Every worker simplifies the clauses the same way the
+    // splitter did, so the cubes never use eliminated variables
+    if (! start_search(solver)) {
+        solver->solution = SOLUTION_UNSATISFIABLE;
+        claim_winner(&pool->winner, &pool->stop, task->index);
+        return NULL;
+    }
+
+    while (take_cube(pool, task->index, &cube)) {
+
+        unsigned int start = pool->cube_starts[cube];
+        unsigned int num_lits = pool->cube_starts[cube + 1] - start;
+
+        // Learned clauses are kept from one cube to the next
+        solver->solution = solve_assuming(solver, &pool->lits[start],
+                                          num_lits);
+
+        if (solver->solution == SOLUTION_SATISFIABLE ||
+            solver->inconsistent) {
+            claim_winner(&pool->winner, &pool->stop, task->index);
+            break;
+        } else if (solver->solution == SOLUTION_UNKNOWN) {
+            atomic_store(&pool->abandoned, task->index);
+            break;
+        }
+    }
+
+    return NULL;
+}
+
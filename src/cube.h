@@ -0,0 +1,70 @@
+
+#ifndef SIMPLESAT_CUBE_H
+#define SIMPLESAT_CUBE_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+
+#include "exchange.h"
+#include "problem.h"
+#include "solver.h"
+
+typedef struct
+{
+    // Cubes waiting to be solved, taken from the front by the
+    // worker that owns them and from the back by the others
+    pthread_mutex_t lock;
+    unsigned int head;
+    unsigned int tail;
+    unsigned int *cubes;
+}
+CubeQueue;
+
+typedef struct
+{
+    const Problem *problem;
+    SolverConfig config;
+
+    // Literals of every cube, each cube ending where the next starts
+    unsigned int depth;
+    unsigned int n_cubes;
+    unsigned int c_cubes;
+    unsigned int *cube_starts;
+    unsigned int n_lits;
+    unsigned int c_lits;
+    Literal *lits;
+
+    // Each worker keeps one solver for all the cubes it takes
+    unsigned int n_workers;
+    Solver *workers;
+    CubeQueue *queues;
+
+    // Learned clauses traded between the workers, if enabled
+    bool sharing;
+    Exchange exchange;
+
+    // Worker that settled the whole problem, if any, after
+    // which the others abandon the cubes they are working on
+    atomic_uint winner;
+    atomic_bool stop;
+
+    // Worker that gave up on a cube, if any, without which
+    // the problem cannot be settled
+    atomic_uint abandoned;
+}
+CubePool;
+
+void create_cube_pool(CubePool *,
+                      const Problem *,
+                      const SolverConfig *,
+                      unsigned int,
+                      unsigned int);
+void delete_cube_pool(CubePool *);
+
+// Splits the problem and solves the cubes, returning
+// the solver whose answer holds for the whole problem
+Solver *run_cube_pool(CubePool *);
+
+#endif
+
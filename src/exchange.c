@@ -0,0 +1,120 @@
+
+#include "exchange.h"
+
+#include <assert.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+
+#include "problem.h"
+#include "utils.h"
+
+void create_exchange(Exchange *exchange, unsigned int num_rings)
+{
+    unsigned int i;
+    unsigned int j;
+
+    exchange->n_rings = num_rings;
+    CREATE_ARRAY(exchange->rings, num_rings);
+
+    for (i = 0; i < num_rings; ++i) {
+        ShareRing *ring = &exchange->rings[i];
+        atomic_init(&ring->head, 0);
+        for (j = 0; j < SHARE_RING_SIZE; ++j) {
+            atomic_init(&ring->slots[j].sequence, 0);
+        }
+    }
+}
+
+void delete_exchange(Exchange *exchange)
+{
+    DELETE_ARRAY(exchange->rings);
+}
+
+void export_clause(Exchange *exchange,
+                   unsigned int index,
+                   const Literal *lits,
+                   unsigned int num_lits,
+                   unsigned int lbd)
+{
+    ShareRing *ring = &exchange->rings[index];
+    unsigned int pos;
+    SharedSlot *slot;
+    unsigned int i;
+
+    assert(num_lits <= SHARE_MAX_LITS);
+
+    // Nobody else writes to the ring, so the head can be read plainly
+    pos = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    slot = &ring->slots[pos & (SHARE_RING_SIZE - 1)];
+
+    // Readers that see an odd sequence, or a different one
+    // after copying, know that the copy cannot be trusted
+    atomic_store_explicit(&slot->sequence, 2 * pos + 1,
+                          memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    atomic_store_explicit(&slot->lbd, lbd, memory_order_relaxed);
+    atomic_store_explicit(&slot->n_lits, num_lits, memory_order_relaxed);
+    for (i = 0; i < num_lits; ++i) {
+        atomic_store_explicit(&slot->lits[i], lits[i], memory_order_relaxed);
+    }
+
+    atomic_store_explicit(&slot->sequence, 2 * pos + 2,
+                          memory_order_release);
+    atomic_store_explicit(&ring->head, pos + 1, memory_order_release);
+}
+
+bool import_clause(Exchange *exchange,
+                   unsigned int index,
+                   unsigned int *cursor,
+                   SharedClause *clause)
+{
+    ShareRing *ring = &exchange->rings[index];
+    unsigned int head;
+
+    head = atomic_load_explicit(&ring->head, memory_order_acquire);
+
+    while (*cursor != head) {
+
+        unsigned int pos = *cursor;
+        SharedSlot *slot;
+        unsigned int before;
+        unsigned int after;
+        unsigned int i;
+
+        // Skip over the clauses that have already been overwritten
+        if (head - pos > SHARE_RING_SIZE) {
+            *cursor = head - SHARE_RING_SIZE;
+            continue;
+        }
+
+        slot = &ring->slots[pos & (SHARE_RING_SIZE - 1)];
+        *cursor = pos + 1;
+
+        before = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        if (before != 2 * pos + 2) {
+            continue;
+        }
+
+        clause->lbd = atomic_load_explicit(&slot->lbd,
+                                           memory_order_relaxed);
+        clause->n_lits = atomic_load_explicit(&slot->n_lits,
+                                              memory_order_relaxed);
+        if (clause->n_lits > SHARE_MAX_LITS) {
+            continue;
+        }
+        for (i = 0; i < clause->n_lits; ++i) {
+            clause->lits[i] = atomic_load_explicit(&slot->lits[i],
+                                                   memory_order_relaxed);
+        }
+
+        atomic_thread_fence(memory_order_acquire);
+        after = atomic_load_explicit(&slot->sequence, memory_order_relaxed);
+        if (after == before) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
@@ -0,0 +1,72 @@
+
+#ifndef SIMPLESAT_EXCHANGE_H
+#define SIMPLESAT_EXCHANGE_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+
+#include "problem.h"
+
+// Longest clause that fits in a slot of a ring
+#define SHARE_MAX_LITS 16
+
+// Slots in each ring, a power of two
+#define SHARE_RING_SIZE 4096
+
+typedef struct
+{
+    // Odd while the slot is being written, and otherwise
+    // twice the position of the clause it holds plus two
+    atomic_uint sequence;
+
+    atomic_uint lbd;
+    atomic_uint n_lits;
+    atomic_uint lits[SHARE_MAX_LITS];
+}
+SharedSlot;
+
+typedef struct
+{
+    // Clauses written so far, kept away from the slots so
+    // that readers polling it do not disturb the writer
+    atomic_uint head;
+    char padding[64 - sizeof(atomic_uint)];
+
+    SharedSlot slots[SHARE_RING_SIZE];
+}
+ShareRing;
+
+typedef struct
+{
+    // One ring for each worker, which only that worker writes to
+    // Old clauses are overwritten once a ring is full, so readers
+    // that fall behind lose clauses rather than hold up the writer
+    unsigned int n_rings;
+    ShareRing *rings;
+}
+Exchange;
+
+typedef struct
+{
+    unsigned int lbd;
+    unsigned int n_lits;
+    Literal lits[SHARE_MAX_LITS];
+}
+SharedClause;
+
+void create_exchange(Exchange *, unsigned int);
+void delete_exchange(Exchange *);
+
+void export_clause(Exchange *,
+                   unsigned int,
+                   const Literal *,
+                   unsigned int,
+                   unsigned int);
+
+// Copies the clause after `*cursor` from a ring, returning false
+// once the ring has nothing newer; clauses that were overwritten
+// before they could be read are skipped
+bool import_clause(Exchange *, unsigned int, unsigned int *, SharedClause *);
+
+#endif
+
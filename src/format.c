@@ -1,80 +1,131 @@
 
 #include "format.h"
 
+#include <assert.h>
 #include <ctype.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <stdarg.h>
+#include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
 #include "constants.h"
 #include "error.h"
+#include "problem.h"
+#include "reader.h"
+#include "region.h"
 #include "solver.h"
+#include "utils.h"
 
-Error read_problem(Solver *solver, FILE *stream)
+// Statistics, once gathered, are either written as comments or as
+// members of a JSON object
+#define N_STATISTICS 25
+
+typedef enum
 {
-    Error err;
-    int pos;
-    int i;
+    STAT_SECONDS,
+    STAT_RATE,
+    STAT_COUNT,
+    STAT_MEGABYTES
+}
+StatisticKind;
 
-    char c;
-    char buffer[256];
+typedef struct
+{
+    const char *label;
+    const char *key;
+    StatisticKind kind;
+    double value;
+}
+Statistic;
+
+// The whole solution is formatted here first, so that it goes to the
+// stream in one write however many variables there are
+typedef struct
+{
+    char *data;
+    size_t n_bytes;
+    size_t capacity;
+}
+OutputBuffer;
+
+static bool read_problem_line(Reader *, unsigned long *, unsigned long *);
+static int skip_blanks(Reader *);
+static int skip_whitespace(Reader *);
+static void skip_line(Reader *);
+static bool read_number(Reader *, unsigned long *);
+static bool read_integer(Reader *, long *);
+static Error invalid_format(const Reader *, const char *);
+static Error too_large(void);
+
+static void gather_statistics(const Solver *, Statistic *, double);
+static void put_statistics(OutputBuffer *, const Statistic *);
+static void put_statistic(OutputBuffer *, const Statistic *);
+static void put_dimacs_model(OutputBuffer *, const Solver *);
+static void put_binary_model(OutputBuffer *, const Solver *);
+static void put_json_model(OutputBuffer *, const Solver *);
+static void put_json_solution(OutputBuffer *,
+                              const Statistic *,
+                              const char *,
+                              const OutputBuffer *);
+
+static void create_output(OutputBuffer *, size_t);
+static void delete_output(OutputBuffer *);
+static void reserve_output(OutputBuffer *, size_t);
+static void put_char(OutputBuffer *, char);
+static void put_output(OutputBuffer *, const OutputBuffer *);
+static void put_int(OutputBuffer *, int);
+static void put_text(OutputBuffer *, const char *, ...);
+static unsigned int count_digits(unsigned int);
+static double per_second(uint64_t, double);
+
+Error read_problem(Problem *problem, Reader *reader)
+{
+    Error err;
+    int c;
+    unsigned int i;
 
-    int n_vars;
-    int n_clauses;
+    unsigned long n_vars;
+    unsigned long n_clauses;
 
     /*
      * 1. Read comment lines
      */
 
-    do {
-        // Read lines until one of them is not a comment
-        if (fgets(buffer, 255, stream) == NULL) {
-            fprintf(stderr, PROGRAM_NAME ": Expected problem line\n");
-            err = ERROR_INVALID_FORMAT;
-            goto cleanup;
-        }
-    } while (buffer[0] == 'c');
+    // Read lines until one of them is not a comment
+    while ((c = skip_whitespace(reader)) == 'c') {
+        skip_line(reader);
+    }
 
     /*
      * 2. Parse problem line
      */
 
     // Make sure the next line is the problem line
-    if (buffer[0] != 'p') {
-        fprintf(stderr, PROGRAM_NAME ": Expected problem line\n");
-        err = ERROR_INVALID_FORMAT;
+    if (c != 'p') {
+        err = invalid_format(reader, "Expected problem line");
         goto cleanup;
     }
 
-    // Parse the beginning of the problem line
-    if (sscanf(buffer, "p cnf %d %d%n", &n_vars, &n_clauses, &pos) != 2) {
-        fprintf(stderr, PROGRAM_NAME ": Invalid problem line\n");
-        err = ERROR_INVALID_FORMAT;
+    // Parse the problem line and make sure the rest of it is empty
+    if (! read_problem_line(reader, &n_vars, &n_clauses)) {
+        err = invalid_format(reader, "Invalid problem line");
         goto cleanup;
     }
 
-    // Make sure the rest of the line is empty
-    while (buffer[pos] != '\0') {
-        if (! isspace(buffer[pos++])) {
-            fprintf(stderr, PROGRAM_NAME ": Invalid problem line\n");
-            err = ERROR_INVALID_FORMAT;
-            goto cleanup;
-        }
-    }
-
     // Make sure the values read are valid
-    if (n_vars <= 0) {
-        fprintf(stderr, PROGRAM_NAME ": Invalid number of variables\n");
-        err = ERROR_INVALID_FORMAT;
+    if (n_vars == 0 || n_vars > INT_MAX) {
+        err = invalid_format(reader, "Invalid number of variables");
         goto cleanup;
-    } else if (n_clauses <= 0) {
-        fprintf(stderr, PROGRAM_NAME ": Invalid number of clauses\n");
-        err = ERROR_INVALID_FORMAT;
+    } else if (n_clauses == 0 || n_clauses > INT_MAX) {
+        err = invalid_format(reader, "Invalid number of clauses");
         goto cleanup;
     }
 
-    // Finally, initialize the Solver
-    create_solver(solver, n_vars, n_clauses);
+    // Finally, initialize the Problem
+    create_problem(problem, n_vars, n_clauses);
 
     /*
      * 3. Read the clauses
@@ -82,132 +133,626 @@ Error read_problem(Solver *solver, FILE *stream)
 
     for (i = 0; i < n_clauses; ++i) {
 
-        ClauseState *cstate = &solver->clauses[i];
-
         for (;;) {
 
-            int repr;
+            long repr;
+
+            // Comment lines may appear between clauses
+            c = skip_whitespace(reader);
+            if (c == 'c') {
+                skip_line(reader);
+                continue;
+            } else if (c == EOF) {
+                err = invalid_format(reader, "Expected more clauses");
+                goto cleanup_problem;
+            }
 
             // Read an integer
-            if (fscanf(stream, " %d", &repr) != 1) {
-                fprintf(stderr, PROGRAM_NAME ": Expected more clauses\n");
-                err = ERROR_INVALID_FORMAT;
-                goto cleanup_solver;
+            if (! read_integer(reader, &repr)) {
+                err = invalid_format(reader, "Invalid literal");
+                goto cleanup_problem;
             }
 
             if (repr == 0) {
                 break;
             }
 
-            if (abs(repr) > n_vars) {
-                fprintf(stderr, PROGRAM_NAME ": Literal out of range\n");
-                err = ERROR_INVALID_FORMAT;
-                goto cleanup_solver;
+            if (repr > (long) n_vars || -repr > (long) n_vars) {
+                err = invalid_format(reader, "Literal out of range");
+                goto cleanup_problem;
+            }
+
+            if (problem->n_lits == OFFSET_MAX) {
+                err = too_large();
+                goto cleanup_problem;
             }
 
-            add_literal_to_clause(solver, cstate, lit_from_int(repr));
+            push_problem_literal(problem, lit_from_int(repr));
         }
+
+        finish_problem_clause(problem);
     }
 
     // Make sure this is the end of the input
-    for (;;) {
-        c = fgetc(stream);
-        if (c == EOF) {
-            break;
-        } else if (! isspace(c)) {
-            fprintf(stderr, PROGRAM_NAME ": Expected end of input\n");
-            err = ERROR_INVALID_FORMAT;
-        }
+    while ((c = skip_whitespace(reader)) == 'c') {
+        skip_line(reader);
+    }
+
+    if (c != EOF) {
+        err = invalid_format(reader, "Expected end of input");
+        goto cleanup_problem;
+    } else if (reader->error) {
+        // Every clause was there, but the input was still not whole
+        err = reader->error;
+        goto cleanup_problem;
+    }
+
+    // The solver needs room for the clause headers as well
+    if (! fits_in_arena(problem)) {
+        err = too_large();
+        goto cleanup_problem;
     }
 
     return ERROR_OK;
 
-cleanup_solver:
-    delete_solver(solver);
+cleanup_problem:
+    delete_problem(problem);
 
 cleanup:
     return err;
 }
 
-void write_solution(const Solver *solver, FILE *stream)
+static bool read_problem_line(Reader *reader,
+                              unsigned long *n_vars,
+                              unsigned long *n_clauses)
 {
-    Literal lit;
-    unsigned int column;
-    double start_time;
-    double stop_time;
-    double elapsed_time;
+    int c;
 
-    /*
-     * 1. Write performance info
-     */
+    // Skip the leading "p"
+    read_char(reader);
+
+    if (skip_blanks(reader) != 'c' ||
+        read_char(reader) != 'c' ||
+        read_char(reader) != 'n' ||
+        read_char(reader) != 'f') {
+        return false;
+    }
+
+    c = peek_char(reader);
+    if (c != ' ' && c != '\t') {
+        return false;
+    }
+
+    skip_blanks(reader);
+    if (! read_number(reader, n_vars)) {
+        return false;
+    }
 
-    start_time = (double) solver->start_time;
-    stop_time = (double) solver->stop_time;
-    elapsed_time = (stop_time - start_time) / CLOCKS_PER_SEC;
+    skip_blanks(reader);
+    if (! read_number(reader, n_clauses)) {
+        return false;
+    }
 
-    fprintf(stream, "c Generated by " PROGRAM_NAME_FANCY);
-    fprintf(stream, " " PROGRAM_VERSION "\n");
-    fprintf(stream, "c\n");
-    fprintf(stream, "c Performance statistics\n");
-    fprintf(stream, "c ----------------------\n");
-    fprintf(stream, "c Elapsed time:       %.3f (s)\n", elapsed_time);
-    fprintf(stream, "c Attempted branches: %d\n", solver->t_branches);
-    fprintf(stream, "c Unit propagations:  %d\n", solver->t_unit_props);
-    fprintf(stream, "c\n");
+    c = skip_blanks(reader);
+    return c == '\n' || c == '\r' || c == EOF;
+}
+
+static int skip_blanks(Reader *reader)
+{
+    int c;
+
+    // Spaces and tabs only, staying on the current line
+    while ((c = peek_char(reader)) == ' ' || c == '\t') {
+        read_char(reader);
+    }
+
+    return c;
+}
+
+static int skip_whitespace(Reader *reader)
+{
+    int c;
+
+    while ((c = peek_char(reader)) != EOF && isspace(c)) {
+        read_char(reader);
+    }
+
+    return c;
+}
+
+static void skip_line(Reader *reader)
+{
+    int c;
+
+    do {
+        c = read_char(reader);
+    } while (c != '\n' && c != EOF);
+}
+
+static bool read_number(Reader *reader, unsigned long *value)
+{
+    unsigned long result = 0;
+    int c = peek_char(reader);
+
+    if (! isdigit(c)) {
+        return false;
+    }
+
+    // Large values saturate rather than wrap around,
+    // so they are still caught by the range checks
+    do {
+        read_char(reader);
+        if (result <= (ULONG_MAX - 9) / 10) {
+            result = result * 10 + (unsigned long) (c - '0');
+        } else {
+            result = ULONG_MAX;
+        }
+    } while (isdigit(c = peek_char(reader)));
+
+    // Numbers must be followed by whitespace or the end of input
+    if (c != EOF && ! isspace(c)) {
+        return false;
+    }
+
+    *value = result;
+    return true;
+}
+
+static bool read_integer(Reader *reader, long *value)
+{
+    unsigned long magnitude;
+    bool negative = false;
+
+    if (peek_char(reader) == '-') {
+        read_char(reader);
+        negative = true;
+    }
+
+    if (! read_number(reader, &magnitude)) {
+        return false;
+    }
+
+    if (magnitude > LONG_MAX) {
+        magnitude = LONG_MAX;
+    }
+
+    *value = negative ? -(long) magnitude : (long) magnitude;
+    return true;
+}
+
+static Error invalid_format(const Reader *reader, const char *message)
+{
+    // Input that could not be read has been reported already, and
+    // only looks malformed because it ends early
+    if (reader->error) {
+        return reader->error;
+    }
+
+    fprintf(stderr, PROGRAM_NAME ": %s\n", message);
+    return ERROR_INVALID_FORMAT;
+}
+
+static Error too_large(void)
+{
+#ifdef SIMPLESAT_WIDE_INDEX
+    fprintf(stderr, PROGRAM_NAME ": Too many literals\n");
+#else
+    fprintf(stderr, PROGRAM_NAME ": Too many literals, "
+                    "which needs a build with -Dwide_index=true\n");
+#endif
+    return ERROR_INVALID_FORMAT;
+}
+
+void write_solution(const Solver *solver, ModelFormat format, FILE *stream)
+{
+    OutputBuffer model;
+    OutputBuffer out;
+    Statistic stats[N_STATISTICS];
+    double format_start;
+    const char *status = status_name(solver->solution);
+
+    format_start = wall_time();
 
     /*
-     * 2. Write solution line
+     * 1. Format the whole solution in memory, the model first,
+     *    so that the time it took is among the statistics
      */
 
-    switch (solver->solution) {
+    // Room for the usual model, so that it is seldom moved
+    create_output(&model, (size_t) solver->n_vars * 4 + 64);
 
-    case SOLUTION_SATISFIABLE:
-        fprintf(stream, "s SATISFIABLE\n");
-        break;
+    if (solver->solution == SOLUTION_SATISFIABLE) {
+        if (format == MODEL_JSON) {
+            put_json_model(&model, solver);
+        } else if (format == MODEL_BINARY) {
+            put_binary_model(&model, solver);
+        } else {
+            put_dimacs_model(&model, solver);
+        }
+    }
 
-    case SOLUTION_UNSATISFIABLE:
-        fprintf(stream, "s UNSATISFIABLE\n");
-        break;
+    gather_statistics(solver, stats, wall_time() - format_start);
 
-    case SOLUTION_UNKNOWN:
-        fprintf(stream, "s UNKNOWN\n");
-        break;
+    create_output(&out, model.n_bytes + 4096);
+
+    if (format == MODEL_JSON) {
+        put_json_solution(&out, stats, status, &model);
+    } else {
+        put_statistics(&out, stats);
+        put_text(&out, "s %s\n", status);
+        put_output(&out, &model);
     }
 
     /*
-     * 3. Write variable assignments
+     * 2. Write it out all at once
      */
 
+    fwrite(out.data, 1, out.n_bytes, stream);
+    delete_output(&out);
+    delete_output(&model);
+}
+
+char *format_answer(const Solver *solver, size_t *length)
+{
+    OutputBuffer out;
+
+    create_output(&out, (size_t) solver->n_vars * 4 + 64);
+
+    put_text(&out, "s %s\n", status_name(solver->solution));
     if (solver->solution == SOLUTION_SATISFIABLE) {
+        put_dimacs_model(&out, solver);
+    }
 
-        column = 2;
-        fprintf(stream, "v");
+    // The buffer is handed over, without being freed here
+    *length = out.n_bytes;
+    return out.data;
+}
 
-        for (lit = 0; lit < (solver->n_vars << 1); ++lit) {
+static void gather_statistics(const Solver *solver,
+                              Statistic *stats,
+                              double format_time)
+{
+    double solve_time;
+    double search_time;
+    double elapsed_time;
+    unsigned int i = 0;
+
+    // Rates are taken over the search alone, since
+    // preprocessing does not branch or propagate
+    solve_time = solver->stop_time - solver->start_time;
+    search_time = solve_time - solver->preprocess_time;
+    elapsed_time = solver->parse_time + solve_time;
+    if (search_time <= 0.0) {
+        search_time = 0.0;
+    }
 
-            char buffer[80];
-            size_t numlen;
+#define STAT(L, K, T, V) do { \
+        stats[i].label = L; \
+        stats[i].key = K; \
+        stats[i].kind = T; \
+        stats[i].value = V; \
+        i += 1; \
+    } while (0)
+
+    STAT("Elapsed time:", "elapsed_time", STAT_SECONDS, elapsed_time);
+    STAT("Parse time:", "parse_time", STAT_SECONDS, solver->parse_time);
+    STAT("Preprocess time:", "preprocess_time", STAT_SECONDS,
+         solver->preprocess_time);
+    STAT("Search time:", "search_time", STAT_SECONDS, search_time);
+    STAT("Attempted branches:", "branches", STAT_COUNT,
+         solver->t_branches);
+    STAT("Decision rate:", "decision_rate", STAT_RATE,
+         per_second(solver->t_branches, search_time));
+    STAT("Unit propagations:", "propagations", STAT_COUNT,
+         solver->t_unit_props);
+    STAT("Propagation rate:", "propagation_rate", STAT_RATE,
+         per_second(solver->t_unit_props, search_time));
+    STAT("Conflicts:", "conflicts", STAT_COUNT, solver->t_conflicts);
+    STAT("Conflict rate:", "conflict_rate", STAT_RATE,
+         per_second(solver->t_conflicts, search_time));
+    STAT("Restarts:", "restarts", STAT_COUNT, solver->t_restarts);
+    STAT("Local search flips:", "flips", STAT_COUNT, solver->t_flips);
+    STAT("Failed literals:", "failed_literals", STAT_COUNT,
+         solver->t_failed);
+    STAT("Hyper binaries:", "hyper_binaries", STAT_COUNT, solver->t_hyper);
+    STAT("Vivified clauses:", "vivified_clauses", STAT_COUNT,
+         solver->t_vivified);
+    STAT("Learned clauses:", "learned_clauses", STAT_COUNT,
+         solver->n_learnts);
+    STAT("Deleted clauses:", "deleted_clauses", STAT_COUNT,
+         solver->t_deleted);
+    STAT("Eliminated vars:", "eliminated_vars", STAT_COUNT,
+         solver->n_eliminated);
+    STAT("XOR constraints:", "xor_constraints", STAT_COUNT,
+         solver->xors.n_rows);
+    STAT("Removed clauses:", "removed_clauses", STAT_COUNT,
+         solver->t_removed);
+    STAT("Exported clauses:", "exported_clauses", STAT_COUNT,
+         solver->t_exported);
+    STAT("Imported clauses:", "imported_clauses", STAT_COUNT,
+         solver->t_imported);
+    STAT("Solver memory:", "solver_memory", STAT_MEGABYTES,
+         solver->region->peak / (1024.0 * 1024.0));
+    STAT("Peak memory:", "peak_memory", STAT_MEGABYTES,
+         peak_memory() / (1024.0 * 1024.0));
+    STAT("Format time:", "format_time", STAT_SECONDS, format_time);
+
+#undef STAT
+
+    assert(i == N_STATISTICS);
+}
 
-            if (solver->lits[lit].fixed &&
-                solver->lits[lit].assigned) {
+static void put_statistics(OutputBuffer *out, const Statistic *stats)
+{
+    unsigned int i;
+
+    put_text(out, "c Generated by " PROGRAM_NAME_FANCY
+                  " " PROGRAM_VERSION "\n");
+    put_text(out, "c\n");
+    put_text(out, "c Performance statistics\n");
+    put_text(out, "c ----------------------\n");
+
+    for (i = 0; i < N_STATISTICS; ++i) {
+        put_text(out, "c %-20s", stats[i].label);
+        put_statistic(out, &stats[i]);
+        switch (stats[i].kind) {
+        case STAT_SECONDS:
+            put_text(out, " (s)");
+            break;
+        case STAT_RATE:
+            put_text(out, " (/s)");
+            break;
+        case STAT_MEGABYTES:
+            put_text(out, " (MB)");
+            break;
+        case STAT_COUNT:
+            break;
+        }
+        put_char(out, '\n');
+    }
 
-                sprintf(buffer, " %d", int_from_lit(lit));
-                numlen = strlen(buffer);
-                if (column + numlen > 79) {
-                    fprintf(stream, "\nv");
-                    column = 1;
-                }
+    put_text(out, "c\n");
+}
 
-                fprintf(stream, "%s", buffer);
-                column += numlen;
+static void put_statistic(OutputBuffer *out, const Statistic *stat)
+{
+    switch (stat->kind) {
+    case STAT_SECONDS:
+        put_text(out, "%.3f", stat->value);
+        break;
+    case STAT_RATE:
+        put_text(out, "%.0f", stat->value);
+        break;
+    case STAT_COUNT:
+        put_text(out, "%.0f", stat->value);
+        break;
+    case STAT_MEGABYTES:
+        put_text(out, "%.1f", stat->value);
+        break;
+    }
+}
+
+static void put_dimacs_model(OutputBuffer *out, const Solver *solver)
+{
+    unsigned int column = 2;
+    unsigned int var;
+
+    put_char(out, 'v');
+
+    for (var = 0; var < solver->n_vars; ++var) {
+
+        Literal lit = var << 1;
+        unsigned int numlen;
+
+        if (solver->values[lit] != VALUE_TRUE) {
+            lit = negate(lit);
+            if (solver->values[lit] != VALUE_TRUE) {
+                continue;
             }
         }
 
-        if (column + 2 > 79) {
-            fprintf(stream, "\nv 0\n");
+        // A space, the digits and a sign for negative literals
+        numlen = 1 + count_digits(var + 1) + (lit & 1);
+        if (column + numlen > 79) {
+            put_text(out, "\nv");
+            column = 1;
+        }
+
+        put_char(out, ' ');
+        put_int(out, int_from_lit(lit));
+        column += numlen;
+    }
+
+    if (column + 2 > 79) {
+        put_text(out, "\nv 0\n");
+    } else {
+        put_text(out, " 0\n");
+    }
+}
+
+static void put_binary_model(OutputBuffer *out, const Solver *solver)
+{
+    unsigned int var;
+    unsigned char byte = 0;
+
+    // One bit for each variable, set when it is true,
+    // eight to a byte with the lowest numbered first
+    for (var = 0; var < solver->n_vars; ++var) {
+        if (solver->values[var << 1] == VALUE_TRUE) {
+            byte |= (unsigned char) (1 << (var & 7));
+        }
+        if ((var & 7) == 7) {
+            put_char(out, (char) byte);
+            byte = 0;
+        }
+    }
+
+    if ((solver->n_vars & 7) != 0) {
+        put_char(out, (char) byte);
+    }
+}
+
+static void put_json_model(OutputBuffer *out, const Solver *solver)
+{
+    unsigned int var;
+
+    // Every variable is listed, as it is or negated, in order
+    put_text(out, ",\n  \"model\": [");
+    for (var = 0; var < solver->n_vars; ++var) {
+        if (var > 0) {
+            put_char(out, ',');
+        }
+        if (var % 16 == 0) {
+            put_text(out, "\n    ");
+        } else {
+            put_char(out, ' ');
+        }
+        if (solver->values[var << 1] == VALUE_TRUE) {
+            put_int(out, (int) var + 1);
         } else {
-            fprintf(stream, " 0\n");
+            put_int(out, -(int) var - 1);
+        }
+    }
+    put_text(out, "\n  ]");
+}
+
+static void put_json_solution(OutputBuffer *out,
+                              const Statistic *stats,
+                              const char *status,
+                              const OutputBuffer *model)
+{
+    unsigned int i;
+
+    put_text(out, "{\n  \"status\": \"%s\",\n  \"statistics\": {", status);
+    for (i = 0; i < N_STATISTICS; ++i) {
+        put_text(out, "%s\n    \"%s\": ", i ? "," : "", stats[i].key);
+        put_statistic(out, &stats[i]);
+    }
+    put_text(out, "\n  }");
+
+    // The model, if there is one, is already formatted
+    put_output(out, model);
+
+    put_text(out, "\n}\n");
+}
+
+static void create_output(OutputBuffer *out, size_t capacity)
+{
+    out->n_bytes = 0;
+    out->capacity = capacity;
+    CREATE_ARRAY(out->data, capacity);
+}
+
+static void delete_output(OutputBuffer *out)
+{
+    DELETE_ARRAY(out->data);
+}
+
+static void reserve_output(OutputBuffer *out, size_t n_bytes)
+{
+    if (out->n_bytes + n_bytes > out->capacity) {
+        while (out->n_bytes + n_bytes > out->capacity) {
+            out->capacity *= 2;
+        }
+        RESIZE_ARRAY(out->data, out->capacity);
+    }
+}
+
+static void put_char(OutputBuffer *out, char c)
+{
+    reserve_output(out, 1);
+    out->data[out->n_bytes++] = c;
+}
+
+static void put_output(OutputBuffer *out, const OutputBuffer *other)
+{
+    reserve_output(out, other->n_bytes);
+    memcpy(out->data + out->n_bytes, other->data, other->n_bytes);
+    out->n_bytes += other->n_bytes;
+}
+
+static void put_int(OutputBuffer *out, int value)
+{
+    char digits[16];
+    unsigned int magnitude;
+    unsigned int n_digits = 0;
+
+    reserve_output(out, sizeof(digits));
+
+    // Digits come out lowest first, so they are written backwards
+    if (value < 0) {
+        out->data[out->n_bytes++] = '-';
+        magnitude = -(unsigned int) value;
+    } else {
+        magnitude = (unsigned int) value;
+    }
+
+    do {
+        digits[n_digits++] = (char) ('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude > 0);
+
+    while (n_digits > 0) {
+        out->data[out->n_bytes++] = digits[--n_digits];
+    }
+}
+
+static void put_text(OutputBuffer *out, const char *format, ...)
+{
+    va_list args;
+    size_t room;
+    int length;
+
+    // Formatted straight into the buffer, and again only if it
+    // turns out to need more room than was left
+    for (;;) {
+        room = out->capacity - out->n_bytes;
+
+        va_start(args, format);
+        length = vsnprintf(&out->data[out->n_bytes], room, format, args);
+        va_end(args);
+
+        if ((size_t) length < room) {
+            break;
         }
+
+        reserve_output(out, (size_t) length + 1);
+    }
+
+    out->n_bytes += (size_t) length;
+}
+
+static unsigned int count_digits(unsigned int value)
+{
+    unsigned int n_digits = 1;
+
+    while (value >= 10) {
+        value /= 10;
+        n_digits += 1;
     }
+
+    return n_digits;
+}
+
+const char *status_name(Solution solution)
+{
+    switch (solution) {
+
+    case SOLUTION_SATISFIABLE:
+        return "SATISFIABLE";
+
+    case SOLUTION_UNSATISFIABLE:
+        return "UNSATISFIABLE";
+
+    case SOLUTION_UNKNOWN:
+    default:
+        return "UNKNOWN";
+
+    }
+}
+
+static double per_second(uint64_t count, double seconds)
+{
+    return seconds > 0.0 ? count / seconds : 0.0;
 }
 
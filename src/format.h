@@ -2,13 +2,36 @@
 #ifndef SIMPLESAT_FORMAT_H
 #define SIMPLESAT_FORMAT_H
 
+#include <stddef.h>
 #include <stdio.h>
 
 #include "error.h"
+#include "problem.h"
+#include "reader.h"
 #include "solver.h"
 
-Error read_problem(Solver *, FILE *);
-void write_solution(const Solver *, FILE *);
+typedef enum
+{
+    // Lines of literals after the statistics, as DIMACS has them
+    MODEL_DIMACS,
+
+    // The statistics and the literal of every variable in one object
+    MODEL_JSON,
+
+    // A bit for every variable after the statistics, set when it is true
+    MODEL_BINARY
+}
+ModelFormat;
+
+Error read_problem(Problem *, Reader *);
+void write_solution(const Solver *, ModelFormat, FILE *);
+
+// Name of the solution, as the status line and the logs give it
+const char *status_name(Solution);
+
+// Formats the status line, and the model lines if there is a model,
+// into a new string whose length is also given back
+char *format_answer(const Solver *, size_t *);
 
 #endif
 
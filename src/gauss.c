@@ -0,0 +1,522 @@
+
+#include "gauss.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "solver.h"
+#include "utils.h"
+
+// Longest XOR constraint looked for, whose 2^(n-1) clauses
+// must all be present; two variables are left to the clauses
+#define MIN_XOR_LITS 3
+#define MAX_XOR_LITS 6
+
+// Largest matrix worth reducing at every step of the search
+#define MAX_MATRIX_BITS (1UL << 22)
+
+#define WORD_BITS 64
+
+typedef struct
+{
+    // Variables of the clause in increasing order, and
+    // which of their literals are negated, one bit each
+    unsigned int n_vars;
+    unsigned int vars[MAX_XOR_LITS];
+    unsigned int negated;
+
+    // For a constraint, what its variables add up to
+    bool parity;
+}
+XorCandidate;
+
+static int compare_candidates(const void *, const void *);
+static uint64_t parity_masks(unsigned int, unsigned int);
+static void add_row(XorMatrix *, const XorCandidate *);
+
+static bool has_column(const uint64_t *, unsigned int);
+static unsigned int first_column(const uint64_t *,
+                                 const uint64_t *,
+                                 unsigned int);
+static unsigned int count_columns(const uint64_t *,
+                                  const uint64_t *,
+                                  unsigned int);
+static unsigned int spell_row(Solver *, unsigned int, bool, Literal);
+static ClauseRef learn_row(Solver *, unsigned int);
+
+void create_xor_matrix(XorMatrix *matrix)
+{
+    matrix->n_cols = 0;
+    matrix->col_vars = NULL;
+    matrix->n_mapped = 0;
+    matrix->var_cols = NULL;
+
+    matrix->n_rows = 0;
+    matrix->n_words = 0;
+    matrix->rows = NULL;
+    matrix->parities = NULL;
+    matrix->pivots = NULL;
+
+    matrix->unassigned = NULL;
+    matrix->true_cols = NULL;
+    matrix->lits = NULL;
+
+    matrix->n_checked = 0;
+    matrix->reduced = false;
+}
+
+void delete_xor_matrix(XorMatrix *matrix)
+{
+    DELETE_ARRAY(matrix->col_vars);
+    DELETE_ARRAY(matrix->var_cols);
+    DELETE_ARRAY(matrix->rows);
+    DELETE_ARRAY(matrix->parities);
+    DELETE_ARRAY(matrix->pivots);
+    DELETE_ARRAY(matrix->unassigned);
+    DELETE_ARRAY(matrix->true_cols);
+    DELETE_ARRAY(matrix->lits);
+
+    create_xor_matrix(matrix);
+}
+
+void find_xors(Solver *solver)
+{
+    XorMatrix *matrix = &solver->xors;
+    XorCandidate *candidates;
+    unsigned int n_candidates = 0;
+    unsigned int n_xors = 0;
+    unsigned int i;
+    unsigned int j;
+    unsigned int k;
+
+    /*
+     * 1. Sort the short clauses by their variables
+     */
+
+    CREATE_ARRAY(candidates, solver->n_clauses);
+
+    for (i = 0; i < solver->n_clauses; ++i) {
+
+        const ClauseState *cstate = get_clause(solver, solver->clauses[i]);
+        XorCandidate *candidate = &candidates[n_candidates];
+        Literal lits[MAX_XOR_LITS];
+
+        if (cstate->n_lits < MIN_XOR_LITS || cstate->n_lits > MAX_XOR_LITS) {
+            continue;
+        }
+
+        // Literals in order are also variables in order
+        for (j = 0; j < cstate->n_lits; ++j) {
+            Literal lit = cstate->lits[j];
+            for (k = j; k > 0 && lits[k - 1] > lit; --k) {
+                lits[k] = lits[k - 1];
+            }
+            lits[k] = lit;
+        }
+
+        candidate->n_vars = cstate->n_lits;
+        candidate->negated = 0;
+        for (j = 0; j < cstate->n_lits; ++j) {
+            candidate->vars[j] = var_from_lit(lits[j]);
+            candidate->negated |= (lits[j] & 1) << j;
+        }
+
+        // Tautologies are no part of any constraint
+        for (j = 1; j < cstate->n_lits; ++j) {
+            if (candidate->vars[j] == candidate->vars[j - 1]) {
+                break;
+            }
+        }
+
+        if (j == cstate->n_lits) {
+            n_candidates += 1;
+        }
+    }
+
+    qsort(candidates, n_candidates, sizeof(*candidates), compare_candidates);
+
+    /*
+     * 2. Count the XOR constraints among clauses with the same variables
+     */
+
+    // Each clause rules out the one assignment that makes every
+    // literal false, whose true variables are the negated ones;
+    // a constraint needs every assignment of one parity ruled out
+    for (i = 0; i < n_candidates; i = j) {
+
+        uint64_t seen = 0;
+        unsigned int parity;
+
+        for (j = i; j < n_candidates &&
+                    compare_candidates(&candidates[i], &candidates[j]) == 0;
+             ++j) {
+            seen |= (uint64_t) 1 << candidates[j].negated;
+        }
+
+        for (parity = 0; parity < 2; ++parity) {
+            uint64_t needed = parity_masks(candidates[i].n_vars, parity);
+            if ((seen & needed) == needed) {
+                // The variables add up to the other parity
+                candidates[n_xors] = candidates[i];
+                candidates[n_xors].parity = ! parity;
+                n_xors += 1;
+            }
+        }
+    }
+
+    /*
+     * 3. Build a row for each constraint
+     */
+
+    if (n_xors == 0) {
+        DELETE_ARRAY(candidates);
+        return;
+    }
+
+    matrix->n_mapped = solver->n_vars;
+    CREATE_ARRAY(matrix->var_cols, solver->n_vars);
+    for (i = 0; i < solver->n_vars; ++i) {
+        matrix->var_cols[i] = COLUMN_NONE;
+    }
+
+    CREATE_ARRAY(matrix->col_vars, solver->n_vars);
+    for (i = 0; i < n_xors; ++i) {
+        for (j = 0; j < candidates[i].n_vars; ++j) {
+            unsigned int var = candidates[i].vars[j];
+            if (matrix->var_cols[var] == COLUMN_NONE) {
+                matrix->var_cols[var] = matrix->n_cols;
+                matrix->col_vars[matrix->n_cols++] = var;
+            }
+        }
+    }
+
+    if ((unsigned long) n_xors * matrix->n_cols > MAX_MATRIX_BITS) {
+        DELETE_ARRAY(candidates);
+        delete_xor_matrix(matrix);
+        return;
+    }
+
+    matrix->n_words = (matrix->n_cols + WORD_BITS - 1) / WORD_BITS;
+    CREATE_ARRAY(matrix->rows, (size_t) n_xors * matrix->n_words);
+    CREATE_ARRAY(matrix->parities, n_xors);
+    CREATE_ARRAY(matrix->pivots, n_xors);
+    for (i = 0; i < n_xors; ++i) {
+        add_row(matrix, &candidates[i]);
+    }
+
+    CREATE_ARRAY(matrix->unassigned, matrix->n_words);
+    CREATE_ARRAY(matrix->true_cols, matrix->n_words);
+    CREATE_ARRAY(matrix->lits, matrix->n_cols);
+
+    DELETE_ARRAY(candidates);
+}
+
+ClauseRef propagate_xors(Solver *solver)
+{
+    XorMatrix *matrix = &solver->xors;
+    const Literal *lits = matrix->lits;
+    unsigned int n_words = matrix->n_words;
+    bool changed = ! matrix->reduced;
+    unsigned int i;
+    unsigned int j;
+    unsigned int w;
+
+    // Nothing has changed unless a variable of some row has been
+    // assigned, since being unassigned again cannot imply anything
+    for (i = matrix->n_checked; i < solver->n_assigned && ! changed; ++i) {
+        unsigned int var = var_from_lit(solver->assigned[i]);
+        changed = var < matrix->n_mapped &&
+                  matrix->var_cols[var] != COLUMN_NONE;
+    }
+
+    matrix->n_checked = solver->n_assigned;
+    if (! changed) {
+        return CLAUSE_NONE;
+    }
+    matrix->reduced = true;
+
+    for (w = 0; w < n_words; ++w) {
+        matrix->unassigned[w] = 0;
+        matrix->true_cols[w] = 0;
+    }
+
+    for (i = 0; i < matrix->n_cols; ++i) {
+        signed char value = solver->values[matrix->col_vars[i] << 1];
+        uint64_t bit = (uint64_t) 1 << (i % WORD_BITS);
+        if (value == VALUE_UNSET) {
+            matrix->unassigned[i / WORD_BITS] |= bit;
+        } else if (value == VALUE_TRUE) {
+            matrix->true_cols[i / WORD_BITS] |= bit;
+        }
+    }
+
+    /*
+     * 1. Pivot each row on an unassigned variable
+     */
+
+    // Pivots that are still unassigned are kept, and the new ones
+    // are taken from columns that are no other row's pivot, so only
+    // the rows whose pivot has been assigned cost any work
+    for (i = 0; i < matrix->n_rows; ++i) {
+
+        uint64_t *row = &matrix->rows[(size_t) i * n_words];
+        unsigned int pivot = matrix->pivots[i];
+
+        if (pivot != COLUMN_NONE && has_column(matrix->unassigned, pivot)) {
+            continue;
+        }
+
+        pivot = first_column(row, matrix->unassigned, n_words);
+        matrix->pivots[i] = pivot;
+        if (pivot == COLUMN_NONE) {
+            continue;
+        }
+
+        for (j = 0; j < matrix->n_rows; ++j) {
+            uint64_t *other = &matrix->rows[(size_t) j * n_words];
+            if (j != i && has_column(other, pivot)) {
+                for (w = 0; w < n_words; ++w) {
+                    other[w] ^= row[w];
+                }
+                matrix->parities[j] ^= matrix->parities[i];
+            }
+        }
+    }
+
+    /*
+     * 2. Look for rows with at most one unassigned variable
+     */
+
+    // A pivot is in no other row, so assigning it leaves the counts
+    // of the other rows as they are
+    for (i = 0; i < matrix->n_rows; ++i) {
+
+        const uint64_t *row = &matrix->rows[(size_t) i * n_words];
+        unsigned int n_unassigned;
+        unsigned int n_lits;
+        unsigned int level;
+        bool backtracked;
+        bool parity = matrix->parities[i];
+
+        n_unassigned = count_columns(row, matrix->unassigned, n_words);
+        if (n_unassigned > 1) {
+            continue;
+        }
+
+        for (w = 0; w < n_words; ++w) {
+            parity ^= __builtin_parityll(row[w] & matrix->true_cols[w]);
+        }
+
+        if (n_unassigned == 0 && parity) {
+
+            // A conflict among earlier levels alone is analyzed there
+            n_lits = spell_row(solver, i, false, 0);
+            level = n_lits > 0 ? solver->vars[var_from_lit(lits[0])].level
+                               : 0;
+            if (level < solver->n_levels) {
+                backtrack(solver, level);
+            }
+            return learn_row(solver, n_lits);
+
+        } else if (n_unassigned == 1) {
+
+            // The pivot has to make up the parity
+            unsigned int var = matrix->col_vars[matrix->pivots[i]];
+            Literal lit = parity ? var << 1 : (var << 1) | 1;
+
+            // The implication belongs to the latest level among the
+            // other variables, which the search may already be past,
+            // and then the rows are reduced again from there
+            n_lits = spell_row(solver, i, true, lit);
+            level = n_lits > 1 ? solver->vars[var_from_lit(lits[1])].level
+                               : 0;
+            backtracked = level < solver->n_levels;
+            if (backtracked) {
+                backtrack(solver, level);
+            }
+
+            solver->t_unit_props += 1;
+            if (level == 0) {
+                assign_literal(solver, lit, CLAUSE_NONE);
+            } else {
+                assign_literal(solver, lit, learn_row(solver, n_lits));
+            }
+
+            if (backtracked) {
+                return CLAUSE_NONE;
+            }
+            matrix->n_checked = solver->n_assigned;
+        }
+    }
+
+    return CLAUSE_NONE;
+}
+
+static int compare_candidates(const void *a, const void *b)
+{
+    const XorCandidate *x = a;
+    const XorCandidate *y = b;
+    unsigned int i;
+
+    if (x->n_vars != y->n_vars) {
+        return x->n_vars < y->n_vars ? -1 : 1;
+    }
+
+    for (i = 0; i < x->n_vars; ++i) {
+        if (x->vars[i] != y->vars[i]) {
+            return x->vars[i] < y->vars[i] ? -1 : 1;
+        }
+    }
+
+    return 0;
+}
+
+static uint64_t parity_masks(unsigned int n_vars, unsigned int parity)
+{
+    uint64_t mask = 0;
+    unsigned int negated;
+
+    // One bit for each pattern of negations with the given parity
+    for (negated = 0; negated < (1u << n_vars); ++negated) {
+        if ((unsigned int) __builtin_parity(negated) == parity) {
+            mask |= (uint64_t) 1 << negated;
+        }
+    }
+
+    return mask;
+}
+
+static void add_row(XorMatrix *matrix, const XorCandidate *candidate)
+{
+    uint64_t *row = &matrix->rows[(size_t) matrix->n_rows * matrix->n_words];
+    unsigned int i;
+
+    for (i = 0; i < matrix->n_words; ++i) {
+        row[i] = 0;
+    }
+
+    for (i = 0; i < candidate->n_vars; ++i) {
+        unsigned int col = matrix->var_cols[candidate->vars[i]];
+        row[col / WORD_BITS] |= (uint64_t) 1 << (col % WORD_BITS);
+    }
+
+    matrix->parities[matrix->n_rows] = candidate->parity;
+    matrix->pivots[matrix->n_rows] = COLUMN_NONE;
+    matrix->n_rows += 1;
+}
+
+static bool has_column(const uint64_t *bits, unsigned int col)
+{
+    return (bits[col / WORD_BITS] >> (col % WORD_BITS)) & 1;
+}
+
+static unsigned int first_column(const uint64_t *row,
+                                 const uint64_t *mask,
+                                 unsigned int n_words)
+{
+    unsigned int w;
+
+    for (w = 0; w < n_words; ++w) {
+        uint64_t bits = row[w] & mask[w];
+        if (bits != 0) {
+            return w * WORD_BITS + (unsigned int) __builtin_ctzll(bits);
+        }
+    }
+
+    return COLUMN_NONE;
+}
+
+static unsigned int count_columns(const uint64_t *row,
+                                  const uint64_t *mask,
+                                  unsigned int n_words)
+{
+    unsigned int count = 0;
+    unsigned int w;
+
+    // Only whether there are none, one or more matters
+    for (w = 0; w < n_words && count < 2; ++w) {
+        count += (unsigned int) __builtin_popcountll(row[w] & mask[w]);
+    }
+
+    return count;
+}
+
+static unsigned int spell_row(Solver *solver,
+                              unsigned int index,
+                              bool implied,
+                              Literal implied_lit)
+{
+    XorMatrix *matrix = &solver->xors;
+    const uint64_t *row = &matrix->rows[(size_t) index * matrix->n_words];
+    Literal *lits = matrix->lits;
+    unsigned int n_lits = 0;
+    unsigned int col;
+    unsigned int i;
+    unsigned int j;
+
+    if (implied) {
+        lits[n_lits++] = implied_lit;
+    }
+
+    // Every other variable of the row is assigned,
+    // and its literal in the clause is the false one
+    for (col = 0; col < matrix->n_cols; ++col) {
+        unsigned int var = matrix->col_vars[col];
+        if (has_column(row, col) &&
+            ! (implied && col == matrix->pivots[index])) {
+            lits[n_lits++] = solver->values[var << 1] == VALUE_TRUE ?
+                             (var << 1) | 1 : var << 1;
+        }
+    }
+
+    // The implied literal goes first, then the false literals assigned
+    // last, so that the clause is watched as if it had been learned
+    for (i = implied ? 1 : 0; i < 2 && i < n_lits; ++i) {
+        unsigned int latest = i;
+        Literal swap;
+        for (j = i + 1; j < n_lits; ++j) {
+            if (solver->vars[var_from_lit(lits[j])].level >
+                solver->vars[var_from_lit(lits[latest])].level) {
+                latest = j;
+            }
+        }
+        swap = lits[i];
+        lits[i] = lits[latest];
+        lits[latest] = swap;
+    }
+
+    return n_lits;
+}
+
+static ClauseRef learn_row(Solver *solver, unsigned int num_lits)
+{
+    const Literal *lits = solver->xors.lits;
+    ClauseRef ref;
+    ClauseState *cstate;
+    unsigned int i;
+
+    ref = alloc_clause(solver, num_lits);
+    cstate = get_clause(solver, ref);
+    cstate->learnt = 1;
+    cstate->lbd = compute_lbd(solver, lits, num_lits);
+    for (i = 0; i < num_lits; ++i) {
+        cstate->lits[i] = lits[i];
+    }
+
+    // A conflict at level 0 ends the search, so the clause
+    // is only needed for as long as it takes to say so
+    if (solver->n_levels == 0) {
+        return ref;
+    }
+
+    if (solver->n_learnts == solver->c_learnts) {
+        solver->c_learnts *= 2;
+        REGION_RESIZE(solver->region, solver->learnts, solver->c_learnts);
+    }
+    solver->learnts[solver->n_learnts++] = ref;
+
+    watch_clause(solver, ref);
+
+    return ref;
+}
@@ -0,0 +1,21 @@
+
+#ifndef SIMPLESAT_GAUSS_H
+#define SIMPLESAT_GAUSS_H
+
+#include "solver.h"
+
+void create_xor_matrix(XorMatrix *);
+void delete_xor_matrix(XorMatrix *);
+
+// Gathers the XOR constraints of up to a few variables that
+// the clauses spell out in full, leaving the matrix empty
+// if there are none or too many to be worth reducing
+void find_xors(Solver *);
+
+// Reduces the rows under the current assignment, assigning
+// the variables that they imply and returning a conflicting
+// clause if they cannot all hold, or CLAUSE_NONE
+ClauseRef propagate_xors(Solver *);
+
+#endif
+
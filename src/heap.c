@@ -0,0 +1,144 @@
+
+#include "heap.h"
+
+#include <assert.h>
+#include <stdbool.h>
+
+#include "utils.h"
+
+// Position of variables that are not in the heap
+#define HEAP_ABSENT ((unsigned int) -1)
+
+static void sift_up(Heap *, unsigned int);
+static void sift_down(Heap *, unsigned int);
+
+void create_heap(Heap *heap, unsigned int num_vars, const double *keys)
+{
+    unsigned int i;
+
+    heap->n_vars = 0;
+    heap->c_vars = num_vars;
+    CREATE_ARRAY(heap->vars, num_vars);
+    CREATE_ARRAY(heap->positions, num_vars);
+    for (i = 0; i < num_vars; ++i) {
+        heap->positions[i] = HEAP_ABSENT;
+    }
+
+    heap->keys = keys;
+}
+
+void delete_heap(Heap *heap)
+{
+    DELETE_ARRAY(heap->vars);
+    DELETE_ARRAY(heap->positions);
+}
+
+void resize_heap(Heap *heap, unsigned int num_vars, const double *keys)
+{
+    unsigned int i;
+
+    assert(num_vars >= heap->c_vars);
+
+    RESIZE_ARRAY(heap->vars, num_vars);
+    RESIZE_ARRAY(heap->positions, num_vars);
+    for (i = heap->c_vars; i < num_vars; ++i) {
+        heap->positions[i] = HEAP_ABSENT;
+    }
+
+    heap->c_vars = num_vars;
+    heap->keys = keys;
+}
+
+bool heap_empty(const Heap *heap)
+{
+    return heap->n_vars == 0;
+}
+
+bool heap_contains(const Heap *heap, unsigned int var)
+{
+    return heap->positions[var] != HEAP_ABSENT;
+}
+
+void heap_insert(Heap *heap, unsigned int var)
+{
+    assert(! heap_contains(heap, var));
+
+    heap->vars[heap->n_vars] = var;
+    heap->positions[var] = heap->n_vars;
+    sift_up(heap, heap->n_vars++);
+}
+
+unsigned int heap_pop(Heap *heap)
+{
+    unsigned int top;
+
+    assert(! heap_empty(heap));
+
+    top = heap->vars[0];
+    heap->positions[top] = HEAP_ABSENT;
+
+    // Move the last variable to the root and let it sink
+    if (--heap->n_vars > 0) {
+        heap->vars[0] = heap->vars[heap->n_vars];
+        heap->positions[heap->vars[0]] = 0;
+        sift_down(heap, 0);
+    }
+
+    return top;
+}
+
+void heap_increase(Heap *heap, unsigned int var)
+{
+    if (heap_contains(heap, var)) {
+        sift_up(heap, heap->positions[var]);
+    }
+}
+
+static void sift_up(Heap *heap, unsigned int pos)
+{
+    unsigned int var = heap->vars[pos];
+    double key = heap->keys[var];
+
+    // Shift parents down until the variable's place is found
+    while (pos > 0) {
+        unsigned int parent = (pos - 1) >> 1;
+        if (heap->keys[heap->vars[parent]] >= key) {
+            break;
+        }
+        heap->vars[pos] = heap->vars[parent];
+        heap->positions[heap->vars[pos]] = pos;
+        pos = parent;
+    }
+
+    heap->vars[pos] = var;
+    heap->positions[var] = pos;
+}
+
+static void sift_down(Heap *heap, unsigned int pos)
+{
+    unsigned int var = heap->vars[pos];
+    double key = heap->keys[var];
+
+    // Shift the larger child up until the variable's place is found
+    for (;;) {
+        unsigned int child = (pos << 1) + 1;
+        unsigned int right = child + 1;
+        if (child >= heap->n_vars) {
+            break;
+        }
+        if (right < heap->n_vars &&
+            heap->keys[heap->vars[right]] > heap->keys[heap->vars[child]]) {
+            child = right;
+        }
+        if (heap->keys[heap->vars[child]] <= key) {
+            break;
+        }
+        heap->vars[pos] = heap->vars[child];
+        heap->positions[heap->vars[pos]] = pos;
+        pos = child;
+    }
+
+    heap->vars[pos] = var;
+    heap->positions[var] = pos;
+}
+
@@ -0,0 +1,38 @@
+
+#ifndef SIMPLESAT_HEAP_H
+#define SIMPLESAT_HEAP_H
+
+#include <stdbool.h>
+
+typedef struct
+{
+    // Binary max-heap of variables ordered by their keys
+    unsigned int n_vars;
+    unsigned int c_vars;
+    unsigned int *vars;
+
+    // Index of each variable in the heap, if it is present
+    unsigned int *positions;
+
+    // Values that the heap is ordered by, owned by the caller
+    const double *keys;
+}
+Heap;
+
+void create_heap(Heap *, unsigned int, const double *);
+void delete_heap(Heap *);
+
+// Makes room for more variables, whose keys may have moved
+void resize_heap(Heap *, unsigned int, const double *);
+
+bool heap_empty(const Heap *);
+bool heap_contains(const Heap *, unsigned int);
+
+void heap_insert(Heap *, unsigned int);
+unsigned int heap_pop(Heap *);
+
+// Restores the heap order after the key of a variable increases
+void heap_increase(Heap *, unsigned int);
+
+#endif
+
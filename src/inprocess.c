@@ -0,0 +1,373 @@
+#include "inprocess.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "proof.h"
+#include "solver.h"
+#include "utils.h"
+
+// Most binary clauses added for the literals that one probe implies,
+// since none of them are ever deleted
+#define MAX_HYPER_BINARIES 16
+
+// Highest LBD of a learned clause worth vivifying, since the others
+// are likely to be deleted by the next reduction anyway
+#define VIVIFY_MAX_LBD 6
+
+typedef struct
+{
+    unsigned int lbd;
+    unsigned int n_lits;
+    ClauseRef ref;
+}
+VivifyCandidate;
+
+static bool probe(Solver *, uint64_t);
+static bool is_root(const Solver *, Literal);
+static void add_hyper_binaries(Solver *, Literal);
+
+static bool vivify(Solver *, uint64_t);
+static int compare_candidates(const void *, const void *);
+static bool vivify_clause(Solver *, ClauseRef, bool *);
+
+static void assume(Solver *, Literal);
+static void add_learnt(Solver *, const Literal *, unsigned int, unsigned int);
+
+bool inprocess(Solver *solver)
+{
+    uint64_t start = solver->t_unit_props;
+    uint64_t budget;
+    Phase *phases;
+    bool consistent;
+    unsigned int i;
+
+    assert(solver->n_levels == 0);
+
+    // The probes would otherwise leave their own polarities behind
+    // in place of the ones the search was working towards
+    CREATE_ARRAY(phases, solver->n_vars);
+    for (i = 0; i < solver->n_vars; ++i) {
+        phases[i] = solver->vars[i].phase;
+    }
+
+    budget = (uint64_t) (solver->config.inprocess_effort *
+                         (start - solver->inprocess_props));
+
+    // Half of the effort goes on probing, and the rest on
+    // vivification along with whatever probing left unused
+    consistent = probe(solver, start + budget / 2) &&
+                 vivify(solver, start + budget);
+
+    for (i = 0; i < solver->n_vars; ++i) {
+        solver->vars[i].phase = phases[i];
+    }
+    DELETE_ARRAY(phases);
+
+    // The propagations made here do not earn any more effort
+    solver->inprocess_props = solver->t_unit_props;
+    solver->next_inprocess = solver->t_conflicts +
+                             solver->config.inprocess_interval;
+
+    return consistent;
+}
+
+static bool probe(Solver *solver, uint64_t limit)
+{
+    unsigned int n_lits = solver->n_vars << 1;
+    unsigned int i;
+
+    // Each round carries on from where the last one stopped
+    for (i = 0; i < n_lits; ++i) {
+
+        Literal lit = solver->probe_cursor % n_lits;
+        ClauseRef conflict;
+
+        if (solver->t_unit_props >= limit || search_interrupted(solver)) {
+            break;
+        }
+
+        solver->probe_cursor = lit + 1;
+
+        if (solver->values[lit] != VALUE_UNSET ||
+            solver->vars[var_from_lit(lit)].eliminated ||
+            ! is_root(solver, lit)) {
+            continue;
+        }
+
+        assume(solver, lit);
+        conflict = propagate(solver);
+
+        if (conflict == CLAUSE_NONE) {
+            add_hyper_binaries(solver, lit);
+            backtrack(solver, 0);
+            continue;
+        }
+
+        // Analysing a conflict with a single decision learns a unit,
+        // either the probe's negation or a literal that every path
+        // from the probe to the conflict goes through
+        backjump(solver, conflict);
+        solver->t_failed += 1;
+
+        if (propagate(solver) != CLAUSE_NONE) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static bool is_root(const Solver *solver, Literal lit)
+{
+    // A literal that no binary clause implies covers all those that
+    // it implies itself, and it has to imply one to be worth probing
+    return solver->lits[lit].n_binaries == 0 &&
+           solver->lits[negate(lit)].n_binaries > 0;
+}
+
+static void add_hyper_binaries(Solver *solver, Literal probe)
+{
+    unsigned int n_added = 0;
+    unsigned int i;
+
+    // Literals implied through a longer clause are implied by
+    // the probe alone, which a binary clause says directly
+    for (i = solver->level_starts[0] + 1;
+         i < solver->n_assigned && n_added < MAX_HYPER_BINARIES; ++i) {
+
+        Literal lits[2];
+        ClauseRef reason;
+
+        lits[0] = solver->assigned[i];
+        lits[1] = negate(probe);
+
+        reason = solver->vars[var_from_lit(lits[0])].reason;
+        if (reason == CLAUSE_NONE || get_clause(solver, reason)->n_lits == 2) {
+            continue;
+        }
+
+        add_learnt(solver, lits, 2, 2);
+        solver->t_hyper += 1;
+        n_added += 1;
+    }
+}
+
+static bool vivify(Solver *solver, uint64_t limit)
+{
+    VivifyCandidate *candidates;
+    unsigned int n_candidates;
+    ClauseRef *replaced;
+    unsigned int n_replaced;
+    bool consistent = true;
+    unsigned int i;
+    unsigned int j;
+
+    /*
+     * 1. Collect the learned clauses not yet vivified
+     */
+
+    CREATE_ARRAY(candidates, solver->n_learnts + 1);
+    n_candidates = 0;
+
+    for (i = 0; i < solver->n_learnts; ++i) {
+        ClauseRef ref = solver->learnts[i];
+        ClauseState *cstate = get_clause(solver, ref);
+        if (! cstate->vivified && cstate->n_lits > 2 &&
+            cstate->lbd <= VIVIFY_MAX_LBD) {
+            candidates[n_candidates].lbd = cstate->lbd;
+            candidates[n_candidates].n_lits = cstate->n_lits;
+            candidates[n_candidates].ref = ref;
+            n_candidates += 1;
+        }
+    }
+
+    // The clauses most likely to be kept are the most worth shortening
+    qsort(candidates, n_candidates, sizeof(*candidates), compare_candidates);
+
+    /*
+     * 2. Shorten as many of them as the effort allows
+     */
+
+    CREATE_ARRAY(replaced, n_candidates + 1);
+    n_replaced = 0;
+
+    for (i = 0; i < n_candidates && consistent; ++i) {
+
+        bool shortened;
+
+        if (solver->t_unit_props >= limit || search_interrupted(solver)) {
+            break;
+        }
+
+        consistent = vivify_clause(solver, candidates[i].ref, &shortened);
+        if (shortened) {
+            replaced[n_replaced++] = candidates[i].ref;
+        }
+    }
+
+    /*
+     * 3. Delete the clauses that were replaced
+     */
+
+    // They are only deleted now, since the proof must still have
+    // them for as long as they might take part in propagation
+    for (i = 0; i < n_replaced; ++i) {
+        ClauseState *cstate = get_clause(solver, replaced[i]);
+        if (! clause_locked(solver, replaced[i])) {
+            cstate->deleted = 1;
+            if (solver->proof != NULL) {
+                delete_proof_clause(solver->proof, 0,
+                                    cstate->lits, cstate->n_lits);
+            }
+        }
+    }
+
+    DELETE_ARRAY(candidates);
+    DELETE_ARRAY(replaced);
+
+    for (i = j = 0; i < solver->n_learnts; ++i) {
+        if (! get_clause(solver, solver->learnts[i])->deleted) {
+            solver->learnts[j++] = solver->learnts[i];
+        }
+    }
+
+    if (j < solver->n_learnts) {
+        solver->n_learnts = j;
+        collect_garbage(solver);
+    }
+
+    return consistent;
+}
+
+static int compare_candidates(const void *a, const void *b)
+{
+    const VivifyCandidate *x = a;
+    const VivifyCandidate *y = b;
+
+    // Best clauses first, with ties broken by length
+    if (x->lbd != y->lbd) {
+        return x->lbd < y->lbd ? -1 : 1;
+    } else if (x->n_lits != y->n_lits) {
+        return x->n_lits < y->n_lits ? -1 : 1;
+    } else {
+        return 0;
+    }
+}
+
+static bool vivify_clause(Solver *solver, ClauseRef ref, bool *shortened)
+{
+    ClauseState *cstate = get_clause(solver, ref);
+    Literal *lits = solver->learnt_lits;
+    unsigned int n_lits = cstate->n_lits;
+    unsigned int lbd = cstate->lbd;
+    unsigned int n_kept = 0;
+    unsigned int i;
+
+    *shortened = false;
+    cstate->vivified = 1;
+
+    // Propagation moves the literals of the clause around,
+    // so they are worked through from a copy
+    for (i = 0; i < n_lits; ++i) {
+        lits[i] = cstate->lits[i];
+        if (solver->values[lits[i]] == VALUE_TRUE) {
+            return true;
+        }
+    }
+
+    /*
+     * 1. Make the literals false one at a time, until
+     *    the ones made false so far imply the rest
+     */
+
+    for (i = 0; i < n_lits; ++i) {
+
+        Literal lit = lits[i];
+
+        // A literal that they make false can be left out,
+        // and one that they make true is all that is needed
+        if (solver->values[lit] == VALUE_FALSE) {
+            continue;
+        }
+
+        lits[n_kept++] = lit;
+        if (solver->values[lit] == VALUE_TRUE) {
+            break;
+        }
+
+        assume(solver, negate(lit));
+        if (propagate(solver) != CLAUSE_NONE) {
+            break;
+        }
+    }
+
+    backtrack(solver, 0);
+
+    if (n_kept == n_lits) {
+        return true;
+    }
+
+    /*
+     * 2. Learn the shorter clause, which follows from the
+     *    others by propagation alone
+     */
+
+    assert(n_kept > 0);
+
+    *shortened = true;
+    solver->t_vivified += 1;
+
+    if (n_kept > 1) {
+        add_learnt(solver, lits, n_kept, lbd < n_kept ? lbd : n_kept);
+        return true;
+    }
+
+    if (solver->proof != NULL) {
+        add_proof_clause(solver->proof, lits, 1, NULL, 0);
+    }
+    assign_literal(solver, lits[0], CLAUSE_NONE);
+
+    return propagate(solver) == CLAUSE_NONE;
+}
+
+static void assume(Solver *solver, Literal lit)
+{
+    // A level of its own, like a decision but not counted as one
+    solver->level_flipped[solver->n_levels] = true;
+    solver->level_starts[solver->n_levels++] = solver->n_assigned;
+    assign_literal(solver, lit, CLAUSE_NONE);
+}
+
+static void add_learnt(Solver *solver,
+                       const Literal *lits,
+                       unsigned int num_lits,
+                       unsigned int lbd)
+{
+    ClauseRef ref;
+    ClauseState *cstate;
+    unsigned int i;
+
+    if (solver->proof != NULL) {
+        add_proof_clause(solver->proof, lits, num_lits, NULL, 0);
+    }
+
+    ref = alloc_clause(solver, num_lits);
+    cstate = get_clause(solver, ref);
+    cstate->learnt = 1;
+    cstate->vivified = 1;
+    cstate->lbd = lbd;
+    for (i = 0; i < num_lits; ++i) {
+        cstate->lits[i] = lits[i];
+    }
+
+    if (solver->n_learnts == solver->c_learnts) {
+        solver->c_learnts *= 2;
+        REGION_RESIZE(solver->region, solver->learnts, solver->c_learnts);
+    }
+    solver->learnts[solver->n_learnts++] = ref;
+
+    watch_clause(solver, ref);
+}
@@ -0,0 +1,17 @@
+
+#ifndef SIMPLESAT_INPROCESS_H
+#define SIMPLESAT_INPROCESS_H
+
+#include <stdbool.h>
+
+#include "solver.h"
+
+// Probes literals for failures, adding the binary clauses that the
+// probes find shortcuts for, and then shortens learned clauses by
+// propagating their negations, all within the propagations that the
+// effort allows; the solver must be at level 0, where it is left,
+// and false is returned if the clauses turn out to be unsatisfiable
+bool inprocess(Solver *);
+
+#endif
+
@@ -3,14 +3,26 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <time.h>
 
+#include "batch.h"
+#include "component.h"
 #include "constants.h"
+#include "cube.h"
 #include "options.h"
 #include "format.h"
+#include "portfolio.h"
+#include "problem.h"
+#include "progress.h"
+#include "proof.h"
+#include "reader.h"
+#include "region.h"
+#include "server.h"
 #include "solver.h"
+#include "utils.h"
 
 static Error solve_problem(const Options *);
+static Error solve_batch(const Options *);
+static Error serve_requests(const Options *);
 
 int main(int argc, char **argv)
 {
@@ -25,7 +37,16 @@ int main(int argc, char **argv)
     switch (opts.action) {
 
     case ACTION_SOLVE_PROBLEM:
-        err = solve_problem(&opts);
+        // Long searches can be asked how far they have got
+        install_report_signal();
+        use_huge_pages(opts.huge_pages);
+        if (opts.batch) {
+            err = solve_batch(&opts);
+        } else if (opts.serve_address != NULL) {
+            err = serve_requests(&opts);
+        } else {
+            err = solve_problem(&opts);
+        }
         if (err) goto cleanup;
         break;
 
@@ -40,6 +61,8 @@ int main(int argc, char **argv)
 
 cleanup:
 
+    delete_options(&opts);
+
     if (err == ERROR_INVALID_USAGE) {
         fputs("Try --help for usage\n", stderr);
     }
@@ -54,54 +77,180 @@ cleanup:
 static Error solve_problem(const Options *opts)
 {
     Error err = ERROR_OK;
-    Solver solver;
+    Problem problem;
+    Portfolio portfolio;
+    CubePool pool;
+    ComponentPool components;
+    Proof proof;
+    Solver *solver;
+    unsigned int n_threads;
+    double parse_start;
+    double start_time;
+    Reader reader;
+
+    // Without a filename the problem is read from the console
+    parse_start = wall_time();
+    err = open_reader(&reader,
+                      opts->n_infiles > 0 ? opts->infiles[0] : NULL);
+    if (err) {
+        goto cleanup;
+    }
+
+    err = read_problem(&problem, &reader);
+    close_reader(&reader);
+
+    if (err) {
+        goto cleanup;
+    }
+
+    if (opts->proof_file != NULL) {
+        err = open_proof(&proof, opts->proof_file, opts->proof_format,
+                         opts->binary_proof, opts->async_proof);
+        if (err) {
+            goto cleanup_problem;
+        }
+    }
+
+    // A single worker runs without starting any threads
+    n_threads = opts->threads ? opts->threads : count_processors();
+
+    start_time = wall_time();
+    if (opts->cube_depth > 0) {
+        create_cube_pool(&pool, &problem, &opts->config,
+                         n_threads, opts->cube_depth);
+        solver = run_cube_pool(&pool);
+    } else if (opts->components) {
+        create_component_pool(&components, &problem, &opts->config,
+                              n_threads);
+        solver = run_component_pool(&components);
+    } else {
+        create_portfolio(&portfolio, &problem, &opts->config, n_threads);
+        if (opts->proof_file != NULL) {
+            portfolio.proof = &proof;
+        }
+        solver = run_portfolio(&portfolio);
+    }
+    solver->parse_time = start_time - parse_start;
+    solver->start_time = start_time;
+    solver->stop_time = wall_time();
 
-    if (opts->infile != NULL) {
+    // The proof is complete once the search is over
+    if (opts->proof_file != NULL) {
+        err = close_proof(&proof);
+    }
 
-        FILE *stream = fopen(opts->infile, "r");
+    if (opts->outfile != NULL) {
+
+        FILE *stream = fopen(opts->outfile, "w");
 
         if (stream == NULL) {
             fprintf(stderr, PROGRAM_NAME ": %s: %s\n",
-                    opts->infile, strerror(errno));
+                    opts->outfile, strerror(errno));
             err = ERROR_FILE_ACCESS;
-            goto cleanup;
+            goto cleanup_portfolio;
         }
 
-        err = read_problem(&solver, stream);
+        write_solution(solver, opts->model_format, stream);
         fclose(stream);
 
     } else {
-        err = read_problem(&solver, stdin);
+        write_solution(solver, opts->model_format, stdout);
     }
 
-    if (err) {
-        goto cleanup;
+cleanup_portfolio:
+    if (opts->cube_depth > 0) {
+        delete_cube_pool(&pool);
+    } else if (opts->components) {
+        delete_component_pool(&components);
+    } else {
+        delete_portfolio(&portfolio);
     }
 
-    solver.start_time = clock();
-    solver.solution = search_assignments(&solver);
-    solver.stop_time = clock();
+cleanup_problem:
+    delete_problem(&problem);
 
-    if (opts->outfile != NULL) {
+cleanup:
+    return err;
+}
 
-        FILE *stream = fopen(opts->outfile, "w");
+static Error solve_batch(const Options *opts)
+{
+    Error err = ERROR_OK;
+    Batch batch;
+    FILE *stream = stdout;
+    unsigned int n_threads;
+    unsigned int i;
 
+    if (opts->outfile != NULL) {
+        stream = fopen(opts->outfile, "w");
         if (stream == NULL) {
             fprintf(stderr, PROGRAM_NAME ": %s: %s\n",
                     opts->outfile, strerror(errno));
             err = ERROR_FILE_ACCESS;
-            goto cleanup_solver;
+            goto cleanup;
         }
+    }
 
-        write_solution(&solver, stream);
-        fclose(stream);
+    n_threads = opts->threads ? opts->threads : count_processors();
+    create_batch(&batch, &opts->config, n_threads,
+                 opts->time_limit, stream);
 
+    // Without any filenames they are listed on the console
+    if (opts->n_infiles > 0) {
+        for (i = 0; i < opts->n_infiles; ++i) {
+            add_batch_file(&batch, opts->infiles[i]);
+        }
     } else {
-        write_solution(&solver, stdout);
+        err = read_manifest(&batch, stdin);
+        if (err) {
+            goto cleanup_batch;
+        }
     }
 
-cleanup_solver:
-    delete_solver(&solver);
+    run_batch(&batch);
+
+cleanup_batch:
+    delete_batch(&batch);
+    if (stream != stdout) {
+        fclose(stream);
+    }
+
+cleanup:
+    return err;
+}
+
+static Error serve_requests(const Options *opts)
+{
+    Error err = ERROR_OK;
+    Server server;
+    FILE *stream = stdout;
+    unsigned int n_threads;
+
+    if (opts->outfile != NULL) {
+        stream = fopen(opts->outfile, "w");
+        if (stream == NULL) {
+            fprintf(stderr, PROGRAM_NAME ": %s: %s\n",
+                    opts->outfile, strerror(errno));
+            err = ERROR_FILE_ACCESS;
+            goto cleanup;
+        }
+    }
+
+    n_threads = opts->threads ? opts->threads : count_processors();
+    err = create_server(&server, opts->serve_address, &opts->config,
+                        n_threads, opts->cache_size,
+                        (size_t) opts->max_request << 20, stream);
+    if (err) {
+        goto cleanup_stream;
+    }
+
+    run_server(&server);
+    delete_server(&server);
+
+cleanup_stream:
+    if (stream != stdout) {
+        fclose(stream);
+    }
 
 cleanup:
     return err;
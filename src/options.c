@@ -1,20 +1,52 @@
 
 #include "options.h"
 
+#include <ctype.h>
+#include <errno.h>
+#include <limits.h>
+#include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "constants.h"
 #include "error.h"
+#include "solver.h"
+#include "utils.h"
+
+static const char *get_argument(int *, int, char **);
+static Error invalid_value(const char *, const char *);
+static Error parse_count(const char *, const char *, unsigned int *);
+static Error parse_large_count(const char *, const char *, uint64_t *);
+static Error parse_fraction(const char *, const char *, double *);
+static Error parse_seconds(const char *, const char *, double *);
 
 Error parse_options(Options *opts, int argc, char **argv)
 {
     int i;
     const char *arg;
+    const char *value;
 
-    opts->infile = NULL;
+    opts->n_infiles = 0;
+    CREATE_ARRAY(opts->infiles, argc);
     opts->outfile = NULL;
+    opts->model_format = MODEL_DIMACS;
     opts->action = ACTION_SOLVE_PROBLEM;
+    opts->threads = 1;
+    opts->cube_depth = 0;
+    opts->components = false;
+    opts->batch = false;
+    opts->time_limit = 0.0;
+    opts->serve_address = NULL;
+    opts->cache_size = 64;
+    opts->max_request = 64;
+    opts->huge_pages = false;
+    opts->proof_file = NULL;
+    opts->proof_format = PROOF_DRAT;
+    opts->binary_proof = false;
+    opts->async_proof = false;
+    default_config(&opts->config);
 
     for (i = 1; i < argc; ++i) {
         arg = argv[i];
@@ -26,12 +58,266 @@ Error parse_options(Options *opts, int argc, char **argv)
             } else if (strcmp(arg, "--version") == 0) {
                 opts->action = ACTION_SHOW_VERSION;
             } else if (strcmp(arg, "-o") == 0) {
-                if (++i != argc) {
-                    opts->outfile = argv[i];
+                if ((value = get_argument(&i, argc, argv)) == NULL) {
+                    return ERROR_INVALID_USAGE;
+                }
+                opts->outfile = value;
+            } else if (strcmp(arg, "--model-format") == 0) {
+                if ((value = get_argument(&i, argc, argv)) == NULL) {
+                    return ERROR_INVALID_USAGE;
+                } else if (strcmp(value, "dimacs") == 0) {
+                    opts->model_format = MODEL_DIMACS;
+                } else if (strcmp(value, "json") == 0) {
+                    opts->model_format = MODEL_JSON;
+                } else if (strcmp(value, "binary") == 0) {
+                    opts->model_format = MODEL_BINARY;
+                } else {
+                    return invalid_value(arg, value);
+                }
+            } else if (strcmp(arg, "--threads") == 0) {
+                if ((value = get_argument(&i, argc, argv)) == NULL) {
+                    return ERROR_INVALID_USAGE;
+                } else if (parse_count(arg, value, &opts->threads)) {
+                    return ERROR_INVALID_USAGE;
+                }
+            } else if (strcmp(arg, "--cubes") == 0) {
+                if ((value = get_argument(&i, argc, argv)) == NULL) {
+                    return ERROR_INVALID_USAGE;
+                } else if (parse_count(arg, value, &opts->cube_depth)) {
+                    return ERROR_INVALID_USAGE;
+                }
+            } else if (strcmp(arg, "--components") == 0) {
+                opts->components = true;
+            } else if (strcmp(arg, "--batch") == 0) {
+                opts->batch = true;
+            } else if (strcmp(arg, "--time-limit") == 0) {
+                if ((value = get_argument(&i, argc, argv)) == NULL) {
+                    return ERROR_INVALID_USAGE;
+                } else if (parse_seconds(arg, value, &opts->time_limit)) {
+                    return ERROR_INVALID_USAGE;
+                }
+            } else if (strcmp(arg, "--serve") == 0) {
+                if ((value = get_argument(&i, argc, argv)) == NULL) {
+                    return ERROR_INVALID_USAGE;
+                }
+                opts->serve_address = value;
+            } else if (strcmp(arg, "--cache") == 0) {
+                if ((value = get_argument(&i, argc, argv)) == NULL) {
+                    return ERROR_INVALID_USAGE;
+                } else if (parse_count(arg, value, &opts->cache_size)) {
+                    return ERROR_INVALID_USAGE;
+                }
+            } else if (strcmp(arg, "--max-request") == 0) {
+                if ((value = get_argument(&i, argc, argv)) == NULL) {
+                    return ERROR_INVALID_USAGE;
+                } else if (parse_count(arg, value, &opts->max_request)) {
+                    return ERROR_INVALID_USAGE;
+                } else if (opts->max_request == 0) {
+                    // No instance could be sent at all
+                    return invalid_value(arg, value);
+                }
+            } else if (strcmp(arg, "--huge-pages") == 0) {
+                opts->huge_pages = true;
+            } else if (strcmp(arg, "--proof") == 0) {
+                if ((value = get_argument(&i, argc, argv)) == NULL) {
+                    return ERROR_INVALID_USAGE;
+                }
+                opts->proof_file = value;
+            } else if (strcmp(arg, "--proof-format") == 0) {
+                if ((value = get_argument(&i, argc, argv)) == NULL) {
+                    return ERROR_INVALID_USAGE;
+                } else if (strcmp(value, "drat") == 0) {
+                    opts->proof_format = PROOF_DRAT;
+                } else if (strcmp(value, "lrat") == 0) {
+                    opts->proof_format = PROOF_LRAT;
+                } else {
+                    return invalid_value(arg, value);
+                }
+            } else if (strcmp(arg, "--binary-proof") == 0) {
+                opts->binary_proof = true;
+            } else if (strcmp(arg, "--async-proof") == 0) {
+                opts->async_proof = true;
+            } else if (strcmp(arg, "--progress") == 0) {
+                if ((value = get_argument(&i, argc, argv)) == NULL) {
+                    return ERROR_INVALID_USAGE;
+                } else if (parse_seconds(arg, value,
+                                         &opts->config.report_interval)) {
+                    return ERROR_INVALID_USAGE;
+                }
+            } else if (strcmp(arg, "--search") == 0) {
+                if ((value = get_argument(&i, argc, argv)) == NULL) {
+                    return ERROR_INVALID_USAGE;
+                } else if (strcmp(value, "cdcl") == 0) {
+                    opts->config.search = SEARCH_CDCL;
+                } else if (strcmp(value, "dpll") == 0) {
+                    opts->config.search = SEARCH_DPLL;
+                } else if (strcmp(value, "walk") == 0) {
+                    opts->config.search = SEARCH_WALK;
+                } else {
+                    return invalid_value(arg, value);
+                }
+            } else if (strcmp(arg, "--walk") == 0) {
+                if ((value = get_argument(&i, argc, argv)) == NULL) {
+                    return ERROR_INVALID_USAGE;
+                } else if (strcmp(value, "probsat") == 0) {
+                    opts->config.walk = WALK_PROBSAT;
+                } else if (strcmp(value, "walksat") == 0) {
+                    opts->config.walk = WALK_WALKSAT;
+                } else {
+                    return invalid_value(arg, value);
+                }
+            } else if (strcmp(arg, "--walk-interval") == 0) {
+                if ((value = get_argument(&i, argc, argv)) == NULL) {
+                    return ERROR_INVALID_USAGE;
+                } else if (parse_count(arg, value,
+                                       &opts->config.walk_interval)) {
+                    return ERROR_INVALID_USAGE;
+                }
+            } else if (strcmp(arg, "--walk-flips") == 0) {
+                if ((value = get_argument(&i, argc, argv)) == NULL) {
+                    return ERROR_INVALID_USAGE;
+                } else if (parse_count(arg, value,
+                                       &opts->config.walk_flips)) {
+                    return ERROR_INVALID_USAGE;
+                } else if (opts->config.walk_flips == 0) {
+                    // The complete search would never get a turn
+                    return invalid_value(arg, value);
+                }
+            } else if (strcmp(arg, "--inprocess-interval") == 0) {
+                if ((value = get_argument(&i, argc, argv)) == NULL) {
+                    return ERROR_INVALID_USAGE;
+                } else if (parse_count(arg, value,
+                                       &opts->config.inprocess_interval)) {
+                    return ERROR_INVALID_USAGE;
+                }
+            } else if (strcmp(arg, "--inprocess-effort") == 0) {
+                if ((value = get_argument(&i, argc, argv)) == NULL) {
+                    return ERROR_INVALID_USAGE;
+                } else if (parse_fraction(arg, value,
+                                          &opts->config.inprocess_effort)) {
+                    return ERROR_INVALID_USAGE;
+                }
+            } else if (strcmp(arg, "--branching") == 0) {
+                if ((value = get_argument(&i, argc, argv)) == NULL) {
+                    return ERROR_INVALID_USAGE;
+                } else if (strcmp(value, "vsids") == 0) {
+                    opts->config.branching = BRANCH_VSIDS;
+                } else if (strcmp(value, "occurrence") == 0) {
+                    opts->config.branching = BRANCH_OCCURRENCE;
                 } else {
-                    fprintf(stderr,
-                            PROGRAM_NAME ": %s: Expected argument\n",
-                            arg);
+                    return invalid_value(arg, value);
+                }
+            } else if (strcmp(arg, "--no-preprocess") == 0) {
+                opts->config.preprocess = false;
+            } else if (strcmp(arg, "--no-gauss") == 0) {
+                opts->config.gauss = false;
+            } else if (strcmp(arg, "--restarts") == 0) {
+                if ((value = get_argument(&i, argc, argv)) == NULL) {
+                    return ERROR_INVALID_USAGE;
+                } else if (strcmp(value, "luby") == 0) {
+                    opts->config.restarts = RESTART_LUBY;
+                } else if (strcmp(value, "glucose") == 0) {
+                    opts->config.restarts = RESTART_GLUCOSE;
+                } else if (strcmp(value, "none") == 0) {
+                    opts->config.restarts = RESTART_NONE;
+                } else {
+                    return invalid_value(arg, value);
+                }
+            } else if (strcmp(arg, "--no-phase-saving") == 0) {
+                opts->config.phase_saving = false;
+            } else if (strcmp(arg, "--phase") == 0) {
+                if ((value = get_argument(&i, argc, argv)) == NULL) {
+                    return ERROR_INVALID_USAGE;
+                } else if (strcmp(value, "negative") == 0) {
+                    opts->config.initial_phase = PHASE_NEGATIVE;
+                } else if (strcmp(value, "positive") == 0) {
+                    opts->config.initial_phase = PHASE_POSITIVE;
+                } else {
+                    return invalid_value(arg, value);
+                }
+            } else if (strcmp(arg, "--seed") == 0) {
+                if ((value = get_argument(&i, argc, argv)) == NULL) {
+                    return ERROR_INVALID_USAGE;
+                } else if (parse_count(arg, value, &opts->config.seed)) {
+                    return ERROR_INVALID_USAGE;
+                }
+            } else if (strcmp(arg, "--reduce-interval") == 0) {
+                if ((value = get_argument(&i, argc, argv)) == NULL) {
+                    return ERROR_INVALID_USAGE;
+                } else if (parse_count(arg, value,
+                                       &opts->config.reduce_interval)) {
+                    return ERROR_INVALID_USAGE;
+                }
+            } else if (strcmp(arg, "--reduce-increment") == 0) {
+                if ((value = get_argument(&i, argc, argv)) == NULL) {
+                    return ERROR_INVALID_USAGE;
+                } else if (parse_count(arg, value,
+                                       &opts->config.reduce_increment)) {
+                    return ERROR_INVALID_USAGE;
+                }
+            } else if (strcmp(arg, "--glue-lbd") == 0) {
+                if ((value = get_argument(&i, argc, argv)) == NULL) {
+                    return ERROR_INVALID_USAGE;
+                } else if (parse_count(arg, value,
+                                       &opts->config.glue_lbd)) {
+                    return ERROR_INVALID_USAGE;
+                }
+            } else if (strcmp(arg, "--reduce-fraction") == 0) {
+                if ((value = get_argument(&i, argc, argv)) == NULL) {
+                    return ERROR_INVALID_USAGE;
+                } else if (parse_fraction(arg, value,
+                                          &opts->config.reduce_fraction)) {
+                    return ERROR_INVALID_USAGE;
+                }
+            } else if (strcmp(arg, "--no-sharing") == 0) {
+                opts->config.share_clauses = false;
+            } else if (strcmp(arg, "--share-size") == 0) {
+                if ((value = get_argument(&i, argc, argv)) == NULL) {
+                    return ERROR_INVALID_USAGE;
+                } else if (parse_count(arg, value,
+                                       &opts->config.share_max_lits)) {
+                    return ERROR_INVALID_USAGE;
+                }
+            } else if (strcmp(arg, "--share-lbd") == 0) {
+                if ((value = get_argument(&i, argc, argv)) == NULL) {
+                    return ERROR_INVALID_USAGE;
+                } else if (parse_count(arg, value,
+                                       &opts->config.share_max_lbd)) {
+                    return ERROR_INVALID_USAGE;
+                }
+            } else if (strcmp(arg, "--share-imports") == 0) {
+                if ((value = get_argument(&i, argc, argv)) == NULL) {
+                    return ERROR_INVALID_USAGE;
+                } else if (parse_count(arg, value,
+                                       &opts->config.share_import_limit)) {
+                    return ERROR_INVALID_USAGE;
+                }
+            } else if (strcmp(arg, "--max-conflicts") == 0) {
+                if ((value = get_argument(&i, argc, argv)) == NULL) {
+                    return ERROR_INVALID_USAGE;
+                } else if (parse_large_count(arg, value,
+                                             &opts->config.max_conflicts)) {
+                    return ERROR_INVALID_USAGE;
+                }
+            } else if (strcmp(arg, "--max-propagations") == 0) {
+                if ((value = get_argument(&i, argc, argv)) == NULL) {
+                    return ERROR_INVALID_USAGE;
+                } else if (parse_large_count(arg, value,
+                               &opts->config.max_propagations)) {
+                    return ERROR_INVALID_USAGE;
+                }
+            } else if (strcmp(arg, "--max-time") == 0) {
+                if ((value = get_argument(&i, argc, argv)) == NULL) {
+                    return ERROR_INVALID_USAGE;
+                } else if (parse_seconds(arg, value,
+                                         &opts->config.max_seconds)) {
+                    return ERROR_INVALID_USAGE;
+                }
+            } else if (strcmp(arg, "--max-memory") == 0) {
+                if ((value = get_argument(&i, argc, argv)) == NULL) {
+                    return ERROR_INVALID_USAGE;
+                } else if (parse_count(arg, value,
+                                       &opts->config.max_memory)) {
                     return ERROR_INVALID_USAGE;
                 }
             } else {
@@ -41,28 +327,311 @@ Error parse_options(Options *opts, int argc, char **argv)
         } else {
             // Arguments that do not start with "-"
             // are taken as input filenames
-            if (opts->infile == NULL) {
-                opts->infile = arg;
-            } else {
-                fprintf(stderr, PROGRAM_NAME ": %s: Extra argument\n", arg);
-                return ERROR_INVALID_USAGE;
-            }
+            opts->infiles[opts->n_infiles++] = arg;
+        }
+    }
+
+    // Only a batch can take more than one problem
+    if (! opts->batch && opts->n_infiles > 1) {
+        fprintf(stderr, PROGRAM_NAME ": %s: Extra argument\n",
+                opts->infiles[1]);
+        return ERROR_INVALID_USAGE;
+    } else if (opts->batch && opts->model_format != MODEL_DIMACS) {
+        fprintf(stderr, PROGRAM_NAME ": --model-format: "
+                "Not used in batch mode\n");
+        return ERROR_INVALID_USAGE;
+    } else if (opts->batch && opts->cube_depth > 0) {
+        fprintf(stderr, PROGRAM_NAME ": --cubes: Not used in batch mode\n");
+        return ERROR_INVALID_USAGE;
+    } else if (opts->batch && opts->components) {
+        fprintf(stderr, PROGRAM_NAME ": --components: "
+                "Not used in batch mode\n");
+        return ERROR_INVALID_USAGE;
+    } else if (opts->components && opts->cube_depth > 0) {
+        fprintf(stderr, PROGRAM_NAME ": --components: "
+                "Cannot be split into cubes as well\n");
+        return ERROR_INVALID_USAGE;
+    }
+
+    // A server reads every instance from its clients
+    if (opts->serve_address != NULL) {
+        if (opts->batch) {
+            fprintf(stderr, PROGRAM_NAME ": --serve: "
+                    "Not used in batch mode\n");
+            return ERROR_INVALID_USAGE;
+        } else if (opts->n_infiles > 0) {
+            fprintf(stderr, PROGRAM_NAME ": %s: Extra argument\n",
+                    opts->infiles[0]);
+            return ERROR_INVALID_USAGE;
+        } else if (opts->cube_depth > 0 || opts->components) {
+            fprintf(stderr, PROGRAM_NAME ": --serve: "
+                    "Solves each instance with a single solver\n");
+            return ERROR_INVALID_USAGE;
+        } else if (opts->model_format != MODEL_DIMACS) {
+            fprintf(stderr, PROGRAM_NAME ": --model-format: "
+                    "Not used by a server\n");
+            return ERROR_INVALID_USAGE;
+        } else if (opts->proof_file != NULL) {
+            fprintf(stderr, PROGRAM_NAME ": --proof: "
+                    "Not used by a server\n");
+            return ERROR_INVALID_USAGE;
+        }
+    }
+
+    // A proof follows a single solver through the whole search
+    if (opts->proof_file != NULL) {
+        if (opts->batch) {
+            fprintf(stderr, PROGRAM_NAME ": --proof: "
+                    "Not used in batch mode\n");
+            return ERROR_INVALID_USAGE;
+        } else if (opts->threads != 1 || opts->cube_depth > 0 ||
+                   opts->components) {
+            fprintf(stderr, PROGRAM_NAME ": --proof: "
+                    "Needs a single solver for the whole problem\n");
+            return ERROR_INVALID_USAGE;
+        } else if (opts->config.search == SEARCH_WALK) {
+            fprintf(stderr, PROGRAM_NAME ": --proof: "
+                    "Local search cannot prove anything\n");
+            return ERROR_INVALID_USAGE;
+        } else if (opts->proof_format == PROOF_LRAT &&
+                   opts->config.search != SEARCH_CDCL) {
+            fprintf(stderr, PROGRAM_NAME ": --proof-format: "
+                    "LRAT needs clause learning\n");
+            return ERROR_INVALID_USAGE;
+        }
+
+        // Hints are not kept for the steps of preprocessing
+        if (opts->proof_format == PROOF_LRAT) {
+            opts->config.preprocess = false;
         }
     }
 
     return ERROR_OK;
 }
 
+void delete_options(Options *opts)
+{
+    DELETE_ARRAY(opts->infiles);
+}
+
+static const char *get_argument(int *i, int argc, char **argv)
+{
+    // Options taking a value read it from the next argument
+    if (*i + 1 == argc) {
+        fprintf(stderr, PROGRAM_NAME ": %s: Expected argument\n", argv[*i]);
+        return NULL;
+    }
+
+    return argv[++*i];
+}
+
+static Error invalid_value(const char *arg, const char *value)
+{
+    fprintf(stderr, PROGRAM_NAME ": %s: %s: Invalid value\n", arg, value);
+    return ERROR_INVALID_USAGE;
+}
+
+static Error parse_count(const char *arg,
+                         const char *value,
+                         unsigned int *count)
+{
+    uint64_t result;
+
+    if (parse_large_count(arg, value, &result)) {
+        return ERROR_INVALID_USAGE;
+    } else if (result > UINT_MAX) {
+        return invalid_value(arg, value);
+    }
+
+    *count = (unsigned int) result;
+    return ERROR_OK;
+}
+
+static Error parse_large_count(const char *arg,
+                               const char *value,
+                               uint64_t *count)
+{
+    char *end;
+    unsigned long long result;
+
+    // Reject signs, since strtoull would silently wrap them around
+    if (! isdigit((unsigned char) value[0])) {
+        return invalid_value(arg, value);
+    }
+
+    errno = 0;
+    result = strtoull(value, &end, 10);
+    if (errno != 0 || *end != '\0' || result > UINT64_MAX) {
+        return invalid_value(arg, value);
+    }
+
+    *count = (uint64_t) result;
+    return ERROR_OK;
+}
+
+static Error parse_fraction(const char *arg,
+                            const char *value,
+                            double *fraction)
+{
+    char *end;
+    double result;
+
+    errno = 0;
+    result = strtod(value, &end);
+    if (errno != 0 || *end != '\0' || ! (result >= 0.0 && result <= 1.0)) {
+        return invalid_value(arg, value);
+    }
+
+    *fraction = result;
+    return ERROR_OK;
+}
+
+static Error parse_seconds(const char *arg,
+                           const char *value,
+                           double *seconds)
+{
+    char *end;
+    double result;
+
+    errno = 0;
+    result = strtod(value, &end);
+    if (errno != 0 || *end != '\0' || ! (result >= 0.0 && result < 1e9)) {
+        return invalid_value(arg, value);
+    }
+
+    *seconds = result;
+    return ERROR_OK;
+}
+
 void show_help(void)
 {
-    const char *help_text =
+    // Each part is a literal of its own, well inside the length
+    // that every compiler has to take
+    fputs(
         "Usage: " PROGRAM_NAME " [options] <file>\n"
+        "       " PROGRAM_NAME " --batch [options] <file>...\n"
+        "       " PROGRAM_NAME " --serve <address> [options]\n"
         "Options:\n"
-        "  --help     Show this help text\n"
-        "  --version  Show the program version\n"
-        "  -o <file>  Set the output file\n";
+        "  --help              Show this help text\n"
+        "  --version           Show the program version\n"
+        "  -o <file>           Set the output file\n"
+        "  --model-format <type>\n"
+        "                      Write the solution as dimacs, json\n"
+        "                      or binary (default dimacs)\n"
+        "  --threads <n>       Run a portfolio of differently\n"
+        "                      configured solvers side by side\n"
+        "                      (default 1, 0 for every processor)\n"
+        "  --cubes <depth>     Split the problem by lookahead up to\n"
+        "                      this depth and share the cubes out\n"
+        "                      between the threads (default 0, off)\n"
+        "  --components        Solve each part of the problem that\n"
+        "                      shares no variables with the rest on\n"
+        "                      its own, sharing them out between the\n"
+        "                      threads\n"
+        "  --batch             Solve each file given, or each one\n"
+        "                      listed on the input if none are, using\n"
+        "                      --threads workers at a time, and write\n"
+        "                      a line per file with its path, status,\n"
+        "                      seconds, branches and propagations\n"
+        "  --time-limit <s>    Give up on each file of a batch after\n"
+        "                      this many seconds (default 0, never)\n"
+        "  --serve <address>   Answer requests on a Unix socket at\n"
+        "                      this path, or on [host:]port, using\n"
+        "                      --threads workers at a time\n"
+        "  --cache <n>         Instances a server keeps parsed, with\n"
+        "                      their answers (default 64)\n"
+        "  --max-request <MB>  Largest input a server takes in one\n"
+        "                      request (default 64)\n"
+        "  --huge-pages        Keep the solvers' memory in huge pages\n"
+        "                      where the system has them\n",
+        stdout);
+
+    fputs(
+        "  --proof <file>      Write a proof of unsatisfiability\n"
+        "                      to this file (single thread only)\n"
+        "  --proof-format <type>\n"
+        "                      Write the proof as DRAT (drat,\n"
+        "                      default) or as LRAT with the clauses\n"
+        "                      each step follows from (lrat), which\n"
+        "                      turns off preprocessing\n"
+        "  --binary-proof      Write the proof in binary form\n"
+        "  --async-proof       Write the proof from a thread apart\n"
+        "                      from the search\n"
+        "  --progress <s>      Report on the search to stderr every\n"
+        "                      this many seconds (default 0, never);\n"
+        "                      SIGUSR1 asks for a report at any time\n",
+        stdout);
+
+    fputs(
+        "  --search <mode>     Use clause learning (cdcl, default),\n"
+        "                      plain backtracking (dpll) or local\n"
+        "                      search (walk), which can only find\n"
+        "                      solutions\n"
+        "  --walk <type>       Flip variables as ProbSAT (probsat,\n"
+        "                      default) or WalkSAT (walksat) does\n"
+        "  --walk-interval <n> Also run local search every this many\n"
+        "                      restarts, and branch on the best\n"
+        "                      assignment it finds (default 0, never)\n"
+        "  --walk-flips <n>    Flips for each of those runs\n"
+        "                      (default 100000)\n"
+        "  --inprocess-interval <n>\n"
+        "                      Conflicts between rounds of probing\n"
+        "                      for failed literals and vivifying\n"
+        "                      learned clauses (default 5000, 0 never)\n"
+        "  --inprocess-effort <f>\n"
+        "                      Propagations each round may take, as a\n"
+        "                      fraction of those of the search since\n"
+        "                      the last one (default 0.02)\n"
+        "  --branching <type>  Choose branches by conflict activity\n"
+        "                      (vsids, default) or by occurrences\n"
+        "                      in short clauses (occurrence)\n"
+        "  --no-preprocess     Search the clauses as given, without\n"
+        "                      eliminating variables first\n"
+        "  --no-gauss          Do not look for XOR constraints among\n"
+        "                      the clauses to reason about together\n"
+        "  --restarts <type>   Restart on the Luby sequence (luby,\n"
+        "                      default), when recent learned clauses\n"
+        "                      are poor (glucose) or never (none)\n"
+        "  --no-phase-saving   Do not reuse the previous polarity\n"
+        "                      of a variable when branching on it\n"
+        "  --phase <value>     Polarity to try first for variables\n"
+        "                      without a previous one (negative,\n"
+        "                      default, or positive)\n"
+        "  --seed <n>          Break ties between variables at random\n"
+        "                      from this seed (default 0, no random)\n",
+        stdout);
 
-    fputs(help_text, stdout);
+    fputs(
+        "  --reduce-interval <n>\n"
+        "                      Conflicts before learned clauses are\n"
+        "                      first reduced (default 2000)\n"
+        "  --reduce-increment <n>\n"
+        "                      Growth of the interval after each\n"
+        "                      reduction (default 300)\n"
+        "  --glue-lbd <n>      Always keep learned clauses with at\n"
+        "                      most this LBD (default 2)\n"
+        "  --reduce-fraction <f>\n"
+        "                      Fraction of the other learned clauses\n"
+        "                      deleted by a reduction (default 0.5)\n"
+        "  --no-sharing        Do not trade learned clauses between\n"
+        "                      the solvers of a portfolio\n"
+        "  --share-size <n>    Longest learned clause passed on to\n"
+        "                      the other solvers (default 8)\n"
+        "  --share-lbd <n>     Highest LBD of a learned clause passed\n"
+        "                      on to the other solvers (default 3)\n"
+        "  --share-imports <n>\n"
+        "                      Clauses taken from the other solvers\n"
+        "                      at each restart (default 1000)\n"
+        "  --max-conflicts <n> Give up with an unknown result after\n"
+        "                      this many conflicts (default 0, never)\n"
+        "  --max-propagations <n>\n"
+        "                      Give up after this many unit\n"
+        "                      propagations (default 0, never)\n"
+        "  --max-time <s>      Give up after searching for this many\n"
+        "                      seconds (default 0, never)\n"
+        "  --max-memory <MB>   Give up once a solver holds this many\n"
+        "                      megabytes (default 0, never)\n",
+        stdout);
 }
 
 void show_version(void)
@@ -2,13 +2,59 @@
 #ifndef SIMPLESAT_OPTIONS_H
 #define SIMPLESAT_OPTIONS_H
 
+#include <stdbool.h>
+
 #include "error.h"
+#include "format.h"
+#include "proof.h"
+#include "solver.h"
 
 typedef struct
 {
-    const char *infile;
+    // Input filenames as given, of which there may only be
+    // more than one in batch mode
+    unsigned int n_infiles;
+    const char **infiles;
     const char *outfile;
 
+    // How the solution is written there
+    ModelFormat model_format;
+
+    SolverConfig config;
+
+    // Solvers run side by side, one for each processor if zero
+    unsigned int threads;
+
+    // Depth to split the problem to for the solvers to share out,
+    // or zero to have them each work on the whole problem
+    unsigned int cube_depth;
+
+    // Split the problem into parts that share no variables, for
+    // the solvers to take one at a time instead
+    bool components;
+
+    // Solve many problems at once, one per thread, giving up on
+    // each after `time_limit` seconds unless that is zero
+    bool batch;
+    double time_limit;
+
+    // Answer requests on a socket at this address instead, keeping
+    // up to `cache_size` of the instances they describe in memory,
+    // each of them at most `max_request` megabytes of input
+    const char *serve_address;
+    unsigned int cache_size;
+    unsigned int max_request;
+
+    // Ask for huge pages to hold the solvers' memory
+    bool huge_pages;
+
+    // Where to write a proof when the problem is unsatisfiable,
+    // if anywhere, and how to write it
+    const char *proof_file;
+    ProofFormat proof_format;
+    bool binary_proof;
+    bool async_proof;
+
     enum
     {
         ACTION_SOLVE_PROBLEM,
@@ -20,6 +66,7 @@ typedef struct
 Options;
 
 Error parse_options(Options *, int, char **);
+void delete_options(Options *);
 
 void show_help(void);
 void show_version(void);
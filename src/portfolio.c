@@ -0,0 +1,159 @@
+
+#include "portfolio.h"
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <unistd.h>
+
+#include "exchange.h"
+#include "problem.h"
+#include "proof.h"
+#include "solver.h"
+#include "utils.h"
+#include "workers.h"
+
+typedef struct
+{
+    Portfolio *portfolio;
+    unsigned int index;
+}
+WorkerTask;
+
+static void vary_config(SolverConfig *, unsigned int);
+static void *run_worker(void *);
+
+void create_portfolio(Portfolio *portfolio,
+                      const Problem *problem,
+                      const SolverConfig *config,
+                      unsigned int num_workers)
+{
+    portfolio->problem = problem;
+    portfolio->config = *config;
+
+    // The solvers are created by the threads that run them
+    portfolio->n_workers = num_workers > 0 ? num_workers : 1;
+    CREATE_ARRAY(portfolio->workers, portfolio->n_workers);
+
+    // Plain backtracking does not learn anything to share
+    portfolio->sharing = portfolio->n_workers > 1 &&
+                         config->share_clauses &&
+                         config->search == SEARCH_CDCL;
+    if (portfolio->sharing) {
+        create_exchange(&portfolio->exchange, portfolio->n_workers);
+    }
+
+    atomic_init(&portfolio->winner, WINNER_NONE);
+    atomic_init(&portfolio->stop, false);
+
+    portfolio->proof = NULL;
+}
+
+void delete_portfolio(Portfolio *portfolio)
+{
+    unsigned int i;
+
+    for (i = 0; i < portfolio->n_workers; ++i) {
+        delete_solver(&portfolio->workers[i]);
+    }
+
+    DELETE_ARRAY(portfolio->workers);
+
+    if (portfolio->sharing) {
+        delete_exchange(&portfolio->exchange);
+    }
+}
+
+Solver *run_portfolio(Portfolio *portfolio)
+{
+    WorkerTask *tasks;
+    unsigned int winner;
+    unsigned int i;
+
+    CREATE_ARRAY(tasks, portfolio->n_workers);
+
+    for (i = 0; i < portfolio->n_workers; ++i) {
+        tasks[i].portfolio = portfolio;
+        tasks[i].index = i;
+    }
+
+    // Workers that never started have no solver to clean up
+    portfolio->n_workers = run_workers(run_worker, tasks, sizeof(*tasks),
+                                       portfolio->n_workers);
+
+    DELETE_ARRAY(tasks);
+
+    // No worker has an answer only if every one was cut short
+    winner = atomic_load(&portfolio->winner);
+    if (winner == WINNER_NONE) {
+        winner = 0;
+    }
+
+    return &portfolio->workers[winner];
+}
+
+unsigned int count_processors(void)
+{
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+
+    if (count < 1) {
+        return 1;
+    } else {
+        return (unsigned int) count;
+    }
+}
+
+static void vary_config(SolverConfig *config, unsigned int index)
+{
+    // The first worker keeps the configuration it was given
+    if (index == 0) {
+        return;
+    }
+
+    // Spread the others over both restart policies and
+    // both polarities, each with a seed of its own
+    config->seed += index;
+
+    if (index & 1) {
+        config->initial_phase = config->initial_phase == PHASE_POSITIVE ?
+                                PHASE_NEGATIVE : PHASE_POSITIVE;
+    }
+
+    if (index & 2) {
+        config->restarts = config->restarts == RESTART_LUBY ?
+                           RESTART_GLUCOSE : RESTART_LUBY;
+    }
+
+    if (index & 4) {
+        config->activity_decay = config->activity_decay < 0.9 ?
+                                 0.95 : 0.85;
+    }
+}
+
+static void *run_worker(void *arg)
+{
+    WorkerTask *task = arg;
+    Portfolio *portfolio = task->portfolio;
+    Solver *solver = &portfolio->workers[task->index];
+
+    create_solver(solver, portfolio->problem);
+
+    solver->config = portfolio->config;
+    vary_config(&solver->config, task->index);
+    solver->worker = task->index;
+    solver->stop = &portfolio->stop;
+    if (portfolio->sharing) {
+        join_exchange(solver, &portfolio->exchange, task->index);
+    }
+    if (portfolio->proof != NULL && task->index == 0) {
+        attach_proof(solver, portfolio->proof);
+    }
+
+    solver->solution = solve(solver);
+
+    if (solver->solution != SOLUTION_UNKNOWN) {
+        claim_winner(&portfolio->winner, &portfolio->stop, task->index);
+    }
+
+    return NULL;
+}
+
@@ -0,0 +1,50 @@
+
+#ifndef SIMPLESAT_PORTFOLIO_H
+#define SIMPLESAT_PORTFOLIO_H
+
+#include <stdatomic.h>
+
+#include "exchange.h"
+#include "problem.h"
+#include "proof.h"
+#include "solver.h"
+
+typedef struct
+{
+    // Clauses shared by every worker, and the configuration
+    // that the workers are each given a variation of
+    const Problem *problem;
+    SolverConfig config;
+
+    unsigned int n_workers;
+    Solver *workers;
+
+    // Learned clauses traded between the workers, if enabled
+    bool sharing;
+    Exchange exchange;
+
+    // Index of the first worker to find an answer, after
+    // which the others are told to stop searching
+    atomic_uint winner;
+    atomic_bool stop;
+
+    // Where the first worker writes the steps of its search, if
+    // anywhere, which is only meaningful when it runs on its own
+    Proof *proof;
+}
+Portfolio;
+
+void create_portfolio(Portfolio *,
+                      const Problem *,
+                      const SolverConfig *,
+                      unsigned int);
+void delete_portfolio(Portfolio *);
+
+// Runs every worker until one of them finishes, and returns it
+Solver *run_portfolio(Portfolio *);
+
+// Number of processors available, or one if it cannot be found
+unsigned int count_processors(void);
+
+#endif
+
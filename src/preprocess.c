@@ -0,0 +1,744 @@
+
+#include "preprocess.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "proof.h"
+#include "solver.h"
+#include "utils.h"
+
+// Literals that subsumption and elimination may each
+// look at, which bounds the time spent on large problems
+#define SUBSUME_BUDGET 20000000L
+#define ELIMINATE_BUDGET 20000000L
+
+// Longest resolvent that eliminating a variable may add
+#define RESOLVENT_LIMIT 20
+
+typedef struct
+{
+    unsigned int n_refs;
+    unsigned int c_refs;
+    ClauseRef *refs;
+}
+OccurList;
+
+typedef struct
+{
+    Solver *solver;
+
+    // Clauses containing each literal
+    // Deleted clauses are only dropped from the lists lazily
+    OccurList *occurs;
+
+    // Clauses that may subsume or strengthen others
+    unsigned int n_queue;
+    unsigned int c_queue;
+    ClauseRef *queue;
+
+    // Resolvent of the last two clauses resolved
+    unsigned int n_resolvent;
+    Literal *resolvent;
+
+    // Remaining literal visits for each technique
+    long subsume_budget;
+    long eliminate_budget;
+
+    // Set once the empty clause has been derived
+    bool unsat;
+}
+Preprocessor;
+
+typedef struct
+{
+    unsigned long cost;
+    unsigned int var;
+}
+EliminateCandidate;
+
+static void create_preprocessor(Preprocessor *, Solver *);
+static void delete_preprocessor(Preprocessor *);
+
+static void push_occur(OccurList *, ClauseRef);
+static void remove_occur(OccurList *, ClauseRef);
+static unsigned int clean_occurs(Preprocessor *, Literal);
+
+static void enqueue_clause(Preprocessor *, ClauseRef);
+static void attach_clause(Preprocessor *, ClauseRef);
+static void remove_clause(Preprocessor *, ClauseRef);
+static void strengthen_clause(Preprocessor *, ClauseRef, Literal, bool);
+
+static void assign_unit(Preprocessor *, Literal);
+static void propagate_units(Preprocessor *);
+
+static void subsume(Preprocessor *);
+static void subsume_with(Preprocessor *, ClauseRef);
+
+static bool resolve(Preprocessor *, ClauseRef, ClauseRef, unsigned int);
+static bool try_eliminate(Preprocessor *, unsigned int);
+static void save_clause(Solver *, ClauseRef, Literal);
+static unsigned int eliminate(Preprocessor *);
+
+static void set_literal(Solver *, Literal);
+
+bool preprocess(Solver *solver)
+{
+    Preprocessor pre;
+    unsigned int n_original;
+    unsigned int i;
+    unsigned int j;
+
+    create_preprocessor(&pre, solver);
+    n_original = solver->n_clauses;
+
+    /*
+     * 1. Drop tautologies and index the remaining clauses
+     */
+
+    for (i = 0; i < n_original && ! pre.unsat; ++i) {
+
+        ClauseRef ref = solver->clauses[i];
+        ClauseState *cstate = get_clause(solver, ref);
+        bool tautology = false;
+
+        // Clauses never contain the same literal twice
+        for (j = 0; j < cstate->n_lits; ++j) {
+            solver->lit_marks[cstate->lits[j]] = true;
+        }
+        for (j = 0; j < cstate->n_lits; ++j) {
+            if (solver->lit_marks[negate(cstate->lits[j])]) {
+                tautology = true;
+            }
+        }
+        for (j = 0; j < cstate->n_lits; ++j) {
+            solver->lit_marks[cstate->lits[j]] = false;
+        }
+
+        if (tautology) {
+            remove_clause(&pre, ref);
+        } else {
+            attach_clause(&pre, ref);
+        }
+    }
+
+    /*
+     * 2. Simplify the clauses until eliminating
+     *    variables no longer makes progress
+     */
+
+    propagate_units(&pre);
+
+    while (! pre.unsat) {
+        subsume(&pre);
+        if (pre.unsat || eliminate(&pre) == 0) {
+            break;
+        }
+    }
+
+    delete_preprocessor(&pre);
+
+    if (pre.unsat) {
+        return false;
+    }
+
+    /*
+     * 3. Compact what is left of the clauses
+     */
+
+    for (i = j = 0; i < solver->n_clauses; ++i) {
+        if (! get_clause(solver, solver->clauses[i])->deleted) {
+            solver->clauses[j++] = solver->clauses[i];
+        }
+    }
+    solver->n_clauses = j;
+
+    // Eliminating a variable never adds clauses overall
+    solver->t_removed = n_original - solver->n_clauses;
+
+    collect_garbage(solver);
+
+    return true;
+}
+
+void extend_model(Solver *solver)
+{
+    unsigned int i = solver->n_elim_lits;
+
+    // Clauses are saved with their witness first and their length
+    // last, and are visited in the opposite order to elimination
+    while (i > 0) {
+
+        unsigned int n_lits = solver->elim_lits[--i];
+        const Literal *lits;
+        unsigned int k;
+
+        i -= n_lits;
+        lits = &solver->elim_lits[i];
+
+        for (k = 1; k < n_lits; ++k) {
+            if (solver->values[lits[k]] == VALUE_TRUE) {
+                break;
+            }
+        }
+
+        // Only the witness can still satisfy the clause
+        if (k == n_lits) {
+            set_literal(solver, lits[0]);
+        }
+    }
+}
+
+static void create_preprocessor(Preprocessor *pre, Solver *solver)
+{
+    Literal lit;
+
+    pre->solver = solver;
+
+    CREATE_ARRAY(pre->occurs, solver->n_vars << 1);
+    for (lit = 0; lit < (solver->n_vars << 1); ++lit) {
+        pre->occurs[lit].n_refs = 0;
+        pre->occurs[lit].c_refs = 0;
+        pre->occurs[lit].refs = NULL;
+    }
+
+    pre->n_queue = 0;
+    pre->c_queue = solver->n_clauses + 16;
+    CREATE_ARRAY(pre->queue, pre->c_queue);
+
+    // No resolvent can hold more than one literal per variable
+    pre->n_resolvent = 0;
+    CREATE_ARRAY(pre->resolvent, solver->n_vars);
+
+    pre->subsume_budget = SUBSUME_BUDGET;
+    pre->eliminate_budget = ELIMINATE_BUDGET;
+    pre->unsat = false;
+}
+
+static void delete_preprocessor(Preprocessor *pre)
+{
+    Literal lit;
+
+    for (lit = 0; lit < (pre->solver->n_vars << 1); ++lit) {
+        DELETE_ARRAY(pre->occurs[lit].refs);
+    }
+
+    DELETE_ARRAY(pre->occurs);
+    DELETE_ARRAY(pre->queue);
+    DELETE_ARRAY(pre->resolvent);
+}
+
+static void push_occur(OccurList *list, ClauseRef ref)
+{
+    if (list->n_refs == list->c_refs) {
+        list->c_refs = list->c_refs ? list->c_refs * 2 : 4;
+        RESIZE_ARRAY(list->refs, list->c_refs);
+    }
+
+    list->refs[list->n_refs++] = ref;
+}
+
+static void remove_occur(OccurList *list, ClauseRef ref)
+{
+    unsigned int i;
+
+    // The order of the list does not matter
+    for (i = 0; i < list->n_refs; ++i) {
+        if (list->refs[i] == ref) {
+            list->refs[i] = list->refs[--list->n_refs];
+            return;
+        }
+    }
+}
+
+static unsigned int clean_occurs(Preprocessor *pre, Literal lit)
+{
+    OccurList *list = &pre->occurs[lit];
+    unsigned int i;
+    unsigned int j;
+
+    for (i = j = 0; i < list->n_refs; ++i) {
+        if (! get_clause(pre->solver, list->refs[i])->deleted) {
+            list->refs[j++] = list->refs[i];
+        }
+    }
+    list->n_refs = j;
+
+    return j;
+}
+
+static void enqueue_clause(Preprocessor *pre, ClauseRef ref)
+{
+    if (pre->n_queue == pre->c_queue) {
+        pre->c_queue *= 2;
+        RESIZE_ARRAY(pre->queue, pre->c_queue);
+    }
+
+    pre->queue[pre->n_queue++] = ref;
+}
+
+static void attach_clause(Preprocessor *pre, ClauseRef ref)
+{
+    ClauseState *cstate = get_clause(pre->solver, ref);
+    unsigned int i;
+
+    if (cstate->n_lits == 0) {
+        pre->unsat = true;
+    } else if (cstate->n_lits == 1) {
+        // Units become assignments at level 0 instead
+        assign_unit(pre, cstate->lits[0]);
+        cstate->deleted = 1;
+    } else {
+        for (i = 0; i < cstate->n_lits; ++i) {
+            push_occur(&pre->occurs[cstate->lits[i]], ref);
+        }
+        enqueue_clause(pre, ref);
+    }
+}
+
+static void remove_clause(Preprocessor *pre, ClauseRef ref)
+{
+    Solver *solver = pre->solver;
+    ClauseState *cstate = get_clause(solver, ref);
+
+    if (cstate->deleted) {
+        return;
+    }
+
+    // The occurrence lists are cleaned up when they are next counted
+    cstate->deleted = 1;
+
+    // Units stay in the proof, since their assignments do too
+    if (solver->proof != NULL && cstate->n_lits > 1) {
+        delete_proof_clause(solver->proof, 0, cstate->lits, cstate->n_lits);
+    }
+}
+
+static void strengthen_clause(Preprocessor *pre,
+                              ClauseRef ref,
+                              Literal lit,
+                              bool unlink)
+{
+    Solver *solver = pre->solver;
+    ClauseState *cstate = get_clause(solver, ref);
+    unsigned int i;
+
+    for (i = 0; cstate->lits[i] != lit; ++i) {
+        assert(i + 1 < cstate->n_lits);
+    }
+
+    // The literal is moved past the end rather than overwritten,
+    // so that the proof can still give the clause as it was
+    cstate->n_lits -= 1;
+    cstate->lits[i] = cstate->lits[cstate->n_lits];
+    cstate->lits[cstate->n_lits] = lit;
+
+    if (solver->proof != NULL) {
+        add_proof_clause(solver->proof, cstate->lits, cstate->n_lits,
+                         NULL, 0);
+        delete_proof_clause(solver->proof, 0,
+                            cstate->lits, cstate->n_lits + 1);
+    }
+
+    // The caller may be about to empty the whole list anyway
+    if (unlink) {
+        remove_occur(&pre->occurs[lit], ref);
+    }
+
+    if (cstate->n_lits == 0) {
+        pre->unsat = true;
+    } else if (cstate->n_lits == 1) {
+        assign_unit(pre, cstate->lits[0]);
+        remove_clause(pre, ref);
+    } else {
+        // A shorter clause may now subsume others
+        enqueue_clause(pre, ref);
+    }
+}
+
+static void assign_unit(Preprocessor *pre, Literal lit)
+{
+    Solver *solver = pre->solver;
+
+    // The unit is propagated through the occurrence lists later
+    if (solver->values[lit] == VALUE_UNSET) {
+        assign_literal(solver, lit, CLAUSE_NONE);
+    } else if (solver->values[lit] == VALUE_FALSE) {
+        pre->unsat = true;
+    }
+}
+
+static void propagate_units(Preprocessor *pre)
+{
+    Solver *solver = pre->solver;
+
+    while (! pre->unsat && solver->n_propagated < solver->n_assigned) {
+
+        Literal lit = solver->assigned[solver->n_propagated++];
+        OccurList *list;
+        unsigned int i;
+
+        // Clauses with the literal are satisfied
+        list = &pre->occurs[lit];
+        for (i = 0; i < list->n_refs; ++i) {
+            remove_clause(pre, list->refs[i]);
+        }
+        list->n_refs = 0;
+
+        // Clauses with its negation lose it
+        list = &pre->occurs[negate(lit)];
+        for (i = 0; i < list->n_refs && ! pre->unsat; ++i) {
+            ClauseRef ref = list->refs[i];
+            if (! get_clause(solver, ref)->deleted) {
+                strengthen_clause(pre, ref, negate(lit), false);
+            }
+        }
+        list->n_refs = 0;
+    }
+}
+
+static void subsume(Preprocessor *pre)
+{
+    unsigned int i;
+
+    // Clauses strengthened along the way join the end of the queue
+    for (i = 0; i < pre->n_queue && ! pre->unsat; ++i) {
+
+        if (pre->subsume_budget < 0) {
+            break;
+        }
+
+        subsume_with(pre, pre->queue[i]);
+        propagate_units(pre);
+    }
+
+    pre->n_queue = 0;
+}
+
+static void subsume_with(Preprocessor *pre, ClauseRef ref)
+{
+    Solver *solver = pre->solver;
+    ClauseState *cstate = get_clause(solver, ref);
+    Literal best;
+    unsigned int best_count;
+    unsigned int side;
+    unsigned int i;
+
+    if (cstate->deleted) {
+        return;
+    }
+
+    /*
+     * 1. Pick the literal occurring least often
+     */
+
+    // Every clause subsumed or strengthened by this one
+    // contains this literal or its negation
+    best = cstate->lits[0];
+    best_count = (unsigned int) -1;
+
+    for (i = 0; i < cstate->n_lits; ++i) {
+        Literal lit = cstate->lits[i];
+        unsigned int count = pre->occurs[lit].n_refs +
+                             pre->occurs[negate(lit)].n_refs;
+        if (count < best_count) {
+            best = lit;
+            best_count = count;
+        }
+        solver->lit_marks[lit] = true;
+    }
+
+    /*
+     * 2. Compare against the clauses containing it
+     */
+
+    for (side = 0; side < 2; ++side) {
+
+        OccurList *list = &pre->occurs[side ? negate(best) : best];
+
+        i = 0;
+        while (i < list->n_refs && ! pre->unsat) {
+
+            ClauseRef other = list->refs[i];
+            ClauseState *ostate = get_clause(solver, other);
+            unsigned int n_shared = 0;
+            unsigned int n_negated = 0;
+            Literal negated = 0;
+            unsigned int k;
+
+            if (other == ref ||
+                ostate->deleted ||
+                ostate->n_lits < cstate->n_lits) {
+                i += 1;
+                continue;
+            }
+
+            pre->subsume_budget -= ostate->n_lits;
+
+            for (k = 0; k < ostate->n_lits; ++k) {
+                Literal lit = ostate->lits[k];
+                if (solver->lit_marks[lit]) {
+                    n_shared += 1;
+                } else if (solver->lit_marks[negate(lit)]) {
+                    n_negated += 1;
+                    negated = lit;
+                }
+            }
+
+            if (n_shared == cstate->n_lits) {
+                // Also removes duplicates of this clause
+                remove_clause(pre, other);
+            } else if (n_shared + 1 == cstate->n_lits && n_negated == 1) {
+                // Resolving the two clauses gives a subset of the other
+                strengthen_clause(pre, other, negated, true);
+            }
+
+            // Strengthening on the negated literal removes the clause
+            // from this list, moving the last one into its place
+            if (i < list->n_refs && list->refs[i] == other) {
+                i += 1;
+            }
+        }
+    }
+
+    for (i = 0; i < cstate->n_lits; ++i) {
+        solver->lit_marks[cstate->lits[i]] = false;
+    }
+}
+
+static bool resolve(Preprocessor *pre,
+                    ClauseRef pos,
+                    ClauseRef neg,
+                    unsigned int var)
+{
+    Solver *solver = pre->solver;
+    const ClauseState *pstate = get_clause(solver, pos);
+    const ClauseState *nstate = get_clause(solver, neg);
+    unsigned int n_pos;
+    unsigned int i;
+    bool tautology = false;
+
+    pre->eliminate_budget -= pstate->n_lits + nstate->n_lits;
+
+    pre->n_resolvent = 0;
+    for (i = 0; i < pstate->n_lits; ++i) {
+        Literal lit = pstate->lits[i];
+        if (var_from_lit(lit) != var) {
+            solver->lit_marks[lit] = true;
+            pre->resolvent[pre->n_resolvent++] = lit;
+        }
+    }
+    n_pos = pre->n_resolvent;
+
+    for (i = 0; i < nstate->n_lits; ++i) {
+        Literal lit = nstate->lits[i];
+        if (var_from_lit(lit) == var) {
+            continue;
+        } else if (solver->lit_marks[negate(lit)]) {
+            tautology = true;
+            break;
+        } else if (! solver->lit_marks[lit]) {
+            pre->resolvent[pre->n_resolvent++] = lit;
+        }
+    }
+
+    for (i = 0; i < n_pos; ++i) {
+        solver->lit_marks[pre->resolvent[i]] = false;
+    }
+
+    return ! tautology;
+}
+
+static bool try_eliminate(Preprocessor *pre, unsigned int var)
+{
+    Solver *solver = pre->solver;
+    Literal lit = var << 1;
+    OccurList *pos;
+    OccurList *neg;
+    OccurList *saved;
+    unsigned int n_resolvents;
+    unsigned int i;
+    unsigned int j;
+
+    if (solver->values[lit] != VALUE_UNSET ||
+        solver->vars[var].eliminated) {
+        return false;
+    }
+
+    clean_occurs(pre, lit);
+    clean_occurs(pre, negate(lit));
+    pos = &pre->occurs[lit];
+    neg = &pre->occurs[negate(lit)];
+
+    /*
+     * 1. Make sure the resolvents are no more than the clauses
+     */
+
+    n_resolvents = 0;
+    for (i = 0; i < pos->n_refs; ++i) {
+        for (j = 0; j < neg->n_refs; ++j) {
+            if (pre->eliminate_budget < 0) {
+                return false;
+            }
+            if (resolve(pre, pos->refs[i], neg->refs[j], var)) {
+                n_resolvents += 1;
+                if (n_resolvents > pos->n_refs + neg->n_refs ||
+                    pre->n_resolvent > RESOLVENT_LIMIT) {
+                    return false;
+                }
+            }
+        }
+    }
+
+    /*
+     * 2. Keep the clauses of one polarity for reconstruction
+     */
+
+    // The other polarity is saved as a unit, which is the
+    // value the variable takes unless some clause needs it
+    saved = pos->n_refs <= neg->n_refs ? pos : neg;
+    for (i = 0; i < saved->n_refs; ++i) {
+        save_clause(solver, saved->refs[i], saved == pos ? lit : negate(lit));
+    }
+
+    if (solver->n_elim_lits + 2 > solver->c_elim_lits) {
+        solver->c_elim_lits = 2 * solver->c_elim_lits + 2;
+        REGION_RESIZE(solver->region, solver->elim_lits, solver->c_elim_lits);
+    }
+    solver->elim_lits[solver->n_elim_lits++] =
+        saved == pos ? negate(lit) : lit;
+    solver->elim_lits[solver->n_elim_lits++] = 1;
+
+    /*
+     * 3. Replace the clauses with their resolvents
+     */
+
+    for (i = 0; i < pos->n_refs && ! pre->unsat; ++i) {
+        for (j = 0; j < neg->n_refs && ! pre->unsat; ++j) {
+            if (resolve(pre, pos->refs[i], neg->refs[j], var)) {
+                // Neither list can grow, since the resolvents
+                // do not contain the variable
+                add_clause(solver, pre->resolvent, pre->n_resolvent);
+                if (solver->proof != NULL) {
+                    add_proof_clause(solver->proof, pre->resolvent,
+                                     pre->n_resolvent, NULL, 0);
+                }
+                attach_clause(pre, solver->clauses[solver->n_clauses - 1]);
+            }
+        }
+    }
+
+    for (i = 0; i < pos->n_refs; ++i) {
+        remove_clause(pre, pos->refs[i]);
+    }
+    for (i = 0; i < neg->n_refs; ++i) {
+        remove_clause(pre, neg->refs[i]);
+    }
+    pos->n_refs = 0;
+    neg->n_refs = 0;
+
+    solver->vars[var].eliminated = true;
+    solver->n_eliminated += 1;
+
+    return true;
+}
+
+static void save_clause(Solver *solver, ClauseRef ref, Literal witness)
+{
+    const ClauseState *cstate = get_clause(solver, ref);
+    unsigned int i;
+
+    if (solver->n_elim_lits + cstate->n_lits + 1 > solver->c_elim_lits) {
+        solver->c_elim_lits = 2 * solver->c_elim_lits + cstate->n_lits + 1;
+        REGION_RESIZE(solver->region, solver->elim_lits, solver->c_elim_lits);
+    }
+
+    solver->elim_lits[solver->n_elim_lits++] = witness;
+    for (i = 0; i < cstate->n_lits; ++i) {
+        if (cstate->lits[i] != witness) {
+            solver->elim_lits[solver->n_elim_lits++] = cstate->lits[i];
+        }
+    }
+    solver->elim_lits[solver->n_elim_lits++] = cstate->n_lits;
+}
+
+static int compare_candidates(const void *a, const void *b)
+{
+    const EliminateCandidate *x = a;
+    const EliminateCandidate *y = b;
+
+    // Cheapest variables first, with ties broken by index
+    if (x->cost != y->cost) {
+        return x->cost < y->cost ? -1 : 1;
+    } else if (x->var != y->var) {
+        return x->var < y->var ? -1 : 1;
+    } else {
+        return 0;
+    }
+}
+
+static unsigned int eliminate(Preprocessor *pre)
+{
+    Solver *solver = pre->solver;
+    EliminateCandidate *candidates;
+    unsigned int n_candidates;
+    unsigned int n_eliminated;
+    unsigned int var;
+    unsigned int i;
+
+    if (pre->eliminate_budget < 0) {
+        return 0;
+    }
+
+    /*
+     * 1. Order the variables by how many resolvents they could have
+     */
+
+    CREATE_ARRAY(candidates, solver->n_vars);
+    n_candidates = 0;
+
+    for (var = 0; var < solver->n_vars; ++var) {
+        unsigned int n_pos;
+        unsigned int n_neg;
+        if (solver->values[var << 1] != VALUE_UNSET ||
+            solver->vars[var].eliminated) {
+            continue;
+        }
+        n_pos = clean_occurs(pre, var << 1);
+        n_neg = clean_occurs(pre, (var << 1) | 1);
+        candidates[n_candidates].cost = (unsigned long) n_pos * n_neg;
+        candidates[n_candidates].var = var;
+        n_candidates += 1;
+    }
+
+    qsort(candidates, n_candidates, sizeof(*candidates), compare_candidates);
+
+    /*
+     * 2. Eliminate each variable that does not grow the problem
+     */
+
+    n_eliminated = 0;
+    for (i = 0; i < n_candidates && ! pre->unsat; ++i) {
+        if (pre->eliminate_budget < 0) {
+            break;
+        }
+        if (try_eliminate(pre, candidates[i].var)) {
+            n_eliminated += 1;
+            propagate_units(pre);
+        }
+    }
+
+    DELETE_ARRAY(candidates);
+
+    return n_eliminated;
+}
+
+static void set_literal(Solver *solver, Literal lit)
+{
+    // Eliminated variables never join the trail,
+    // so their value can simply be overwritten
+    solver->values[lit] = VALUE_TRUE;
+    solver->values[negate(lit)] = VALUE_FALSE;
+}
+
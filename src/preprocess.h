@@ -0,0 +1,19 @@
+
+#ifndef SIMPLESAT_PREPROCESS_H
+#define SIMPLESAT_PREPROCESS_H
+
+#include <stdbool.h>
+
+#include "solver.h"
+
+// Simplifies the clauses of a problem before the search begins,
+// returns false if the problem is found to be unsatisfiable
+bool preprocess(Solver *);
+
+// Gives the eliminated variables values that, together
+// with a solution of the simplified problem, satisfy
+// every clause of the original problem
+void extend_model(Solver *);
+
+#endif
+
@@ -0,0 +1,92 @@
+
+#include "problem.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "utils.h"
+
+void create_problem(Problem *problem,
+                    unsigned int num_vars,
+                    unsigned int num_clauses)
+{
+    uint64_t guess;
+    unsigned int i;
+
+    // There must be at least one variable
+    // However there CAN be zero clauses
+    assert(num_vars > 0);
+
+    problem->n_vars = num_vars;
+
+    problem->n_clauses = 0;
+    problem->c_clauses = num_clauses + 1;
+    CREATE_ARRAY(problem->clause_starts, problem->c_clauses);
+    problem->clause_starts[0] = 0;
+
+    // Guess at the space needed for short clauses,
+    // the array will grow if the guess is too small
+    guess = 4 * (uint64_t) num_clauses + 16;
+    problem->n_lits = 0;
+    problem->c_lits = guess < OFFSET_MAX ? (Offset) guess : OFFSET_MAX;
+    CREATE_ARRAY(problem->lits, problem->c_lits);
+
+    CREATE_ARRAY(problem->lit_marks, num_vars << 1);
+    for (i = 0; i < (num_vars << 1); ++i) {
+        problem->lit_marks[i] = false;
+    }
+}
+
+void delete_problem(Problem *problem)
+{
+    DELETE_ARRAY(problem->clause_starts);
+    DELETE_ARRAY(problem->lits);
+    DELETE_ARRAY(problem->lit_marks);
+}
+
+void push_problem_literal(Problem *problem, Literal lit)
+{
+    // Doubling stops at the most literals that offsets can
+    // reach, which the reader makes sure are never exceeded
+    assert(problem->n_lits < OFFSET_MAX);
+    if (problem->n_lits == problem->c_lits) {
+        problem->c_lits = problem->c_lits <= OFFSET_MAX / 2 ?
+                          2 * problem->c_lits : OFFSET_MAX;
+        RESIZE_ARRAY(problem->lits, problem->c_lits);
+    }
+
+    problem->lits[problem->n_lits++] = lit;
+}
+
+void finish_problem_clause(Problem *problem)
+{
+    Offset start = problem->clause_starts[problem->n_clauses];
+    Literal *lits = &problem->lits[start];
+    unsigned int num_lits = (unsigned int) (problem->n_lits - start);
+    unsigned int i;
+    unsigned int j;
+
+    // Make sure the clause has at most one copy of each literal.
+    // The solver copies the clauses of a problem as they are,
+    // without looking for repeats, and counts on them being gone.
+    for (i = j = 0; i < num_lits; ++i) {
+        if (! problem->lit_marks[lits[i]]) {
+            problem->lit_marks[lits[i]] = true;
+            lits[j++] = lits[i];
+        }
+    }
+
+    for (i = 0; i < j; ++i) {
+        problem->lit_marks[lits[i]] = false;
+    }
+
+    problem->n_lits = start + j;
+
+    if (problem->n_clauses + 1 == problem->c_clauses) {
+        problem->c_clauses *= 2;
+        RESIZE_ARRAY(problem->clause_starts, problem->c_clauses);
+    }
+    problem->clause_starts[++problem->n_clauses] = problem->n_lits;
+}
+
@@ -0,0 +1,50 @@
+
+#ifndef SIMPLESAT_PROBLEM_H
+#define SIMPLESAT_PROBLEM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef unsigned int Literal;
+
+// Position in an array of literals, which only needs to be wider
+// than a literal for problems with more than 2^32 occurrences of
+// them, and so is only made 64-bit in builds with -Dwide_index
+#ifdef SIMPLESAT_WIDE_INDEX
+typedef uint64_t Offset;
+#else
+typedef unsigned int Offset;
+#endif
+
+#define OFFSET_MAX ((Offset) -1)
+
+typedef struct
+{
+    unsigned int n_vars;
+
+    // Clause `i` holds the literals from `clause_starts[i]`
+    // up to the start of the next clause
+    unsigned int n_clauses;
+    unsigned int c_clauses;
+    Offset *clause_starts;
+
+    Offset n_lits;
+    Offset c_lits;
+    Literal *lits;
+
+    // Per-literal marks used to drop repeated literals
+    bool *lit_marks;
+}
+Problem;
+
+// The clauses as parsed, which are never changed once read
+// and so can be shared by any number of solvers
+void create_problem(Problem *, unsigned int, unsigned int);
+void delete_problem(Problem *);
+
+// Clauses are built one literal at a time
+void push_problem_literal(Problem *, Literal);
+void finish_problem_clause(Problem *);
+
+#endif
+
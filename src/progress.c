@@ -0,0 +1,72 @@
+
+#include "progress.h"
+
+#include <inttypes.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "solver.h"
+#include "utils.h"
+
+// Counted rather than set, so that every solver can tell
+// whether it has answered the latest request
+static atomic_uint n_requests;
+
+static void request_report(int);
+
+void install_report_signal(void)
+{
+    struct sigaction action;
+
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = request_report;
+    sigemptyset(&action.sa_mask);
+
+    // Reading the input should carry on as if nothing happened
+    action.sa_flags = SA_RESTART;
+
+    sigaction(SIGUSR1, &action, NULL);
+}
+
+unsigned int report_requests(void)
+{
+    return atomic_load_explicit(&n_requests, memory_order_relaxed);
+}
+
+void write_report(Solver *solver, double now)
+{
+    double interval = now - solver->last_report_time;
+    uint64_t props = solver->t_unit_props - solver->last_report_props;
+    double rate = interval > 0.0 ? props / interval : 0.0;
+
+    // A single call, so that lines from different threads stay whole
+    fprintf(stderr,
+            "c [%u] %.1f s: %" PRIu64 " decisions, %" PRIu64 " conflicts, "
+            "%" PRIu64 " restarts, %u/%u on trail, %u learned, "
+            "%.0f props/s, %.1f MB\n",
+            solver->worker,
+            now - solver->report_start,
+            solver->t_branches,
+            solver->t_conflicts,
+            solver->t_restarts,
+            solver->n_assigned,
+            solver->n_vars,
+            solver->n_learnts,
+            rate,
+            peak_memory() / (1024.0 * 1024.0));
+
+    solver->last_report_time = now;
+    solver->last_report_props = solver->t_unit_props;
+}
+
+static void request_report(int signum)
+{
+    (void) signum;
+
+    // Lock-free atomics are safe to use in a signal handler
+    atomic_fetch_add_explicit(&n_requests, 1, memory_order_relaxed);
+}
+
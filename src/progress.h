@@ -0,0 +1,18 @@
+
+#ifndef SIMPLESAT_PROGRESS_H
+#define SIMPLESAT_PROGRESS_H
+
+#include "solver.h"
+
+// Makes SIGUSR1 ask every solver that is searching for a report
+void install_report_signal(void);
+
+// Number of times a report has been asked for so far
+unsigned int report_requests(void);
+
+// Writes a line about how far the search has got to stderr,
+// given the current time
+void write_report(Solver *, double);
+
+#endif
+
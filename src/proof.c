@@ -0,0 +1,326 @@
+
+#include "proof.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "constants.h"
+#include "error.h"
+#include "problem.h"
+#include "utils.h"
+
+// Bytes gathered before they are written out
+#define PROOF_BUFFER_SIZE (1 << 20)
+
+// Most bytes a single number takes, in either encoding,
+// along with the sign and separator around it
+#define MAX_NUMBER_BYTES 24
+
+static void *run_writer(void *);
+static void write_bytes(Proof *, const unsigned char *, size_t);
+static void flush_buffer(Proof *);
+
+static void put_byte(Proof *, unsigned char);
+static void put_number(Proof *, uint64_t, bool);
+static void put_literal(Proof *, Literal);
+static void put_id(Proof *, uint64_t);
+static void end_list(Proof *, bool);
+
+Error open_proof(Proof *proof,
+                 const char *filename,
+                 ProofFormat format,
+                 bool binary,
+                 bool async)
+{
+    int status;
+
+    proof->fd = open(filename, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    if (proof->fd < 0) {
+        fprintf(stderr, PROGRAM_NAME ": %s: %s\n",
+                filename, strerror(errno));
+        return ERROR_FILE_ACCESS;
+    }
+
+    proof->name = filename;
+    proof->format = format;
+    proof->binary = binary;
+
+    CREATE_ARRAY(proof->buffer, PROOF_BUFFER_SIZE);
+    proof->n_buffer = 0;
+
+    proof->async = async;
+    proof->spare = NULL;
+    proof->n_pending = 0;
+    proof->closing = false;
+
+    // Clause identifiers start from one
+    proof->next_id = 1;
+    proof->error = 0;
+
+    if (async) {
+        CREATE_ARRAY(proof->spare, PROOF_BUFFER_SIZE);
+        pthread_mutex_init(&proof->lock, NULL);
+        pthread_cond_init(&proof->changed, NULL);
+        status = pthread_create(&proof->writer, NULL, run_writer, proof);
+        if (status != 0) {
+            // Writing on the searching thread is only slower
+            fprintf(stderr, PROGRAM_NAME ": Cannot start thread: %s\n",
+                    strerror(status));
+            pthread_mutex_destroy(&proof->lock);
+            pthread_cond_destroy(&proof->changed);
+            DELETE_ARRAY(proof->spare);
+            proof->spare = NULL;
+            proof->async = false;
+        }
+    }
+
+    return ERROR_OK;
+}
+
+Error close_proof(Proof *proof)
+{
+    flush_buffer(proof);
+
+    if (proof->async) {
+        pthread_mutex_lock(&proof->lock);
+        proof->closing = true;
+        pthread_cond_broadcast(&proof->changed);
+        pthread_mutex_unlock(&proof->lock);
+
+        pthread_join(proof->writer, NULL);
+        pthread_mutex_destroy(&proof->lock);
+        pthread_cond_destroy(&proof->changed);
+    }
+
+    if (close(proof->fd) != 0 && proof->error == 0) {
+        proof->error = errno;
+    }
+
+    DELETE_ARRAY(proof->buffer);
+    DELETE_ARRAY(proof->spare);
+
+    if (proof->error != 0) {
+        fprintf(stderr, PROGRAM_NAME ": %s: %s\n",
+                proof->name, strerror(proof->error));
+        return ERROR_FILE_ACCESS;
+    }
+
+    return ERROR_OK;
+}
+
+uint64_t add_proof_clause(Proof *proof,
+                          const Literal *lits,
+                          unsigned int num_lits,
+                          const uint64_t *hints,
+                          unsigned int num_hints)
+{
+    uint64_t id = proof->next_id++;
+    unsigned int i;
+
+    if (proof->binary) {
+        put_byte(proof, 'a');
+    }
+
+    if (proof->format == PROOF_LRAT) {
+        put_id(proof, id);
+    }
+
+    for (i = 0; i < num_lits; ++i) {
+        put_literal(proof, lits[i]);
+    }
+
+    if (proof->format == PROOF_LRAT) {
+        end_list(proof, false);
+        for (i = 0; i < num_hints; ++i) {
+            put_id(proof, hints[i]);
+        }
+    }
+    end_list(proof, true);
+
+    return id;
+}
+
+void delete_proof_clause(Proof *proof,
+                         uint64_t id,
+                         const Literal *lits,
+                         unsigned int num_lits)
+{
+    unsigned int i;
+
+    // Text LRAT starts each line with an identifier, for which
+    // the last one handed out is as good as any
+    if (proof->binary) {
+        put_byte(proof, 'd');
+    } else {
+        if (proof->format == PROOF_LRAT) {
+            put_id(proof, proof->next_id - 1);
+        }
+        put_byte(proof, 'd');
+        put_byte(proof, ' ');
+    }
+
+    if (proof->format == PROOF_LRAT) {
+        put_id(proof, id);
+    } else {
+        for (i = 0; i < num_lits; ++i) {
+            put_literal(proof, lits[i]);
+        }
+    }
+    end_list(proof, true);
+}
+
+static void *run_writer(void *arg)
+{
+    Proof *proof = arg;
+
+    pthread_mutex_lock(&proof->lock);
+
+    for (;;) {
+
+        while (proof->n_pending == 0 && ! proof->closing) {
+            pthread_cond_wait(&proof->changed, &proof->lock);
+        }
+
+        // Anything handed over is written before closing
+        if (proof->n_pending == 0) {
+            break;
+        }
+
+        pthread_mutex_unlock(&proof->lock);
+        write_bytes(proof, proof->spare, proof->n_pending);
+        pthread_mutex_lock(&proof->lock);
+
+        proof->n_pending = 0;
+        pthread_cond_broadcast(&proof->changed);
+    }
+
+    pthread_mutex_unlock(&proof->lock);
+
+    return NULL;
+}
+
+static void write_bytes(Proof *proof, const unsigned char *bytes, size_t n)
+{
+    // Once a write has failed the proof is useless anyway
+    while (n > 0 && proof->error == 0) {
+        ssize_t written = write(proof->fd, bytes, n);
+        if (written >= 0) {
+            bytes += written;
+            n -= (size_t) written;
+        } else if (errno != EINTR) {
+            proof->error = errno;
+        }
+    }
+}
+
+static void flush_buffer(Proof *proof)
+{
+    unsigned char *full = proof->buffer;
+
+    if (proof->n_buffer == 0) {
+        return;
+    }
+
+    if (! proof->async) {
+        write_bytes(proof, proof->buffer, proof->n_buffer);
+        proof->n_buffer = 0;
+        return;
+    }
+
+    // Wait for the writer to finish with the spare buffer,
+    // then hand it the full one and carry on in the other
+    pthread_mutex_lock(&proof->lock);
+    while (proof->n_pending != 0) {
+        pthread_cond_wait(&proof->changed, &proof->lock);
+    }
+    proof->buffer = proof->spare;
+    proof->spare = full;
+    proof->n_pending = proof->n_buffer;
+    pthread_cond_broadcast(&proof->changed);
+    pthread_mutex_unlock(&proof->lock);
+
+    proof->n_buffer = 0;
+}
+
+static void put_byte(Proof *proof, unsigned char byte)
+{
+    if (proof->n_buffer == PROOF_BUFFER_SIZE) {
+        flush_buffer(proof);
+    }
+
+    proof->buffer[proof->n_buffer++] = byte;
+}
+
+static void put_number(Proof *proof, uint64_t value, bool negative)
+{
+    unsigned char digits[MAX_NUMBER_BYTES];
+    unsigned char *out;
+    unsigned int n_digits;
+
+    if (proof->n_buffer + MAX_NUMBER_BYTES > PROOF_BUFFER_SIZE) {
+        flush_buffer(proof);
+    }
+    out = &proof->buffer[proof->n_buffer];
+
+    if (proof->binary) {
+        // Seven bits at a time, lowest first, with the top bit
+        // set on every byte but the last
+        while (value >= 0x80) {
+            *out++ = (unsigned char) (value | 0x80);
+            value >>= 7;
+        }
+        *out++ = (unsigned char) value;
+    } else {
+        n_digits = 0;
+        do {
+            digits[n_digits++] = (unsigned char) ('0' + value % 10);
+            value /= 10;
+        } while (value > 0);
+
+        if (negative) {
+            *out++ = '-';
+        }
+        while (n_digits > 0) {
+            *out++ = digits[--n_digits];
+        }
+        *out++ = ' ';
+    }
+
+    proof->n_buffer = out - proof->buffer;
+}
+
+static void put_literal(Proof *proof, Literal lit)
+{
+    // Binary proofs number the literals of variable v from 2v,
+    // which with variables counted from one is two past ours
+    if (proof->binary) {
+        put_number(proof, (uint64_t) lit + 2, false);
+    } else {
+        put_number(proof, (lit >> 1) + 1, lit & 1);
+    }
+}
+
+static void put_id(Proof *proof, uint64_t id)
+{
+    // Binary LRAT leaves room for a sign in the lowest bit
+    put_number(proof, proof->binary ? id << 1 : id, false);
+}
+
+static void end_list(Proof *proof, bool last)
+{
+    // Each step ends a line of text, after the
+    // hints when there are any to follow
+    if (proof->binary) {
+        put_byte(proof, 0);
+    } else {
+        put_byte(proof, '0');
+        put_byte(proof, last ? '\n' : ' ');
+    }
+}
+
@@ -0,0 +1,73 @@
+
+#ifndef SIMPLESAT_PROOF_H
+#define SIMPLESAT_PROOF_H
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "error.h"
+#include "problem.h"
+
+typedef enum
+{
+    // Clauses that follow by unit propagation, checked by search
+    PROOF_DRAT,
+
+    // The same clauses, each with the clauses it follows from
+    PROOF_LRAT
+}
+ProofFormat;
+
+typedef struct
+{
+    int fd;
+    const char *name;
+    ProofFormat format;
+    bool binary;
+
+    // Steps are gathered here and written a whole buffer at a time
+    unsigned char *buffer;
+    size_t n_buffer;
+
+    // With a writer thread, a full buffer is swapped for the spare
+    // one, which the thread writes out while the search carries on;
+    // `n_pending` is how much of the spare is still to be written
+    bool async;
+    unsigned char *spare;
+    size_t n_pending;
+    bool closing;
+    pthread_t writer;
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+
+    // Identifier of the next clause added, which with LRAT follows
+    // on from those of the clauses of the problem
+    uint64_t next_id;
+
+    // Error number of the first write that failed, if any
+    int error;
+}
+Proof;
+
+Error open_proof(Proof *, const char *, ProofFormat, bool, bool);
+
+// Writes out whatever is left, returning an error
+// if any part of the proof could not be written
+Error close_proof(Proof *);
+
+// Records a clause derived from the given clauses, which only LRAT
+// needs, and returns the identifier it is known by from then on
+uint64_t add_proof_clause(Proof *,
+                          const Literal *,
+                          unsigned int,
+                          const uint64_t *,
+                          unsigned int);
+
+// Records that a clause is no longer needed, which LRAT
+// refers to by identifier and DRAT by its literals
+void delete_proof_clause(Proof *, uint64_t, const Literal *, unsigned int);
+
+#endif
+
@@ -0,0 +1,580 @@
+
+#include "reader.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#ifdef HAVE_LZMA
+#include <lzma.h>
+#endif
+
+#ifdef HAVE_BZIP2
+#include <bzlib.h>
+#endif
+
+#include "constants.h"
+#include "error.h"
+#include "utils.h"
+
+// Size of the buffers used when the input cannot be mapped
+#define READER_BUFFER_SIZE (4 << 20)
+
+// Enough input to recognize any of the supported formats
+#define MAGIC_SIZE 6
+
+static void init_reader(Reader *);
+static Error start_input(Reader *);
+static Compression detect_compression(const unsigned char *, size_t);
+static Error start_decoder(Reader *);
+static void stop_decoder(Reader *);
+
+static bool fill_plain(Reader *);
+static bool fill_raw(Reader *);
+static bool fill_decoded(Reader *);
+
+#ifdef HAVE_ZLIB
+static size_t decode_gzip(Reader *, bool *);
+#endif
+
+#ifdef HAVE_LZMA
+static size_t decode_xz(Reader *, bool *);
+#endif
+
+#ifdef HAVE_BZIP2
+static size_t decode_bzip2(Reader *, bool *);
+#endif
+
+Error open_reader(Reader *reader, const char *filename)
+{
+    struct stat info;
+
+    init_reader(reader);
+
+    if (filename != NULL) {
+        reader->name = filename;
+        reader->fd = open(filename, O_RDONLY);
+        if (reader->fd < 0) {
+            fprintf(stderr, PROGRAM_NAME ": %s: %s\n",
+                    filename, strerror(errno));
+            return ERROR_FILE_ACCESS;
+        }
+    } else {
+        reader->name = "stdin";
+        reader->fd = STDIN_FILENO;
+    }
+
+    // Map regular files so the parser reads straight out
+    // of the page cache, with no copying or system calls
+    if (fstat(reader->fd, &info) == 0 &&
+        S_ISREG(info.st_mode) &&
+        info.st_size > 0) {
+
+        void *mapping = mmap(NULL, (size_t) info.st_size,
+                             PROT_READ, MAP_PRIVATE, reader->fd, 0);
+
+        if (mapping != MAP_FAILED) {
+            madvise(mapping, (size_t) info.st_size, MADV_SEQUENTIAL);
+            reader->mapping = mapping;
+            reader->mapping_size = (size_t) info.st_size;
+            reader->pos = mapping;
+            reader->end = reader->pos + reader->mapping_size;
+            reader->at_eof = true;
+        }
+    }
+
+    // Fall back to reading pipes and terminals in large blocks,
+    // making sure the first block is long enough to identify
+    if (reader->mapping == NULL) {
+        reader->c_buffer = READER_BUFFER_SIZE;
+        CREATE_ARRAY(reader->buffer, reader->c_buffer);
+        reader->pos = reader->buffer;
+        reader->end = reader->buffer;
+        while (reader->end - reader->pos < MAGIC_SIZE &&
+               fill_plain(reader)) {
+            continue;
+        }
+    }
+
+    return start_input(reader);
+}
+
+Error open_memory_reader(Reader *reader,
+                         const unsigned char *data,
+                         size_t size,
+                         const char *name)
+{
+    init_reader(reader);
+
+    // The whole input is there already, as if it had been mapped
+    reader->name = name;
+    reader->fd = -1;
+    reader->pos = data;
+    reader->end = data + size;
+    reader->at_eof = true;
+
+    return start_input(reader);
+}
+
+static void init_reader(Reader *reader)
+{
+    reader->pos = NULL;
+    reader->end = NULL;
+    reader->mapping = NULL;
+    reader->mapping_size = 0;
+    reader->buffer = NULL;
+    reader->c_buffer = 0;
+    reader->at_eof = false;
+    reader->error = ERROR_OK;
+
+    reader->compression = COMPRESSION_NONE;
+    reader->raw_pos = NULL;
+    reader->raw_end = NULL;
+    reader->raw_buffer = NULL;
+    reader->c_raw_buffer = 0;
+    reader->raw_eof = false;
+    reader->decoder = NULL;
+}
+
+static Error start_input(Reader *reader)
+{
+    Error err;
+
+    /*
+     * Compressed input is decoded on the fly, with the
+     * data read so far becoming the decoder's input
+     */
+
+    reader->compression = detect_compression(reader->pos,
+                                             reader->end - reader->pos);
+    if (reader->compression == COMPRESSION_NONE) {
+        return ERROR_OK;
+    }
+
+    reader->raw_pos = reader->pos;
+    reader->raw_end = reader->end;
+    reader->raw_eof = reader->at_eof;
+    if (reader->buffer != NULL) {
+        reader->raw_buffer = reader->buffer;
+        reader->c_raw_buffer = reader->c_buffer;
+    }
+
+    reader->c_buffer = READER_BUFFER_SIZE;
+    CREATE_ARRAY(reader->buffer, reader->c_buffer);
+    reader->pos = reader->buffer;
+    reader->end = reader->buffer;
+    reader->at_eof = false;
+
+    err = start_decoder(reader);
+    if (err) {
+        close_reader(reader);
+    }
+
+    return err;
+}
+
+void close_reader(Reader *reader)
+{
+    stop_decoder(reader);
+
+    if (reader->mapping != NULL) {
+        munmap(reader->mapping, reader->mapping_size);
+    }
+
+    DELETE_ARRAY(reader->buffer);
+    DELETE_ARRAY(reader->raw_buffer);
+
+    if (reader->fd >= 0 && reader->fd != STDIN_FILENO) {
+        close(reader->fd);
+    }
+}
+
+bool fill_reader(Reader *reader)
+{
+    if (reader->compression == COMPRESSION_NONE) {
+        return fill_plain(reader);
+    } else {
+        return fill_decoded(reader);
+    }
+}
+
+static Compression detect_compression(const unsigned char *data,
+                                      size_t size)
+{
+    static const unsigned char xz_magic[6] = {
+        0xfd, '7', 'z', 'X', 'Z', 0x00
+    };
+
+    if (size >= 2 && data[0] == 0x1f && data[1] == 0x8b) {
+        return COMPRESSION_GZIP;
+    } else if (size >= 6 && memcmp(data, xz_magic, 6) == 0) {
+        return COMPRESSION_XZ;
+    } else if (size >= 3 && memcmp(data, "BZh", 3) == 0) {
+        return COMPRESSION_BZIP2;
+    } else {
+        return COMPRESSION_NONE;
+    }
+}
+
+static Error start_decoder(Reader *reader)
+{
+    const char *format = "";
+
+    switch (reader->compression) {
+
+    case COMPRESSION_GZIP:
+#ifdef HAVE_ZLIB
+    {
+        z_stream *stream = xmalloc(sizeof(*stream));
+        memset(stream, 0, sizeof(*stream));
+        // Accept only the gzip wrapper, not raw zlib data
+        if (inflateInit2(stream, 16 + MAX_WBITS) != Z_OK) {
+            free(stream);
+            break;
+        }
+        reader->decoder = stream;
+        return ERROR_OK;
+    }
+#else
+        format = "gzip";
+        break;
+#endif
+
+    case COMPRESSION_XZ:
+#ifdef HAVE_LZMA
+    {
+        lzma_stream *stream = xmalloc(sizeof(*stream));
+        lzma_stream init = LZMA_STREAM_INIT;
+        *stream = init;
+        if (lzma_stream_decoder(stream, UINT64_MAX,
+                                LZMA_CONCATENATED) != LZMA_OK) {
+            free(stream);
+            break;
+        }
+        reader->decoder = stream;
+        return ERROR_OK;
+    }
+#else
+        format = "xz";
+        break;
+#endif
+
+    case COMPRESSION_BZIP2:
+#ifdef HAVE_BZIP2
+    {
+        bz_stream *stream = xmalloc(sizeof(*stream));
+        memset(stream, 0, sizeof(*stream));
+        if (BZ2_bzDecompressInit(stream, 0, 0) != BZ_OK) {
+            free(stream);
+            break;
+        }
+        reader->decoder = stream;
+        return ERROR_OK;
+    }
+#else
+        format = "bzip2";
+        break;
+#endif
+
+    case COMPRESSION_NONE:
+        return ERROR_OK;
+
+    }
+
+    // Either support was left out of the build, or the
+    // decoder could not allocate its initial state
+    reader->compression = COMPRESSION_NONE;
+
+    if (format[0] != '\0') {
+        fprintf(stderr,
+                PROGRAM_NAME ": %s: Input is compressed with %s,"
+                " which this build cannot read\n",
+                reader->name, format);
+    } else {
+        fprintf(stderr,
+                PROGRAM_NAME ": %s: Cannot start decompression\n",
+                reader->name);
+    }
+
+    return ERROR_FILE_ACCESS;
+}
+
+static void stop_decoder(Reader *reader)
+{
+    if (reader->decoder == NULL) {
+        return;
+    }
+
+    switch (reader->compression) {
+
+    case COMPRESSION_GZIP:
+#ifdef HAVE_ZLIB
+        inflateEnd(reader->decoder);
+#endif
+        break;
+
+    case COMPRESSION_XZ:
+#ifdef HAVE_LZMA
+        lzma_end(reader->decoder);
+#endif
+        break;
+
+    case COMPRESSION_BZIP2:
+#ifdef HAVE_BZIP2
+        BZ2_bzDecompressEnd(reader->decoder);
+#endif
+        break;
+
+    case COMPRESSION_NONE:
+        break;
+
+    }
+
+    free(reader->decoder);
+    reader->decoder = NULL;
+}
+
+/*
+ * Plain input comes straight from the file into the buffer
+ */
+
+static bool fill_plain(Reader *reader)
+{
+    ssize_t n_read;
+    size_t kept;
+
+    while (! reader->at_eof) {
+
+        // Keep any input that has not been consumed yet
+        kept = reader->end - reader->pos;
+        memmove(reader->buffer, reader->pos, kept);
+        reader->pos = reader->buffer;
+        reader->end = reader->buffer + kept;
+
+        n_read = read(reader->fd, reader->buffer + kept,
+                      reader->c_buffer - kept);
+
+        if (n_read > 0) {
+            reader->end += n_read;
+            return true;
+        } else if (n_read == 0) {
+            reader->at_eof = true;
+        } else if (errno != EINTR) {
+            // Report the error, then treat it as the end of input
+            fprintf(stderr, PROGRAM_NAME ": %s: %s\n",
+                    reader->name, strerror(errno));
+            reader->error = ERROR_FILE_ACCESS;
+            reader->at_eof = true;
+        }
+    }
+
+    return false;
+}
+
+/*
+ * Compressed input is read into the raw buffer, unless the whole
+ * file is already mapped, and decoded into the main buffer
+ */
+
+static bool fill_raw(Reader *reader)
+{
+    ssize_t n_read;
+
+    while (! reader->raw_eof) {
+
+        n_read = read(reader->fd, reader->raw_buffer, reader->c_raw_buffer);
+
+        if (n_read > 0) {
+            reader->raw_pos = reader->raw_buffer;
+            reader->raw_end = reader->raw_buffer + n_read;
+            return true;
+        } else if (n_read == 0) {
+            reader->raw_eof = true;
+        } else if (errno != EINTR) {
+            fprintf(stderr, PROGRAM_NAME ": %s: %s\n",
+                    reader->name, strerror(errno));
+            reader->error = ERROR_FILE_ACCESS;
+            reader->raw_eof = true;
+        }
+    }
+
+    return false;
+}
+
+static bool fill_decoded(Reader *reader)
+{
+    size_t produced = 0;
+    bool done = false;
+
+    while (! reader->at_eof) {
+
+        if (reader->raw_pos == reader->raw_end) {
+            fill_raw(reader);
+        }
+
+        switch (reader->compression) {
+
+        case COMPRESSION_GZIP:
+#ifdef HAVE_ZLIB
+            produced = decode_gzip(reader, &done);
+#endif
+            break;
+
+        case COMPRESSION_XZ:
+#ifdef HAVE_LZMA
+            produced = decode_xz(reader, &done);
+#endif
+            break;
+
+        case COMPRESSION_BZIP2:
+#ifdef HAVE_BZIP2
+            produced = decode_bzip2(reader, &done);
+#endif
+            break;
+
+        case COMPRESSION_NONE:
+            done = true;
+            break;
+
+        }
+
+        if (done) {
+            reader->at_eof = true;
+        }
+
+        if (produced > 0) {
+            reader->pos = reader->buffer;
+            reader->end = reader->buffer + produced;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+#if defined(HAVE_ZLIB) || defined(HAVE_LZMA) || defined(HAVE_BZIP2)
+
+static bool raw_exhausted(const Reader *reader)
+{
+    return reader->raw_pos == reader->raw_end && reader->raw_eof;
+}
+
+static void report_corrupt(Reader *reader)
+{
+    // The parser will then see the input end early, and say nothing
+    // more about it
+    fprintf(stderr, PROGRAM_NAME ": %s: Corrupt compressed input\n",
+            reader->name);
+    reader->error = ERROR_FILE_ACCESS;
+}
+
+#ifdef HAVE_ZLIB
+static size_t decode_gzip(Reader *reader, bool *done)
+{
+    z_stream *stream = reader->decoder;
+    int ret;
+
+    stream->next_in = (unsigned char *) reader->raw_pos;
+    stream->avail_in = reader->raw_end - reader->raw_pos;
+    stream->next_out = reader->buffer;
+    stream->avail_out = reader->c_buffer;
+
+    ret = inflate(stream, Z_NO_FLUSH);
+    reader->raw_pos = stream->next_in;
+
+    if (ret == Z_STREAM_END) {
+        // Concatenated gzip members decode as one stream
+        if (reader->raw_pos != reader->raw_end || fill_raw(reader)) {
+            inflateReset(stream);
+        } else {
+            *done = true;
+        }
+    } else if (ret == Z_BUF_ERROR && raw_exhausted(reader)) {
+        report_corrupt(reader);
+        *done = true;
+    } else if (ret != Z_OK && ret != Z_BUF_ERROR) {
+        report_corrupt(reader);
+        *done = true;
+    }
+
+    return reader->c_buffer - stream->avail_out;
+}
+#endif
+
+#ifdef HAVE_LZMA
+static size_t decode_xz(Reader *reader, bool *done)
+{
+    lzma_stream *stream = reader->decoder;
+    lzma_ret ret;
+
+    stream->next_in = reader->raw_pos;
+    stream->avail_in = reader->raw_end - reader->raw_pos;
+    stream->next_out = reader->buffer;
+    stream->avail_out = reader->c_buffer;
+
+    // Concatenated streams need to be told where the input ends
+    ret = lzma_code(stream, raw_exhausted(reader) ? LZMA_FINISH : LZMA_RUN);
+    reader->raw_pos = stream->next_in;
+
+    if (ret == LZMA_STREAM_END) {
+        *done = true;
+    } else if (ret != LZMA_OK) {
+        report_corrupt(reader);
+        *done = true;
+    }
+
+    return reader->c_buffer - stream->avail_out;
+}
+#endif
+
+#ifdef HAVE_BZIP2
+static size_t decode_bzip2(Reader *reader, bool *done)
+{
+    bz_stream *stream = reader->decoder;
+    size_t produced;
+    int ret;
+
+    stream->next_in = (char *) reader->raw_pos;
+    stream->avail_in = reader->raw_end - reader->raw_pos;
+    stream->next_out = (char *) reader->buffer;
+    stream->avail_out = reader->c_buffer;
+
+    ret = BZ2_bzDecompress(stream);
+    reader->raw_pos = (const unsigned char *) stream->next_in;
+    produced = reader->c_buffer - stream->avail_out;
+
+    if (ret == BZ_STREAM_END) {
+        // Concatenated bzip2 streams decode as one stream
+        if (reader->raw_pos != reader->raw_end || fill_raw(reader)) {
+            BZ2_bzDecompressEnd(stream);
+            if (BZ2_bzDecompressInit(stream, 0, 0) != BZ_OK) {
+                report_corrupt(reader);
+                *done = true;
+            }
+        } else {
+            *done = true;
+        }
+    } else if (ret != BZ_OK) {
+        report_corrupt(reader);
+        *done = true;
+    } else if (produced == 0 && raw_exhausted(reader)) {
+        report_corrupt(reader);
+        *done = true;
+    }
+
+    return produced;
+}
+#endif
+
+#endif
+
@@ -0,0 +1,87 @@
+
+#ifndef SIMPLESAT_READER_H
+#define SIMPLESAT_READER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+#include "error.h"
+
+typedef enum
+{
+    COMPRESSION_NONE,
+    COMPRESSION_GZIP,
+    COMPRESSION_XZ,
+    COMPRESSION_BZIP2
+}
+Compression;
+
+typedef struct
+{
+    // Window of input that has not been consumed yet
+    const unsigned char *pos;
+    const unsigned char *end;
+
+    // Regular files are mapped into memory all at once
+    int fd;
+    void *mapping;
+    size_t mapping_size;
+
+    // Anything else is read through a large buffer
+    unsigned char *buffer;
+    size_t c_buffer;
+    bool at_eof;
+
+    // Compressed input is decoded into the buffer
+    // from a window over the raw bytes of the file
+    Compression compression;
+    const unsigned char *raw_pos;
+    const unsigned char *raw_end;
+    unsigned char *raw_buffer;
+    size_t c_raw_buffer;
+    bool raw_eof;
+    void *decoder;
+
+    // Name of the input used in error messages
+    const char *name;
+
+    // Set once the input could not be read, when the reader has
+    // already said why and the input is taken to end there
+    Error error;
+}
+Reader;
+
+// Opens the named file, or the console input for NULL,
+// recognizing gzip, xz and bzip2 input by its first bytes
+Error open_reader(Reader *, const char *);
+
+// Reads from input already in memory, which must outlive the reader
+Error open_memory_reader(Reader *,
+                         const unsigned char *,
+                         size_t,
+                         const char *);
+
+void close_reader(Reader *);
+
+// Makes more input available, returning false at the end of input
+bool fill_reader(Reader *);
+
+static inline int peek_char(Reader *reader)
+{
+    if (reader->pos == reader->end && ! fill_reader(reader)) {
+        return EOF;
+    }
+    return *reader->pos;
+}
+
+static inline int read_char(Reader *reader)
+{
+    if (reader->pos == reader->end && ! fill_reader(reader)) {
+        return EOF;
+    }
+    return *reader->pos++;
+}
+
+#endif
+
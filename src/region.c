@@ -0,0 +1,331 @@
+
+// Needed for mremap, which grows a large allocation without copying it
+#define _GNU_SOURCE
+
+#include "region.h"
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "constants.h"
+
+// Every allocation is aligned for any type the solver keeps in one
+#define REGION_ALIGN 16
+
+// Bytes mapped at a time for the small allocations, and the size
+// from which an allocation is given a mapping of its own instead
+#define REGION_BLOCK_SIZE (1 << 20)
+#define REGION_LARGE_SIZE (REGION_BLOCK_SIZE / 4)
+
+// Transparent huge pages on x86-64 and most other systems
+#define HUGE_PAGE_SIZE (2 << 20)
+
+#define ALIGN_UP(N, A) (((N) + (A) - 1) / (A) * (A))
+
+// Offset of the first allocation in a block
+#define BLOCK_START ALIGN_UP(sizeof(RegionBlock), REGION_ALIGN)
+
+static size_t page_size(size_t);
+static void *map_memory(size_t *);
+static void unmap_memory(void *, size_t);
+static RegionBlock *next_block(Region *, size_t);
+static void *alloc_large(Region *, size_t);
+static void *realloc_large(Region *, RegionHeader *, size_t);
+static void note_used(Region *, size_t);
+
+static bool huge_pages = false;
+
+void use_huge_pages(bool enabled)
+{
+    huge_pages = enabled;
+}
+
+void create_region(Region *region)
+{
+    region->first = NULL;
+    region->current = NULL;
+    region->last = NULL;
+    region->large = NULL;
+    region->n_used = 0;
+    region->peak = 0;
+}
+
+void delete_region(Region *region)
+{
+    RegionBlock *block = region->first;
+
+    reset_region(region);
+
+    while (block != NULL) {
+        RegionBlock *next = block->next;
+        unmap_memory(block, BLOCK_START + block->size);
+        block = next;
+    }
+
+    region->first = NULL;
+    region->current = NULL;
+}
+
+void *region_alloc(Region *region, size_t size)
+{
+    size_t total;
+    RegionBlock *block;
+    RegionHeader *header;
+
+    if (size >= REGION_LARGE_SIZE) {
+        return alloc_large(region, size);
+    }
+
+    size = ALIGN_UP(size, REGION_ALIGN);
+    total = sizeof(RegionHeader) + size;
+
+    block = region->current;
+    if (block == NULL || block->used + total > block->size) {
+        block = next_block(region, total);
+    }
+
+    header = (RegionHeader *) ((char *) block + BLOCK_START + block->used);
+    header->prev = NULL;
+    header->next = NULL;
+    header->mapped = 0;
+    header->size = size;
+
+    block->used += total;
+    note_used(region, total);
+
+    region->last = header + 1;
+    return header + 1;
+}
+
+void *region_realloc(Region *region, void *ptr, size_t size)
+{
+    RegionHeader *header;
+    RegionBlock *block;
+    void *new_ptr;
+
+    if (ptr == NULL) {
+        return region_alloc(region, size);
+    }
+
+    header = (RegionHeader *) ptr - 1;
+    if (size <= header->size) {
+        return ptr;
+    }
+
+    if (header->mapped != 0) {
+        return realloc_large(region, header, size);
+    }
+
+    // The latest allocation can take the rest of its block
+    block = region->current;
+    size = ALIGN_UP(size, REGION_ALIGN);
+    if (ptr == region->last && size < REGION_LARGE_SIZE &&
+        block->used + size - header->size <= block->size) {
+        block->used += size - header->size;
+        note_used(region, size - header->size);
+        header->size = size;
+        return ptr;
+    }
+
+    new_ptr = region_alloc(region, size);
+    memcpy(new_ptr, ptr, header->size);
+    region_free(region, ptr);
+
+    return new_ptr;
+}
+
+void region_free(Region *region, void *ptr)
+{
+    RegionHeader *header;
+
+    if (ptr == NULL) {
+        return;
+    }
+
+    header = (RegionHeader *) ptr - 1;
+
+    if (header->mapped != 0) {
+        if (header->prev != NULL) {
+            header->prev->next = header->next;
+        } else {
+            region->large = header->next;
+        }
+        if (header->next != NULL) {
+            header->next->prev = header->prev;
+        }
+        region->n_used -= header->mapped;
+        unmap_memory(header, header->mapped);
+        return;
+    }
+
+    // Only the latest small allocation can be taken back early
+    if (ptr == region->last) {
+        size_t total = sizeof(RegionHeader) + header->size;
+        region->current->used -= total;
+        region->n_used -= total;
+        region->last = NULL;
+    }
+}
+
+void reset_region(Region *region)
+{
+    // The large allocations left are few, since each of them
+    // is at least a quarter of a block
+    while (region->large != NULL) {
+        region_free(region, region->large + 1);
+    }
+
+    // Blocks are kept to be used again from the start
+    region->current = region->first;
+    if (region->current != NULL) {
+        region->current->used = 0;
+    }
+
+    region->last = NULL;
+    region->n_used = 0;
+    region->peak = 0;
+}
+
+static size_t page_size(size_t size)
+{
+    // Mappings smaller than a huge page would only be rounded up
+    if (huge_pages && size >= HUGE_PAGE_SIZE) {
+        return HUGE_PAGE_SIZE;
+    }
+    return (size_t) sysconf(_SC_PAGESIZE);
+}
+
+static void *map_memory(size_t *size)
+{
+    size_t page = page_size(*size);
+    void *ptr;
+
+    *size = ALIGN_UP(*size, page);
+    ptr = mmap(NULL, *size, PROT_READ | PROT_WRITE,
+               MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    if (ptr == MAP_FAILED) {
+        fprintf(stderr, PROGRAM_NAME ": %s\n", strerror(errno));
+        abort();
+    }
+
+#ifdef MADV_HUGEPAGE
+    // Only a hint, which the system is free to ignore
+    if (page == HUGE_PAGE_SIZE) {
+        madvise(ptr, *size, MADV_HUGEPAGE);
+    }
+#endif
+
+    return ptr;
+}
+
+static void unmap_memory(void *ptr, size_t size)
+{
+    munmap(ptr, size);
+}
+
+static RegionBlock *next_block(Region *region, size_t total)
+{
+    RegionBlock *block = region->current;
+    RegionBlock *prev;
+    size_t size;
+
+    // Blocks kept from before the last reset come first
+    while (block != NULL && block->next != NULL) {
+        block = block->next;
+        block->used = 0;
+        if (total <= block->size) {
+            region->current = block;
+            return block;
+        }
+    }
+
+    prev = block;
+    size = huge_pages ? HUGE_PAGE_SIZE : REGION_BLOCK_SIZE;
+    block = map_memory(&size);
+    block->next = NULL;
+    block->size = size - BLOCK_START;
+    block->used = 0;
+
+    if (prev != NULL) {
+        prev->next = block;
+    } else {
+        region->first = block;
+    }
+    region->current = block;
+
+    return block;
+}
+
+static void *alloc_large(Region *region, size_t size)
+{
+    size_t mapped = sizeof(RegionHeader) + size;
+    RegionHeader *header = map_memory(&mapped);
+
+    header->prev = NULL;
+    header->next = region->large;
+    header->mapped = mapped;
+    header->size = mapped - sizeof(RegionHeader);
+
+    if (region->large != NULL) {
+        region->large->prev = header;
+    }
+    region->large = header;
+    note_used(region, mapped);
+
+    return header + 1;
+}
+
+static void *realloc_large(Region *region,
+                           RegionHeader *header,
+                           size_t size)
+{
+#ifdef MREMAP_MAYMOVE
+    size_t old_mapped = header->mapped;
+    size_t mapped = sizeof(RegionHeader) + size;
+
+    // The system can move the pages without copying them
+    mapped = ALIGN_UP(mapped, page_size(mapped));
+    header = mremap(header, old_mapped, mapped, MREMAP_MAYMOVE);
+    if (header == MAP_FAILED) {
+        fprintf(stderr, PROGRAM_NAME ": %s\n", strerror(errno));
+        abort();
+    }
+
+    header->mapped = mapped;
+    header->size = mapped - sizeof(RegionHeader);
+    if (header->prev != NULL) {
+        header->prev->next = header;
+    } else {
+        region->large = header;
+    }
+    if (header->next != NULL) {
+        header->next->prev = header;
+    }
+    note_used(region, mapped - old_mapped);
+
+    return header + 1;
+#else
+    void *ptr = alloc_large(region, size);
+
+    memcpy(ptr, header + 1, header->size);
+    region_free(region, header + 1);
+
+    return ptr;
+#endif
+}
+
+static void note_used(Region *region, size_t n_bytes)
+{
+    region->n_used += n_bytes;
+    if (region->n_used > region->peak) {
+        region->peak = region->n_used;
+    }
+}
+
@@ -0,0 +1,71 @@
+
+#ifndef SIMPLESAT_REGION_H
+#define SIMPLESAT_REGION_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef struct RegionBlock RegionBlock;
+typedef struct RegionHeader RegionHeader;
+
+struct RegionBlock
+{
+    RegionBlock *next;
+
+    // Bytes that follow the header, and how many of them are taken
+    size_t size;
+    size_t used;
+};
+
+struct RegionHeader
+{
+    // Neighbours in the list of large allocations, which each
+    // have a mapping of `mapped` bytes to themselves
+    RegionHeader *prev;
+    RegionHeader *next;
+    size_t mapped;
+
+    // Bytes usable after the header
+    size_t size;
+};
+
+typedef struct
+{
+    // Blocks shared out between the small allocations, in the order
+    // they are used, and the one they are now being taken from
+    RegionBlock *first;
+    RegionBlock *current;
+
+    // Latest small allocation, which can grow where it is
+    void *last;
+
+    RegionHeader *large;
+
+    // Bytes held since the region was last reset, and the most
+    // there have been at once
+    size_t n_used;
+    size_t peak;
+}
+Region;
+
+// Memory is mapped straight from the system, in huge pages where
+// they are available once asked for, for every region from then on
+void use_huge_pages(bool);
+
+void create_region(Region *);
+void delete_region(Region *);
+
+// Small allocations are only given back all at once, by resetting
+// the region, which takes the same time however many there were;
+// large ones are also given back as soon as they are freed
+void *region_alloc(Region *, size_t);
+void *region_realloc(Region *, void *, size_t);
+void region_free(Region *, void *);
+void reset_region(Region *);
+
+#define REGION_CREATE(R, A, S) A = region_alloc(R, (S) * sizeof(*A))
+#define REGION_RESIZE(R, A, N) A = region_realloc(R, A, (N) * sizeof(*A))
+#define REGION_DELETE(R, A)    region_free(R, A);
+
+#endif
+
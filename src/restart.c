@@ -0,0 +1,118 @@
+
+#include "restart.h"
+
+#include <stdbool.h>
+
+#include "utils.h"
+
+static unsigned int luby(unsigned int);
+
+void create_restart_state(RestartState *rstate,
+                          RestartMode mode,
+                          unsigned int luby_unit,
+                          unsigned int window,
+                          double margin)
+{
+    rstate->mode = mode;
+    rstate->n_conflicts = 0;
+
+    rstate->n_restarts = 0;
+    rstate->luby_unit = luby_unit;
+
+    rstate->n_recent = 0;
+    rstate->c_recent = window;
+    rstate->next_recent = 0;
+    CREATE_ARRAY(rstate->recent_lbds, window);
+    rstate->recent_sum = 0;
+    rstate->total_sum = 0.0;
+    rstate->n_total = 0;
+    rstate->margin = margin;
+}
+
+void delete_restart_state(RestartState *rstate)
+{
+    DELETE_ARRAY(rstate->recent_lbds);
+}
+
+void note_conflict(RestartState *rstate, unsigned int lbd)
+{
+    rstate->n_conflicts += 1;
+
+    rstate->total_sum += lbd;
+    rstate->n_total += 1;
+
+    // Replace the oldest entry once the window is full
+    if (rstate->n_recent == rstate->c_recent) {
+        rstate->recent_sum -= rstate->recent_lbds[rstate->next_recent];
+    } else {
+        rstate->n_recent += 1;
+    }
+
+    rstate->recent_lbds[rstate->next_recent] = lbd;
+    rstate->recent_sum += lbd;
+    rstate->next_recent = (rstate->next_recent + 1) % rstate->c_recent;
+}
+
+bool restart_due(const RestartState *rstate)
+{
+    double recent_avg;
+    double total_avg;
+
+    switch (rstate->mode) {
+
+    case RESTART_NONE:
+        return false;
+
+    case RESTART_LUBY:
+        return rstate->n_conflicts >=
+               luby(rstate->n_restarts) * rstate->luby_unit;
+
+    case RESTART_GLUCOSE:
+        // Wait until there are enough conflicts to compare
+        if (rstate->n_recent < rstate->c_recent) {
+            return false;
+        }
+        recent_avg = (double) rstate->recent_sum / rstate->n_recent;
+        total_avg = rstate->total_sum / rstate->n_total;
+        return recent_avg * rstate->margin > total_avg;
+
+    }
+
+    // Should be unreachable
+    return false;
+}
+
+void note_restart(RestartState *rstate)
+{
+    rstate->n_conflicts = 0;
+    rstate->n_restarts += 1;
+
+    // Start a fresh window of recent conflicts
+    rstate->n_recent = 0;
+    rstate->next_recent = 0;
+    rstate->recent_sum = 0;
+}
+
+static unsigned int luby(unsigned int index)
+{
+    unsigned int size;
+    unsigned int seq;
+
+    // Find the smallest complete subsequence containing
+    // the index, then descend into the part holding it
+    size = 1;
+    seq = 0;
+    while (size < index + 1) {
+        size = 2 * size + 1;
+        seq += 1;
+    }
+
+    while (size - 1 != index) {
+        size = (size - 1) >> 1;
+        seq--;
+        index = index % size;
+    }
+
+    return 1u << seq;
+}
+
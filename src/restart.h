@@ -0,0 +1,51 @@
+
+#ifndef SIMPLESAT_RESTART_H
+#define SIMPLESAT_RESTART_H
+
+#include <stdbool.h>
+
+typedef enum
+{
+    RESTART_NONE,
+    RESTART_LUBY,
+    RESTART_GLUCOSE
+}
+RestartMode;
+
+typedef struct
+{
+    RestartMode mode;
+
+    // Conflicts since the last restart
+    unsigned int n_conflicts;
+
+    // Luby restarts happen after a number of
+    // conflicts following the Luby sequence
+    unsigned int n_restarts;
+    unsigned int luby_unit;
+
+    // Glucose restarts happen when the recent conflicts have
+    // produced clauses of worse quality than the average so far
+    unsigned int n_recent;
+    unsigned int c_recent;
+    unsigned int next_recent;
+    unsigned int *recent_lbds;
+    unsigned long recent_sum;
+    double total_sum;
+    unsigned long n_total;
+    double margin;
+}
+RestartState;
+
+void create_restart_state(RestartState *, RestartMode,
+                          unsigned int, unsigned int, double);
+void delete_restart_state(RestartState *);
+
+// Records a conflict that produced a clause with the given LBD
+void note_conflict(RestartState *, unsigned int);
+
+bool restart_due(const RestartState *);
+void note_restart(RestartState *);
+
+#endif
+
@@ -0,0 +1,1181 @@
+
+#include "server.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "constants.h"
+#include "error.h"
+#include "format.h"
+#include "problem.h"
+#include "reader.h"
+#include "solver.h"
+#include "utils.h"
+#include "workers.h"
+
+// Longest line that can say what a request is
+#define MAX_REQUEST_LINE 256
+
+// Seconds a client is given to send the whole of a request
+#define REQUEST_TIMEOUT 30.0
+
+// Space first read into for each connection
+#define CONNECTION_BUFFER_SIZE 4096
+
+// Parameters of the 64-bit FNV-1a hash that instances are keyed by
+#define HASH_OFFSET 14695981039346656037ULL
+#define HASH_PRIME  1099511628211ULL
+
+typedef struct
+{
+    Server *server;
+    unsigned int index;
+}
+ServerTask;
+
+static Error listen_unix(Server *, const char *);
+static Error listen_tcp(Server *, const char *);
+static void stop_server(int);
+
+static void *run_server_worker(void *);
+static void queue_connection(ServerConnection ***,
+                             unsigned int *,
+                             unsigned int *,
+                             ServerConnection *);
+static void serve_connection(Server *, unsigned int, ServerConnection *);
+static bool serve_request(Server *, unsigned int, ServerConnection *);
+static void answer_request(Server *,
+                           unsigned int,
+                           int,
+                           const uint64_t *,
+                           const unsigned char *,
+                           size_t);
+static bool parse_instance(Problem *,
+                           const unsigned char *,
+                           size_t,
+                           const Problem *);
+static void send_answer(int, uint64_t, const char *, size_t);
+static void send_error(int, const char *);
+static void send_all(int, struct iovec *, int);
+static void log_request(Server *,
+                        uint64_t,
+                        const char *,
+                        double,
+                        const char *);
+
+static CachedInstance *find_instance(Server *, uint64_t);
+static CachedInstance *match_instance(Server *,
+                                      uint64_t *,
+                                      const uint64_t *,
+                                      const unsigned char *,
+                                      size_t);
+static CachedInstance *add_instance(Server *,
+                                    uint64_t,
+                                    const uint64_t *,
+                                    const unsigned char *,
+                                    size_t,
+                                    Problem *);
+static void release_instance(Server *, CachedInstance *);
+static void delete_instance(CachedInstance *);
+
+static ServerConnection *open_connection(int);
+static void close_connection(ServerConnection *);
+static bool fill_connection(ServerConnection *);
+static char *read_line(ServerConnection *);
+static const unsigned char *read_payload(ServerConnection *, size_t);
+
+static uint64_t hash_bytes(uint64_t, const unsigned char *, size_t);
+
+// Set by SIGINT and SIGTERM, which only the accepting thread takes,
+// along with the stop flag of the server running at the time
+static volatile sig_atomic_t interrupted;
+static Server *volatile signalled_server;
+
+Error create_server(Server *server,
+                    const char *address,
+                    const SolverConfig *config,
+                    unsigned int num_workers,
+                    unsigned int cache_size,
+                    size_t max_payload,
+                    FILE *stream)
+{
+    Error err;
+    unsigned int i;
+
+    server->config = *config;
+    server->max_payload = max_payload;
+    server->listen_fd = -1;
+    server->socket_path = NULL;
+
+    if (strchr(address, '/') != NULL) {
+        err = listen_unix(server, address);
+    } else {
+        err = listen_tcp(server, address);
+    }
+
+    if (err) {
+        return err;
+    }
+
+    server->n_workers = num_workers > 0 ? num_workers : 1;
+    CREATE_ARRAY(server->workers, server->n_workers);
+    for (i = 0; i < server->n_workers; ++i) {
+        server->workers[i].fd = -1;
+        create_region(&server->workers[i].region);
+    }
+
+    server->n_cached = 0;
+    server->c_cached = cache_size;
+    CREATE_ARRAY(server->cached, server->c_cached + 1);
+    server->clock = 0;
+
+    server->n_pending = 0;
+    server->c_pending = 16;
+    CREATE_ARRAY(server->pending, server->c_pending);
+    server->n_returned = 0;
+    server->c_returned = 16;
+    CREATE_ARRAY(server->returned, server->c_returned);
+
+    if (pipe(server->wake_fds) != 0) {
+        fprintf(stderr, PROGRAM_NAME ": Cannot create pipe: %s\n",
+                strerror(errno));
+        server->wake_fds[0] = server->wake_fds[1] = -1;
+    } else {
+        // Nothing that writes a wake-up may wait for room to do so,
+        // least of all the signal handler, on the thread that reads it
+        fcntl(server->wake_fds[0], F_SETFL, O_NONBLOCK);
+        fcntl(server->wake_fds[1], F_SETFL, O_NONBLOCK);
+    }
+
+    atomic_init(&server->stop, false);
+
+    pthread_mutex_init(&server->lock, NULL);
+    pthread_cond_init(&server->changed, NULL);
+    server->stream = stream;
+
+    return ERROR_OK;
+}
+
+void delete_server(Server *server)
+{
+    unsigned int i;
+
+    close(server->listen_fd);
+    if (server->socket_path != NULL) {
+        unlink(server->socket_path);
+        DELETE_ARRAY(server->socket_path);
+    }
+
+    // Every worker has finished by now, so nothing is in use
+    for (i = 0; i < server->n_cached; ++i) {
+        delete_instance(server->cached[i]);
+    }
+
+    for (i = 0; i < server->n_pending; ++i) {
+        close_connection(server->pending[i]);
+    }
+
+    for (i = 0; i < server->n_returned; ++i) {
+        close_connection(server->returned[i]);
+    }
+
+    if (server->wake_fds[0] >= 0) {
+        close(server->wake_fds[0]);
+        close(server->wake_fds[1]);
+    }
+
+    for (i = 0; i < server->n_workers; ++i) {
+        delete_region(&server->workers[i].region);
+    }
+    DELETE_ARRAY(server->workers);
+    DELETE_ARRAY(server->cached);
+    DELETE_ARRAY(server->pending);
+    DELETE_ARRAY(server->returned);
+
+    pthread_mutex_destroy(&server->lock);
+    pthread_cond_destroy(&server->changed);
+}
+
+static Error listen_unix(Server *server, const char *path)
+{
+    struct sockaddr_un addr;
+    struct stat info;
+    size_t length = strlen(path);
+
+    if (length >= sizeof(addr.sun_path)) {
+        fprintf(stderr, PROGRAM_NAME ": %s: Socket path too long\n", path);
+        return ERROR_INVALID_USAGE;
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    memcpy(addr.sun_path, path, length + 1);
+
+    // A socket left behind by an earlier server is replaced,
+    // but nothing else that might be there
+    if (lstat(path, &info) == 0 && S_ISSOCK(info.st_mode)) {
+        unlink(path);
+    }
+
+    server->listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (server->listen_fd < 0 ||
+        bind(server->listen_fd,
+             (struct sockaddr *) &addr, sizeof(addr)) != 0 ||
+        listen(server->listen_fd, SOMAXCONN) != 0) {
+        fprintf(stderr, PROGRAM_NAME ": %s: %s\n", path, strerror(errno));
+        if (server->listen_fd >= 0) {
+            close(server->listen_fd);
+        }
+        return ERROR_FILE_ACCESS;
+    }
+
+    CREATE_ARRAY(server->socket_path, length + 1);
+    memcpy(server->socket_path, path, length + 1);
+
+    return ERROR_OK;
+}
+
+static Error listen_tcp(Server *server, const char *address)
+{
+    struct addrinfo hints;
+    struct addrinfo *results;
+    struct addrinfo *ai;
+    const char *colon = strrchr(address, ':');
+    const char *port = colon != NULL ? colon + 1 : address;
+    char *host = NULL;
+    int status;
+    int yes = 1;
+
+    // Without a host, or with an empty one, every interface is used
+    if (colon != NULL && colon > address) {
+        CREATE_ARRAY(host, colon - address + 1);
+        memcpy(host, address, colon - address);
+        host[colon - address] = '\0';
+    }
+
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+
+    status = getaddrinfo(host, port, &hints, &results);
+    DELETE_ARRAY(host);
+
+    if (status != 0) {
+        fprintf(stderr, PROGRAM_NAME ": %s: %s\n",
+                address, gai_strerror(status));
+        return ERROR_FILE_ACCESS;
+    }
+
+    for (ai = results; ai != NULL; ai = ai->ai_next) {
+
+        int fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if (fd < 0) {
+            continue;
+        }
+
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+        if (bind(fd, ai->ai_addr, ai->ai_addrlen) == 0 &&
+            listen(fd, SOMAXCONN) == 0) {
+            server->listen_fd = fd;
+            break;
+        }
+
+        close(fd);
+    }
+
+    freeaddrinfo(results);
+
+    if (server->listen_fd < 0) {
+        fprintf(stderr, PROGRAM_NAME ": %s: %s\n",
+                address, strerror(errno));
+        return ERROR_FILE_ACCESS;
+    }
+
+    return ERROR_OK;
+}
+
+void run_server(Server *server)
+{
+    pthread_t *threads;
+    ServerTask *tasks;
+    struct sigaction action;
+    sigset_t signals;
+    ServerConnection **idle;
+    unsigned int n_idle = 0;
+    unsigned int c_idle = 16;
+    struct pollfd *polled;
+    unsigned int c_polled = 0;
+    unsigned int n_started;
+    unsigned int i;
+    unsigned int j;
+
+    CREATE_ARRAY(threads, server->n_workers);
+    CREATE_ARRAY(tasks, server->n_workers);
+    CREATE_ARRAY(idle, c_idle);
+    polled = NULL;
+
+    /*
+     * 1. Start a thread for every worker
+     */
+
+    // The workers leave the signals to this thread, so that they
+    // are sure to interrupt it while it waits for a connection
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, NULL);
+
+    for (i = 0; i < server->n_workers; ++i) {
+        tasks[i].server = server;
+        tasks[i].index = i;
+    }
+
+    // Without a pipe, no connection could ever be handed back
+    n_started = 0;
+    if (server->wake_fds[0] >= 0) {
+        n_started = start_threads(threads, run_server_worker, tasks,
+                                  sizeof(*tasks), 0, server->n_workers);
+    }
+
+    signalled_server = server;
+
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = stop_server;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+    pthread_sigmask(SIG_UNBLOCK, &signals, NULL);
+
+    /*
+     * 2. Watch for connections and requests, handing each
+     *    request to the next worker free
+     */
+
+    while (! interrupted) {
+
+        unsigned int n_polled;
+
+        // Connections the workers are done with are watched again
+        pthread_mutex_lock(&server->lock);
+        for (i = 0; i < server->n_returned; ++i) {
+            queue_connection(&idle, &n_idle, &c_idle,
+                             server->returned[i]);
+        }
+        server->n_returned = 0;
+        pthread_mutex_unlock(&server->lock);
+
+        if (c_polled < n_idle + 2) {
+            c_polled = n_idle + 2;
+            RESIZE_ARRAY(polled, c_polled);
+        }
+
+        polled[0].fd = server->listen_fd;
+        polled[1].fd = server->wake_fds[0];
+        for (i = 0; i < n_idle; ++i) {
+            polled[i + 2].fd = idle[i]->fd;
+        }
+
+        n_polled = n_idle + 2;
+        for (i = 0; i < n_polled; ++i) {
+            polled[i].events = POLLIN;
+            polled[i].revents = 0;
+        }
+
+        if (poll(polled, n_polled, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            fprintf(stderr, PROGRAM_NAME ": Cannot wait for requests: %s\n",
+                    strerror(errno));
+            break;
+        }
+
+        // The wake-ups have done their job once they are read
+        if (polled[1].revents != 0) {
+            char bytes[64];
+            ssize_t n_read = read(server->wake_fds[0], bytes, sizeof(bytes));
+            (void) n_read;
+        }
+
+        // Connections that have something to say, or that have been
+        // closed, go to the workers, and the rest keep waiting
+        for (i = j = 0; i < n_idle; ++i) {
+
+            if (polled[i + 2].revents == 0) {
+                idle[j++] = idle[i];
+            } else if (n_started == 0) {
+                // Without any threads, requests are served in turn
+                serve_connection(server, 0, idle[i]);
+            } else {
+                pthread_mutex_lock(&server->lock);
+                queue_connection(&server->pending, &server->n_pending,
+                                 &server->c_pending, idle[i]);
+                pthread_cond_signal(&server->changed);
+                pthread_mutex_unlock(&server->lock);
+            }
+        }
+        n_idle = j;
+
+        if (polled[0].revents != 0) {
+
+            int fd = accept(server->listen_fd, NULL, NULL);
+            int yes = 1;
+
+            if (fd >= 0) {
+                // Answers are written whole, and should not wait to be
+                // joined by others; this fails harmlessly on Unix sockets
+                setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+                queue_connection(&idle, &n_idle, &c_idle,
+                                 open_connection(fd));
+            } else if (errno != EINTR && errno != ECONNABORTED &&
+                       errno != EAGAIN) {
+                fprintf(stderr, PROGRAM_NAME
+                        ": Cannot accept connection: %s\n", strerror(errno));
+                break;
+            }
+        }
+    }
+
+    /*
+     * 3. Stop the workers, wherever they are
+     */
+
+    atomic_store(&server->stop, true);
+
+    // No more requests are read from their clients, so that none
+    // of them is left waiting for one, but the answers they were
+    // working on can still be sent
+    pthread_mutex_lock(&server->lock);
+    for (i = 0; i < server->n_workers; ++i) {
+        if (server->workers[i].fd >= 0) {
+            shutdown(server->workers[i].fd, SHUT_RD);
+        }
+    }
+    pthread_cond_broadcast(&server->changed);
+    pthread_mutex_unlock(&server->lock);
+
+    join_threads(threads, 0, n_started);
+
+    for (i = 0; i < n_idle; ++i) {
+        close_connection(idle[i]);
+    }
+
+    signalled_server = NULL;
+
+    DELETE_ARRAY(threads);
+    DELETE_ARRAY(tasks);
+    DELETE_ARRAY(idle);
+    DELETE_ARRAY(polled);
+}
+
+static void stop_server(int signum)
+{
+    Server *server = signalled_server;
+    int saved_errno = errno;
+    ssize_t n_written;
+
+    (void) signum;
+    interrupted = 1;
+
+    // A signal between the check of `interrupted` and the wait would
+    // otherwise go unseen until the next connection, and a search
+    // this thread is running would not be stopped at all
+    if (server != NULL) {
+        atomic_store(&server->stop, true);
+        if (server->wake_fds[1] >= 0) {
+            n_written = write(server->wake_fds[1], "", 1);
+            (void) n_written;
+        }
+    }
+
+    errno = saved_errno;
+}
+
+static void *run_server_worker(void *arg)
+{
+    ServerTask *task = arg;
+    Server *server = task->server;
+    ServerConnection *connection;
+
+    for (;;) {
+
+        pthread_mutex_lock(&server->lock);
+        while (server->n_pending == 0 && ! atomic_load(&server->stop)) {
+            pthread_cond_wait(&server->changed, &server->lock);
+        }
+
+        if (atomic_load(&server->stop)) {
+            pthread_mutex_unlock(&server->lock);
+            break;
+        }
+
+        // Requests are taken in the order they arrived
+        connection = server->pending[0];
+        server->n_pending -= 1;
+        memmove(server->pending, server->pending + 1,
+                server->n_pending * sizeof(*server->pending));
+        pthread_mutex_unlock(&server->lock);
+
+        serve_connection(server, task->index, connection);
+    }
+
+    return NULL;
+}
+
+static void queue_connection(ServerConnection ***queue,
+                             unsigned int *n_queued,
+                             unsigned int *c_queued,
+                             ServerConnection *connection)
+{
+    if (*n_queued == *c_queued) {
+        *c_queued *= 2;
+        RESIZE_ARRAY(*queue, *c_queued);
+    }
+
+    (*queue)[(*n_queued)++] = connection;
+}
+
+static void serve_connection(Server *server,
+                             unsigned int index,
+                             ServerConnection *connection)
+{
+    ServerWorker *worker = &server->workers[index];
+    ssize_t n_written;
+    bool open;
+
+    pthread_mutex_lock(&server->lock);
+    worker->fd = connection->fd;
+    pthread_mutex_unlock(&server->lock);
+
+    // Requests already read in are answered straight away,
+    // since nothing more may arrive to say they are there
+    do {
+        open = serve_request(server, index, connection);
+    } while (open && connection->start < connection->end);
+
+    // The worker lets go of the descriptor before it is closed,
+    // so that a shutdown never reaches another connection
+    pthread_mutex_lock(&server->lock);
+    worker->fd = -1;
+    if (open && ! atomic_load(&server->stop)) {
+        queue_connection(&server->returned, &server->n_returned,
+                         &server->c_returned, connection);
+        connection = NULL;
+    }
+    pthread_mutex_unlock(&server->lock);
+
+    // A pipe too full to write to has a wake-up waiting anyway
+    if (connection != NULL) {
+        close_connection(connection);
+    } else {
+        n_written = write(server->wake_fds[1], "", 1);
+        (void) n_written;
+    }
+}
+
+static bool serve_request(Server *server,
+                          unsigned int index,
+                          ServerConnection *connection)
+{
+    const unsigned char *payload;
+    char *line;
+    size_t length;
+    uint64_t base;
+    size_t size;
+    int end = -1;
+    bool has_base;
+
+    connection->deadline = wall_time() + REQUEST_TIMEOUT;
+
+    // Each request is a line saying what to do with the instance
+    // that follows it, of which it also gives the size in bytes
+    do {
+        line = read_line(connection);
+        if (line == NULL) {
+            return false;
+        }
+
+        length = strlen(line);
+        while (length > 0 && strchr(" \t\r", line[length - 1]) != NULL) {
+            line[--length] = '\0';
+        }
+    } while (length == 0);
+
+    if (sscanf(line, "solve %zu%n", &size, &end) == 1 &&
+        (size_t) end == length) {
+        has_base = false;
+    } else if (sscanf(line, "add %" SCNx64 " %zu%n",
+                      &base, &size, &end) == 2 &&
+               (size_t) end == length) {
+        has_base = true;
+    } else {
+        // The rest of the connection cannot be made sense of
+        send_error(connection->fd, "Invalid request");
+        return false;
+    }
+
+    if (size > server->max_payload) {
+        send_error(connection->fd, "Instance too large");
+        return false;
+    }
+
+    payload = read_payload(connection, size);
+    if (payload == NULL) {
+        return false;
+    }
+
+    answer_request(server, index, connection->fd,
+                   has_base ? &base : NULL, payload, size);
+
+    return true;
+}
+
+static void answer_request(Server *server,
+                           unsigned int index,
+                           int fd,
+                           const uint64_t *base,
+                           const unsigned char *payload,
+                           size_t size)
+{
+    double start_time = wall_time();
+    CachedInstance *base_instance = NULL;
+    CachedInstance *instance;
+    Problem problem;
+    uint64_t key = HASH_OFFSET;
+    char *answer = NULL;
+    size_t answer_length = 0;
+    Solution solution;
+    bool cached;
+    unsigned int i;
+
+    /*
+     * 1. Look for the instance among those already parsed
+     */
+
+    if (base != NULL) {
+        pthread_mutex_lock(&server->lock);
+        base_instance = find_instance(server, *base);
+        pthread_mutex_unlock(&server->lock);
+
+        if (base_instance == NULL) {
+            send_error(fd, "Unknown instance");
+            log_request(server, *base, "ERROR",
+                        wall_time() - start_time, "-");
+            return;
+        }
+
+        // An instance with added clauses is keyed by both
+        // the instance it started from and the clauses
+        for (i = 0; i < 8; ++i) {
+            unsigned char byte = (unsigned char) (*base >> (8 * i));
+            key = hash_bytes(key, &byte, 1);
+        }
+    }
+
+    key = hash_bytes(key, payload, size);
+
+    pthread_mutex_lock(&server->lock);
+    instance = match_instance(server, &key, base, payload, size);
+    pthread_mutex_unlock(&server->lock);
+
+    if (instance == NULL) {
+
+        if (! parse_instance(&problem, payload, size,
+                             base_instance != NULL ?
+                             &base_instance->problem : NULL)) {
+            if (base_instance != NULL) {
+                release_instance(server, base_instance);
+            }
+            send_error(fd, "Invalid instance");
+            log_request(server, key, "ERROR",
+                        wall_time() - start_time, "-");
+            return;
+        }
+
+        pthread_mutex_lock(&server->lock);
+        instance = add_instance(server, key, base, payload, size, &problem);
+        pthread_mutex_unlock(&server->lock);
+    }
+
+    // The instance may have been named by another key than the hash
+    key = instance->key;
+
+    if (base_instance != NULL) {
+        release_instance(server, base_instance);
+    }
+
+    /*
+     * 2. Solve it, unless its answer is already known
+     */
+
+    // Answers never change once they are set
+    pthread_mutex_lock(&server->lock);
+    cached = instance->answer != NULL;
+    pthread_mutex_unlock(&server->lock);
+
+    if (cached) {
+        solution = instance->solution;
+        send_answer(fd, key, instance->answer, instance->answer_length);
+    } else {
+        Region *region = &server->workers[index].region;
+        Solver solver;
+
+        create_solver_in(&solver, &instance->problem, region);
+        solver.config = server->config;
+        solver.worker = index;
+        solver.stop = &server->stop;
+
+        solution = solver.solution = solve(&solver);
+        answer = format_answer(&solver, &answer_length);
+        delete_solver(&solver);
+        reset_region(region);
+
+        send_answer(fd, key, answer, answer_length);
+
+        // The first to finish keeps its answer for the others
+        pthread_mutex_lock(&server->lock);
+        if (solution != SOLUTION_UNKNOWN && instance->answer == NULL) {
+            instance->solution = solution;
+            instance->answer = answer;
+            instance->answer_length = answer_length;
+            answer = NULL;
+        }
+        pthread_mutex_unlock(&server->lock);
+
+        DELETE_ARRAY(answer);
+    }
+
+    release_instance(server, instance);
+
+    log_request(server, key, status_name(solution),
+                wall_time() - start_time, cached ? "cached" : "solved");
+}
+
+static bool parse_instance(Problem *problem,
+                           const unsigned char *payload,
+                           size_t size,
+                           const Problem *base)
+{
+    Reader reader;
+    Problem merged;
+    const Problem *parts[2];
+    unsigned int n_vars;
+    unsigned int i;
+    unsigned int j;
+    Offset k;
+
+    if (open_memory_reader(&reader, payload, size, "request")) {
+        return false;
+    }
+
+    if (read_problem(problem, &reader)) {
+        close_reader(&reader);
+        return false;
+    }
+    close_reader(&reader);
+
+    if (base == NULL) {
+        return true;
+    }
+
+    // Either part may fit on its own without the two fitting together
+    if (base->n_clauses > INT_MAX - problem->n_clauses ||
+        base->n_lits > OFFSET_MAX - problem->n_lits) {
+        delete_problem(problem);
+        return false;
+    }
+
+    // Added clauses may bring in variables of their own
+    n_vars = base->n_vars > problem->n_vars ? base->n_vars : problem->n_vars;
+    create_problem(&merged, n_vars, base->n_clauses + problem->n_clauses);
+
+    parts[0] = base;
+    parts[1] = problem;
+    for (i = 0; i < 2; ++i) {
+        for (j = 0; j < parts[i]->n_clauses; ++j) {
+            for (k = parts[i]->clause_starts[j];
+                 k < parts[i]->clause_starts[j + 1]; ++k) {
+                push_problem_literal(&merged, parts[i]->lits[k]);
+            }
+            finish_problem_clause(&merged);
+        }
+    }
+
+    delete_problem(problem);
+    *problem = merged;
+
+    return true;
+}
+
+static void send_answer(int fd,
+                        uint64_t key,
+                        const char *answer,
+                        size_t length)
+{
+    char header[32];
+    struct iovec parts[2];
+
+    // The instance is named first, so that clauses can be added to it
+    parts[0].iov_base = header;
+    parts[0].iov_len = (size_t) snprintf(header, sizeof(header),
+                                         "c id %016" PRIx64 "\n", key);
+    parts[1].iov_base = (char *) answer;
+    parts[1].iov_len = length;
+
+    send_all(fd, parts, 2);
+}
+
+static void send_error(int fd, const char *message)
+{
+    char line[80];
+    struct iovec part;
+
+    part.iov_base = line;
+    part.iov_len = (size_t) snprintf(line, sizeof(line),
+                                     "c %s\ns ERROR\n", message);
+
+    send_all(fd, &part, 1);
+}
+
+static void send_all(int fd, struct iovec *parts, int n_parts)
+{
+    struct msghdr message;
+    ssize_t sent;
+
+    memset(&message, 0, sizeof(message));
+    message.msg_iov = parts;
+    message.msg_iovlen = n_parts;
+
+    // A client that has gone away is not worth a SIGPIPE
+    while (message.msg_iovlen > 0) {
+
+        sent = sendmsg(fd, &message, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return;
+        }
+
+        // Move past whatever was sent, which may end partway
+        // through one of the parts
+        while (message.msg_iovlen > 0 &&
+               (size_t) sent >= message.msg_iov->iov_len) {
+            sent -= message.msg_iov->iov_len;
+            message.msg_iov += 1;
+            message.msg_iovlen -= 1;
+        }
+
+        if (message.msg_iovlen > 0) {
+            message.msg_iov->iov_base =
+                (char *) message.msg_iov->iov_base + sent;
+            message.msg_iov->iov_len -= (size_t) sent;
+        }
+    }
+}
+
+static void log_request(Server *server,
+                        uint64_t key,
+                        const char *status,
+                        double elapsed,
+                        const char *source)
+{
+    pthread_mutex_lock(&server->lock);
+    fprintf(server->stream, "%016" PRIx64 "\t%s\t%.6f\t%s\n",
+            key, status, elapsed, source);
+    fflush(server->stream);
+    pthread_mutex_unlock(&server->lock);
+}
+
+/*
+ * The cache, only ever used with the lock held
+ */
+
+static CachedInstance *find_instance(Server *server, uint64_t key)
+{
+    unsigned int i;
+
+    for (i = 0; i < server->n_cached; ++i) {
+        CachedInstance *instance = server->cached[i];
+        if (instance->key == key) {
+            instance->last_used = ++server->clock;
+            instance->n_users += 1;
+            return instance;
+        }
+    }
+
+    return NULL;
+}
+
+static CachedInstance *match_instance(Server *server,
+                                      uint64_t *key,
+                                      const uint64_t *base,
+                                      const unsigned char *payload,
+                                      size_t size)
+{
+    CachedInstance *instance;
+    unsigned int i;
+
+    // Keys are tried in turn from the hash, until one names the same
+    // request or none is found, in which case the key is left free
+    for (;;) {
+
+        instance = NULL;
+        for (i = 0; i < server->n_cached; ++i) {
+            if (server->cached[i]->key == *key) {
+                instance = server->cached[i];
+                break;
+            }
+        }
+
+        if (instance == NULL) {
+            return NULL;
+        }
+
+        if (instance->has_base == (base != NULL) &&
+            (base == NULL || instance->base == *base) &&
+            instance->payload_size == size &&
+            memcmp(instance->payload, payload, size) == 0) {
+            instance->last_used = ++server->clock;
+            instance->n_users += 1;
+            return instance;
+        }
+
+        *key += 1;
+    }
+}
+
+static CachedInstance *add_instance(Server *server,
+                                    uint64_t key,
+                                    const uint64_t *base,
+                                    const unsigned char *payload,
+                                    size_t size,
+                                    Problem *problem)
+{
+    CachedInstance *instance;
+    unsigned int oldest;
+    unsigned int i;
+
+    // Another worker may have parsed the same instance meanwhile
+    instance = match_instance(server, &key, base, payload, size);
+    if (instance != NULL) {
+        delete_problem(problem);
+        return instance;
+    }
+
+    if (server->n_cached == server->c_cached && server->n_cached > 0) {
+
+        oldest = 0;
+        for (i = 1; i < server->n_cached; ++i) {
+            if (server->cached[i]->last_used <
+                server->cached[oldest]->last_used) {
+                oldest = i;
+            }
+        }
+
+        instance = server->cached[oldest];
+        server->cached[oldest] = server->cached[--server->n_cached];
+
+        instance->evicted = true;
+        if (instance->n_users == 0) {
+            delete_instance(instance);
+        }
+    }
+
+    CREATE_ARRAY(instance, 1);
+    instance->key = key;
+    instance->has_base = base != NULL;
+    instance->base = base != NULL ? *base : 0;
+    CREATE_ARRAY(instance->payload, size > 0 ? size : 1);
+    memcpy(instance->payload, payload, size);
+    instance->payload_size = size;
+    instance->problem = *problem;
+    instance->solution = SOLUTION_UNKNOWN;
+    instance->answer = NULL;
+    instance->answer_length = 0;
+    instance->last_used = ++server->clock;
+    instance->n_users = 1;
+
+    // Without any room, the instance is only kept while in use
+    instance->evicted = server->c_cached == 0;
+    if (! instance->evicted) {
+        server->cached[server->n_cached++] = instance;
+    }
+
+    return instance;
+}
+
+static void release_instance(Server *server, CachedInstance *instance)
+{
+    pthread_mutex_lock(&server->lock);
+    instance->n_users -= 1;
+    if (instance->evicted && instance->n_users == 0) {
+        delete_instance(instance);
+    }
+    pthread_mutex_unlock(&server->lock);
+}
+
+static void delete_instance(CachedInstance *instance)
+{
+    delete_problem(&instance->problem);
+    DELETE_ARRAY(instance->payload);
+    DELETE_ARRAY(instance->answer);
+    DELETE_ARRAY(instance);
+}
+
+/*
+ * Buffered input from the clients
+ */
+
+static ServerConnection *open_connection(int fd)
+{
+    ServerConnection *connection;
+
+    CREATE_ARRAY(connection, 1);
+    connection->fd = fd;
+    connection->start = 0;
+    connection->end = 0;
+    connection->capacity = CONNECTION_BUFFER_SIZE;
+    CREATE_ARRAY(connection->buffer, connection->capacity);
+
+    return connection;
+}
+
+static void close_connection(ServerConnection *connection)
+{
+    close(connection->fd);
+    DELETE_ARRAY(connection->buffer);
+    DELETE_ARRAY(connection);
+}
+
+static bool fill_connection(ServerConnection *connection)
+{
+    ssize_t n_read;
+
+    // Input already taken makes room for more
+    if (connection->start > 0) {
+        memmove(connection->buffer, connection->buffer + connection->start,
+                connection->end - connection->start);
+        connection->end -= connection->start;
+        connection->start = 0;
+    }
+
+    if (connection->end == connection->capacity) {
+        connection->capacity *= 2;
+        RESIZE_ARRAY(connection->buffer, connection->capacity);
+    }
+
+    for (;;) {
+        struct pollfd polled;
+        double timeout;
+        int n_ready;
+
+        // A client that stops partway through a request is not waited
+        // for past the deadline, so that it cannot keep the worker
+        timeout = connection->deadline - wall_time();
+        if (timeout <= 0.0) {
+            send_error(connection->fd, "Request timed out");
+            return false;
+        }
+
+        polled.fd = connection->fd;
+        polled.events = POLLIN;
+        n_ready = poll(&polled, 1, (int) (timeout * 1000.0) + 1);
+        if (n_ready < 0 && errno != EINTR) {
+            return false;
+        } else if (n_ready <= 0) {
+            continue;
+        }
+
+        n_read = read(connection->fd, connection->buffer + connection->end,
+                      connection->capacity - connection->end);
+        if (n_read > 0) {
+            connection->end += (size_t) n_read;
+            return true;
+        } else if (n_read == 0 || errno != EINTR) {
+            return false;
+        }
+    }
+}
+
+static char *read_line(ServerConnection *connection)
+{
+    unsigned char *newline;
+    char *line;
+
+    for (;;) {
+
+        newline = memchr(connection->buffer + connection->start, '\n',
+                         connection->end - connection->start);
+        if (newline != NULL) {
+            break;
+        }
+
+        if (connection->end - connection->start > MAX_REQUEST_LINE) {
+            send_error(connection->fd, "Invalid request");
+            return NULL;
+        }
+
+        if (! fill_connection(connection)) {
+            return NULL;
+        }
+    }
+
+    // The line is ended in place, where it stays until the next read
+    *newline = '\0';
+    line = (char *) connection->buffer + connection->start;
+    connection->start = newline + 1 - connection->buffer;
+
+    return line;
+}
+
+static const unsigned char *read_payload(ServerConnection *connection,
+                                         size_t size)
+{
+    const unsigned char *payload;
+
+    // The buffer only grows as the input arrives, so that a size
+    // that is given but never sent takes up no memory
+    while (connection->end - connection->start < size) {
+        if (! fill_connection(connection)) {
+            return NULL;
+        }
+    }
+
+    payload = connection->buffer + connection->start;
+    connection->start += size;
+
+    return payload;
+}
+
+static uint64_t hash_bytes(uint64_t hash,
+                           const unsigned char *bytes,
+                           size_t n)
+{
+    size_t i;
+
+    for (i = 0; i < n; ++i) {
+        hash = (hash ^ bytes[i]) * HASH_PRIME;
+    }
+
+    return hash;
+}
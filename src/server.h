@@ -0,0 +1,137 @@
+
+#ifndef SIMPLESAT_SERVER_H
+#define SIMPLESAT_SERVER_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "error.h"
+#include "problem.h"
+#include "region.h"
+#include "solver.h"
+
+typedef struct
+{
+    // Hash of the requests that described the instance, used
+    // both to look it up and to name it in the answers, moved on
+    // to the next one free when two different requests share it
+    uint64_t key;
+
+    // Request itself, which is compared before a matching hash
+    // is trusted: the instance it added to, if any, and the clauses
+    bool has_base;
+    uint64_t base;
+    unsigned char *payload;
+    size_t payload_size;
+
+    Problem problem;
+
+    // Answer given once the instance has been solved, kept
+    // only when it is not unknown
+    Solution solution;
+    char *answer;
+    size_t answer_length;
+
+    // Moment it was last asked for, by the server's own clock
+    uint64_t last_used;
+
+    // Workers still using the instance, which is only deleted
+    // once it has been evicted and none of them are left
+    unsigned int n_users;
+    bool evicted;
+}
+CachedInstance;
+
+typedef struct
+{
+    int fd;
+
+    // Input from the client that no request has taken yet,
+    // which lies between `start` and `end`
+    unsigned char *buffer;
+    size_t start;
+    size_t end;
+    size_t capacity;
+
+    // Wall time by which the request being read must have arrived
+    double deadline;
+}
+ServerConnection;
+
+typedef struct
+{
+    // Connection being served, or -1 while waiting for one
+    int fd;
+
+    // Memory for each solver in turn, reset between requests
+    Region region;
+}
+ServerWorker;
+
+typedef struct
+{
+    // Every instance is solved by a single solver with this config
+    SolverConfig config;
+
+    // Bytes of input accepted in a single request
+    size_t max_payload;
+
+    // Socket listening for connections, and the path to remove
+    // afterwards if it is a Unix socket
+    int listen_fd;
+    char *socket_path;
+
+    unsigned int n_workers;
+    ServerWorker *workers;
+
+    // Instances parsed recently, the least recently used of which
+    // makes way for each new one once there are `c_cached`
+    unsigned int n_cached;
+    unsigned int c_cached;
+    CachedInstance **cached;
+    uint64_t clock;
+
+    // Connections with a request to be read, not yet taken by
+    // a worker, and those the workers are done with for now, which
+    // the pipe wakes the accepting thread up to watch again
+    unsigned int n_pending;
+    unsigned int c_pending;
+    ServerConnection **pending;
+    unsigned int n_returned;
+    unsigned int c_returned;
+    ServerConnection **returned;
+    int wake_fds[2];
+
+    // Set once the server is shutting down, which also stops
+    // every search that is still running
+    atomic_bool stop;
+
+    // Guards everything above that changes, and the log stream
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+    FILE *stream;
+}
+Server;
+
+// Listens on a Unix socket if the address names a path, which
+// is anything with a "/" in it, or on "[host:]port" otherwise
+Error create_server(Server *,
+                    const char *,
+                    const SolverConfig *,
+                    unsigned int,
+                    unsigned int,
+                    size_t,
+                    FILE *);
+void delete_server(Server *);
+
+// Answers requests until interrupted, writing a line for each to
+// the stream: the instance, the status, the time taken in seconds,
+// and whether the answer was solved for or cached, separated by tabs
+void run_server(Server *);
+
+#endif
+
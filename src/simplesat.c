@@ -0,0 +1,189 @@
+
+#include "simplesat.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "problem.h"
+#include "solver.h"
+#include "utils.h"
+
+struct SimpleSAT
+{
+    Solver solver;
+
+    // Clause being added, which only reaches the solver once finished
+    unsigned int n_lits;
+    unsigned int c_lits;
+    Literal *lits;
+
+    // Assumptions for the next search
+    unsigned int n_assumptions;
+    unsigned int c_assumptions;
+    Literal *assumptions;
+
+    // Variables some clause or assumption has used; the solver has
+    // more than these, since it starts with one and keeps every
+    // variable numbered below the largest
+    unsigned int c_mentioned;
+    bool *mentioned;
+
+    // Outcome of the last search, until the clauses change
+    Solution solution;
+};
+
+static Literal take_literal(SimpleSAT *, int);
+
+SimpleSAT *simplesat_create(void)
+{
+    SimpleSAT *sat;
+    Problem problem;
+
+    CREATE_ARRAY(sat, 1);
+
+    // Start from no clauses at all; variables are reserved as they come
+    create_problem(&problem, 1, 0);
+    create_solver(&sat->solver, &problem);
+    delete_problem(&problem);
+
+    // Eliminated variables could not be used by later clauses
+    sat->solver.config.preprocess = false;
+
+    sat->n_lits = 0;
+    sat->c_lits = 16;
+    CREATE_ARRAY(sat->lits, sat->c_lits);
+
+    sat->n_assumptions = 0;
+    sat->c_assumptions = 16;
+    CREATE_ARRAY(sat->assumptions, sat->c_assumptions);
+
+    sat->c_mentioned = 0;
+    sat->mentioned = NULL;
+
+    sat->solution = SOLUTION_UNKNOWN;
+
+    return sat;
+}
+
+void simplesat_delete(SimpleSAT *sat)
+{
+    if (sat == NULL) {
+        return;
+    }
+
+    delete_solver(&sat->solver);
+    DELETE_ARRAY(sat->lits);
+    DELETE_ARRAY(sat->assumptions);
+    DELETE_ARRAY(sat->mentioned);
+    free(sat);
+}
+
+void simplesat_add(SimpleSAT *sat, int repr)
+{
+    if (repr == 0) {
+        insert_clause(&sat->solver, sat->lits, sat->n_lits);
+        sat->n_lits = 0;
+        sat->solution = SOLUTION_UNKNOWN;
+        return;
+    }
+
+    if (sat->n_lits == sat->c_lits) {
+        sat->c_lits *= 2;
+        RESIZE_ARRAY(sat->lits, sat->c_lits);
+    }
+    sat->lits[sat->n_lits++] = take_literal(sat, repr);
+}
+
+void simplesat_assume(SimpleSAT *sat, int repr)
+{
+    assert(repr != 0);
+
+    if (sat->n_assumptions == sat->c_assumptions) {
+        sat->c_assumptions *= 2;
+        RESIZE_ARRAY(sat->assumptions, sat->c_assumptions);
+    }
+    sat->assumptions[sat->n_assumptions++] = take_literal(sat, repr);
+}
+
+SimpleSATResult simplesat_solve(SimpleSAT *sat)
+{
+    assert(sat->n_lits == 0);
+
+    sat->solution = solve_assuming(&sat->solver,
+                                   sat->assumptions,
+                                   sat->n_assumptions);
+    sat->n_assumptions = 0;
+
+    switch (sat->solution) {
+
+    case SOLUTION_SATISFIABLE:
+        return SIMPLESAT_SATISFIABLE;
+
+    case SOLUTION_UNSATISFIABLE:
+        return SIMPLESAT_UNSATISFIABLE;
+
+    case SOLUTION_UNKNOWN:
+    default:
+        return SIMPLESAT_UNKNOWN;
+
+    }
+}
+
+int simplesat_value(const SimpleSAT *sat, int repr)
+{
+    Literal lit;
+    unsigned int var;
+
+    assert(repr != 0);
+    assert(sat->solution == SOLUTION_SATISFIABLE);
+
+    lit = lit_from_int(repr);
+    var = var_from_lit(lit);
+    if (var >= sat->c_mentioned || ! sat->mentioned[var]) {
+        return 0;
+    }
+
+    // The model stays on the trail until the clauses change
+    return sat->solver.values[lit] == VALUE_TRUE ? repr : -repr;
+}
+
+bool simplesat_failed(const SimpleSAT *sat, int repr)
+{
+    Literal lit;
+    unsigned int i;
+
+    assert(repr != 0);
+    assert(sat->solution == SOLUTION_UNSATISFIABLE);
+
+    lit = lit_from_int(repr);
+    for (i = 0; i < sat->solver.n_failed; ++i) {
+        if (sat->solver.failed[i] == lit) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static Literal take_literal(SimpleSAT *sat, int repr)
+{
+    Literal lit = lit_from_int(repr);
+    unsigned int var = var_from_lit(lit);
+    unsigned int c_mentioned = sat->c_mentioned;
+    unsigned int i;
+
+    reserve_vars(&sat->solver, var + 1);
+
+    if (var >= c_mentioned) {
+        sat->c_mentioned = 2 * c_mentioned > var ? 2 * c_mentioned : var + 1;
+        RESIZE_ARRAY(sat->mentioned, sat->c_mentioned);
+        for (i = c_mentioned; i < sat->c_mentioned; ++i) {
+            sat->mentioned[i] = false;
+        }
+    }
+    sat->mentioned[var] = true;
+
+    return lit;
+}
+
@@ -0,0 +1,59 @@
+
+#ifndef SIMPLESAT_H
+#define SIMPLESAT_H
+
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Only these functions are visible outside the library
+#if defined(__GNUC__)
+#define SIMPLESAT_API __attribute__((visibility("default")))
+#else
+#define SIMPLESAT_API
+#endif
+
+// An incremental solver, in the style of IPASIR: clauses keep
+// being added between calls to `simplesat_solve`, and whatever
+// has been learned about the earlier clauses is kept
+typedef struct SimpleSAT SimpleSAT;
+
+// Literals are nonzero integers as in DIMACS, where variables
+// are numbered from 1 and negative numbers are negations
+typedef enum
+{
+    SIMPLESAT_UNKNOWN = 0,
+    SIMPLESAT_SATISFIABLE = 10,
+    SIMPLESAT_UNSATISFIABLE = 20
+}
+SimpleSATResult;
+
+SIMPLESAT_API SimpleSAT *simplesat_create(void);
+SIMPLESAT_API void simplesat_delete(SimpleSAT *);
+
+// Adds a literal to the clause being built, or finishes it when
+// the literal is 0; variables are created as they are mentioned
+SIMPLESAT_API void simplesat_add(SimpleSAT *, int);
+
+// Makes a literal true for the next call to `simplesat_solve` only
+SIMPLESAT_API void simplesat_assume(SimpleSAT *, int);
+
+SIMPLESAT_API SimpleSATResult simplesat_solve(SimpleSAT *);
+
+// After a satisfiable result, gives the literal if it is true
+// in the model and its negation if it is false, or 0 for
+// variables no clause or assumption has ever mentioned
+SIMPLESAT_API int simplesat_value(const SimpleSAT *, int);
+
+// After an unsatisfiable result, tells whether the assumption
+// of the literal is among those that made the search fail
+SIMPLESAT_API bool simplesat_failed(const SimpleSAT *, int);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
@@ -2,11 +2,26 @@
 #include "solver.h"
 
 #include <assert.h>
+#include <limits.h>
 #include <stdbool.h>
-#include <time.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
+#include "constants.h"
 #include "error.h"
+#include "gauss.h"
+#include "inprocess.h"
+#include "preprocess.h"
+#include "progress.h"
+#include "proof.h"
 #include "utils.h"
+#include "walk.h"
+
+// The clock and the memory usage cost more to read than a step
+// of the search, so they are only looked at this often
+#define POLL_PERIOD 1024
 
 Literal negate(Literal lit)
 {
@@ -33,458 +48,2323 @@ int int_from_lit(Literal lit)
     }
 }
 
-void create_clause_state(ClauseState *cstate)
+unsigned int var_from_lit(Literal lit)
 {
-    cstate->n_lits = 0;
-    cstate->c_lits = 4;
-    CREATE_ARRAY(cstate->lits, 4);
-
-    cstate->n_assigned_true = 0;
-    cstate->n_assigned_false = 0;
-    cstate->n_free_lits = 0;
+    // Both polarities share the same variable
+    return lit >> 1;
 }
 
-void delete_clause_state(ClauseState *cstate)
+void create_lit_state(LitState *lstate)
 {
-    DELETE_ARRAY(cstate->lits);
-}
+    lstate->score = 0;
 
-void add_literal(ClauseState *cstate, Literal lit)
-{
-    if (cstate->n_lits == cstate->c_lits) {
-        cstate->c_lits *= 2;
-        RESIZE_ARRAY(cstate->lits, cstate->c_lits);
-    }
+    // Watch lists are set up once all clauses are known
+    lstate->n_watches = 0;
+    lstate->c_watches = 0;
+    lstate->watches = NULL;
 
-    cstate->lits[cstate->n_lits++] = lit;
-    cstate->n_free_lits += 1;
+    lstate->n_binaries = 0;
+    lstate->c_binaries = 0;
+    lstate->binaries = NULL;
 }
 
-void create_lit_state(LitState *lstate)
+void default_config(SolverConfig *config)
 {
-    lstate->fixed = false;
-    lstate->assigned = false;
-
-    lstate->score = 0;
+    config->search = SEARCH_CDCL;
+    config->branching = BRANCH_VSIDS;
+    config->preprocess = true;
+    config->activity_decay = 0.95;
+    config->gauss = true;
+
+    config->restarts = RESTART_LUBY;
+    config->luby_unit = 100;
+    config->lbd_window = 50;
+    config->restart_margin = 0.8;
+
+    config->phase_saving = true;
+    config->initial_phase = PHASE_NEGATIVE;
+    config->seed = 0;
+
+    config->walk = WALK_PROBSAT;
+    config->walk_interval = 0;
+    config->walk_flips = 100000;
+
+    config->inprocess_interval = 5000;
+    config->inprocess_effort = 0.02;
+
+    config->reduce_interval = 2000;
+    config->reduce_increment = 300;
+    config->glue_lbd = 2;
+    config->reduce_fraction = 0.5;
+
+    config->share_clauses = true;
+    config->share_max_lits = 8;
+    config->share_max_lbd = 3;
+    config->share_import_limit = 1000;
+
+    config->max_conflicts = 0;
+    config->max_propagations = 0;
+    config->max_seconds = 0.0;
+    config->max_memory = 0;
+
+    config->report_interval = 0.0;
+}
 
-    lstate->n_cont_clauses = 0;
-    lstate->c_cont_clauses = 16;
-    CREATE_ARRAY(lstate->cont_clauses, 16);
+static uint64_t arena_words(const Problem *problem)
+{
+    // Room for a few learned clauses to begin with
+    return (uint64_t) CLAUSE_WORDS(0) * problem->n_clauses +
+           problem->n_lits + CLAUSE_WORDS(4) * 16;
 }
 
-void delete_lit_state(LitState *lstate)
+static void arena_overflow(void)
 {
-    DELETE_ARRAY(lstate->cont_clauses);
+    fprintf(stderr, PROGRAM_NAME ": Clause arena is full\n");
+    abort();
 }
 
-void add_cont_clause(LitState *lstate, ClauseState *cstate)
+bool fits_in_arena(const Problem *problem)
 {
-    if (lstate->n_cont_clauses == lstate->c_cont_clauses) {
-        lstate->c_cont_clauses *= 2;
-        RESIZE_ARRAY(lstate->cont_clauses, lstate->c_cont_clauses);
-    }
+    // Both polarities of every variable must have a literal
+    return problem->n_vars <= UINT_MAX / 2 &&
+           arena_words(problem) <= OFFSET_MAX;
+}
 
-    lstate->cont_clauses[lstate->n_cont_clauses++] = cstate;
+void create_solver(Solver *solver, const Problem *problem)
+{
+    create_region(&solver->own_region);
+    create_solver_in(solver, problem, &solver->own_region);
 }
 
-void create_solver(Solver *solver,
-                   unsigned int num_vars,
-                   unsigned int num_clauses)
+void create_solver_in(Solver *solver, const Problem *problem, Region *region)
 {
+    unsigned int num_vars = problem->n_vars;
+    unsigned int num_clauses = problem->n_clauses;
     unsigned int i;
-    unsigned int max_unit_props;
+    unsigned int j;
+
+    // The reader turns away any problem that does not fit
+    if (! fits_in_arena(problem)) {
+        arena_overflow();
+    }
 
-    // There must be at least one variable
-    // However there CAN be zero clauses
-    assert(num_vars > 0);
+    solver->region = region;
 
     solver->n_vars = num_vars;
-    CREATE_ARRAY(solver->lits, num_vars << 1);
+    solver->c_vars = num_vars;
+    REGION_CREATE(region, solver->lits, num_vars << 1);
+    REGION_CREATE(region, solver->values, num_vars << 1);
     for (i = 0; i < (num_vars << 1); ++i) {
         create_lit_state(&solver->lits[i]);
+        solver->values[i] = VALUE_UNSET;
+    }
+
+    REGION_CREATE(region, solver->vars, num_vars);
+    for (i = 0; i < num_vars; ++i) {
+        solver->vars[i].level = 0;
+        solver->vars[i].reason = CLAUSE_NONE;
+        solver->vars[i].seen = false;
+        solver->vars[i].phase = PHASE_UNSET;
+        solver->vars[i].eliminated = false;
     }
 
-    solver->n_clauses = num_clauses;
-    CREATE_ARRAY(solver->clauses, num_clauses);
+    // Leave some room for learned clauses,
+    // the arena will grow if it runs out; clauses carry
+    // no identifiers until a proof asks for them
+    solver->n_arena = 0;
+    solver->proof_words = 0;
+    solver->c_arena = (Offset) arena_words(problem);
+    REGION_CREATE(region, solver->arena, solver->c_arena);
+
+    solver->n_clauses = 0;
+    solver->c_clauses = num_clauses + 16;
+    REGION_CREATE(region, solver->clauses, solver->c_clauses);
+
+    // The problem has already dropped any repeated literals
     for (i = 0; i < num_clauses; ++i) {
-        create_clause_state(&solver->clauses[i]);
+
+        Offset start = problem->clause_starts[i];
+        unsigned int num_lits =
+            (unsigned int) (problem->clause_starts[i + 1] - start);
+        ClauseRef ref = alloc_clause(solver, num_lits);
+        ClauseState *cstate = get_clause(solver, ref);
+
+        for (j = 0; j < num_lits; ++j) {
+            cstate->lits[j] = problem->lits[start + j];
+        }
+        solver->clauses[solver->n_clauses++] = ref;
     }
 
-    solver->n_sat_clauses = 0;
-    solver->n_unsat_clauses = 0;
+    solver->building = CLAUSE_NONE;
+    REGION_CREATE(region, solver->lit_marks, num_vars << 1);
+    for (i = 0; i < (num_vars << 1); ++i) {
+        solver->lit_marks[i] = false;
+    }
+
+    solver->n_eliminated = 0;
+    solver->n_elim_lits = 0;
+    solver->c_elim_lits = 0;
+    solver->elim_lits = NULL;
+
+    create_xor_matrix(&solver->xors);
+
+    solver->n_learnts = 0;
+    solver->c_learnts = 16;
+    REGION_CREATE(region, solver->learnts, 16);
+
+    solver->watch_pool = NULL;
+    solver->c_watch_pool = 0;
+
+    solver->next_reduce = 0;
+    solver->reduce_interval = 0;
+
+    solver->next_walk = UINT64_MAX;
 
-    solver->n_units = 0;
-    max_unit_props = (solver->n_vars << 1) + solver->n_clauses;
-    CREATE_ARRAY(solver->unit_stack, max_unit_props);
+    solver->next_inprocess = UINT64_MAX;
+    solver->inprocess_props = 0;
+    solver->probe_cursor = 0;
+
+    solver->stop = NULL;
+
+    solver->deadline = 0.0;
+    solver->poll_countdown = 0;
+
+    solver->worker = 0;
+
+    solver->report_start = 0.0;
+    solver->next_report = 0.0;
+    solver->n_report_requests = 0;
+    solver->last_report_time = 0.0;
+    solver->last_report_props = 0;
+
+    solver->exchange = NULL;
+    solver->exchange_index = 0;
+    solver->import_cursors = NULL;
+
+    default_config(&solver->config);
 
     solver->n_assigned = 0;
-    CREATE_ARRAY(solver->assigned, solver->n_vars << 1);
+    solver->n_propagated = 0;
+    REGION_CREATE(region, solver->assigned, solver->n_vars);
+
+    solver->n_levels = 0;
+    // Assumptions that are already implied take up a level
+    // of their own, so there can be as many levels again
+    REGION_CREATE(region, solver->level_starts, 2 * solver->n_vars + 1);
+    REGION_CREATE(region, solver->level_flipped, 2 * solver->n_vars + 1);
+
+    // Each variable may be assumed in both polarities
+    solver->n_assumptions = 0;
+    REGION_CREATE(region, solver->assumptions, 2 * solver->n_vars);
+
+    solver->n_failed = 0;
+    REGION_CREATE(region, solver->failed, 2 * solver->n_vars + 1);
+
+    REGION_CREATE(region, solver->activity, solver->n_vars);
+    for (i = 0; i < solver->n_vars; ++i) {
+        solver->activity[i] = 0.0;
+    }
+    solver->activity_inc = 1.0;
+    create_heap(&solver->order, solver->n_vars, solver->activity);
+
+    solver->n_learnt_lits = 0;
+    REGION_CREATE(region, solver->learnt_lits, solver->n_vars);
+
+    solver->lbd_stamp = 0;
+    REGION_CREATE(region, solver->level_stamps, 2 * solver->n_vars + 1);
+    for (i = 0; i <= 2 * solver->n_vars; ++i) {
+        solver->level_stamps[i] = 0;
+    }
+
+    solver->proof = NULL;
+    solver->unit_ids = NULL;
+    solver->n_proved_units = 0;
+    solver->hint_level = 0;
+    solver->n_hints = 0;
+    solver->hints = NULL;
+
+    solver->started = false;
+    solver->inconsistent = false;
 
     solver->solution = SOLUTION_UNKNOWN;
+    solver->parse_time = 0.0;
     solver->start_time = 0.0;
     solver->stop_time = 0.0;
+    solver->preprocess_time = 0.0;
     solver->t_branches = 0;
     solver->t_unit_props = 0;
+    solver->t_conflicts = 0;
+    solver->t_restarts = 0;
+    solver->t_flips = 0;
+    solver->t_failed = 0;
+    solver->t_hyper = 0;
+    solver->t_vivified = 0;
+    solver->t_deleted = 0;
+    solver->t_removed = 0;
+    solver->t_exported = 0;
+    solver->t_imported = 0;
 }
 
 void delete_solver(Solver *solver)
 {
-    unsigned int i;
-
-    for (i = 0; i < (solver->n_vars << 1); ++i) {
-        delete_lit_state(&solver->lits[i]);
-    }
-
-    for (i = 0; i < solver->n_clauses; ++i) {
-        delete_clause_state(&solver->clauses[i]);
+    // Everything else goes along with the region at once,
+    // or when the one that lent it resets it
+    if (solver->region == &solver->own_region) {
+        delete_region(&solver->own_region);
     }
 
-    DELETE_ARRAY(solver->lits);
-    DELETE_ARRAY(solver->clauses);
-    DELETE_ARRAY(solver->unit_stack);
-    DELETE_ARRAY(solver->assigned);
+    delete_xor_matrix(&solver->xors);
+    delete_heap(&solver->order);
 }
 
-void add_literal_to_clause(Solver *solver,
-                           ClauseState *cstate,
-                           Literal lit)
+static uint64_t clause_id(const Solver *solver, ClauseRef ref)
 {
-    unsigned int i;
+    uint64_t id;
 
-    // Make sure the clause has at most one copy of each literal.
-    // This property is required for the correctness of optimizations
-    // in later solver functions.
-    for (i = 0; i < cstate->n_lits; ++i) {
-        if (cstate->lits[i] == lit) {
-            return;
-        }
-    }
+    // The identifier sits just before the header, where
+    // it need not be aligned for a 64-bit value
+    memcpy(&id, &solver->arena[ref - solver->proof_words], sizeof(id));
+    return id;
+}
 
-    add_literal(cstate, lit);
-    add_cont_clause(&solver->lits[lit], cstate);
+static void set_clause_id(Solver *solver, ClauseRef ref, uint64_t id)
+{
+    memcpy(&solver->arena[ref - solver->proof_words], &id, sizeof(id));
 }
 
-Literal choose_branch(Solver *solver)
+void attach_proof(Solver *solver, Proof *proof)
 {
-    Literal lit;
-    Literal best_lit;
-    unsigned int score;
-    unsigned int best_score;
+    Literal *arena;
+    Offset n_arena;
+    uint64_t c_arena;
+    unsigned int words;
+    unsigned int i;
+    unsigned int j;
 
-    assert(solver->n_assigned != solver->n_vars);
-    assert(solver->n_sat_clauses != solver->n_clauses);
+    assert(! solver->started);
 
-    update_scores(solver);
+    solver->proof = proof;
+    if (proof->format != PROOF_LRAT) {
+        return;
+    }
 
-    // Should always be overwritten
-    best_lit = 0;
-    best_score = 0;
+    assert(solver->config.search == SEARCH_CDCL);
+    assert(! solver->config.preprocess);
 
-    for (lit = 0; lit < (solver->n_vars << 1); lit += 2) {
+    /*
+     * 1. Make room for an identifier before every clause
+     */
 
-        unsigned int a;
-        unsigned int b;
+    solver->proof_words = sizeof(uint64_t) / sizeof(Literal);
 
-        // Skip assigned literals
-        if (solver->lits[lit].fixed) {
-            continue;
+    n_arena = 0;
+    c_arena = solver->c_arena +
+              (uint64_t) solver->proof_words * solver->n_clauses;
+    if (c_arena > OFFSET_MAX) {
+        arena_overflow();
+    }
+    REGION_CREATE(solver->region, arena, c_arena);
+
+    // The clauses of the problem are numbered in the order given
+    for (i = 0; i < solver->n_clauses; ++i) {
+        ClauseRef ref = solver->clauses[i];
+        words = CLAUSE_WORDS(get_clause(solver, ref)->n_lits);
+        n_arena += solver->proof_words;
+        for (j = 0; j < words; ++j) {
+            arena[n_arena + j] = solver->arena[ref + j];
         }
+        solver->clauses[i] = n_arena;
+        n_arena += words;
+    }
 
-        // Calculate the score for this literal pair
-        a = solver->lits[lit].score;
-        b = solver->lits[negate(lit)].score;
-        score = (a + 1) * (b + 1); 
+    REGION_DELETE(solver->region, solver->arena);
+    solver->arena = arena;
+    solver->n_arena = n_arena;
+    solver->c_arena = (Offset) c_arena;
 
-        if (score > best_score) {
-            best_score = score;
-            // Choose the higher-scoring of the pair
-            if (a >= b) {
-                best_lit = lit;
-            } else {
-                best_lit = negate(lit);
-            }
-        }
+    for (i = 0; i < solver->n_clauses; ++i) {
+        set_clause_id(solver, solver->clauses[i], proof->next_id++);
     }
 
-    return best_lit;
+    /*
+     * 2. Keep track of the unit clause behind each assignment
+     */
+
+    REGION_CREATE(solver->region, solver->unit_ids, solver->c_vars);
+    for (i = 0; i < solver->c_vars; ++i) {
+        solver->unit_ids[i] = 0;
+    }
+
+    // Every variable is resolved on at most once, and
+    // then the conflicting clause comes last
+    REGION_CREATE(solver->region, solver->hints, solver->c_vars + 1);
 }
 
-void update_scores(Solver *solver)
+void reserve_vars(Solver *solver, unsigned int num_vars)
 {
-    Literal lit;
+    unsigned int c_vars = solver->c_vars;
     unsigned int i;
 
-    // Set all scores to zero
-    for (lit = 0; lit < (solver->n_vars << 1); ++lit) {
-        solver->lits[lit].score = 0;
+    if (num_vars <= solver->n_vars) {
+        return;
     }
 
-    for (lit = 0; lit < (solver->n_vars << 1); ++lit) {
-
-        LitState *lstate = &solver->lits[lit];
+    /*
+     * 1. Grow every per-variable array
+     */
 
-        // Skip literals that have been given a value
-        if (lstate->fixed) {
-            continue;
+    // Variables usually arrive one at a time,
+    // so leave room for more of them
+    if (num_vars > c_vars) {
+
+        c_vars = 2 * c_vars > num_vars ? 2 * c_vars : num_vars;
+
+        // Watch lists keep pointing into the same pool,
+        // since the literal states are only copied
+        REGION_RESIZE(solver->region, solver->lits, c_vars << 1);
+        REGION_RESIZE(solver->region, solver->values, c_vars << 1);
+        REGION_RESIZE(solver->region, solver->vars, c_vars);
+        REGION_RESIZE(solver->region, solver->lit_marks, c_vars << 1);
+        REGION_RESIZE(solver->region, solver->assigned, c_vars);
+        REGION_RESIZE(solver->region, solver->level_starts, 2 * c_vars + 1);
+        REGION_RESIZE(solver->region, solver->level_flipped, 2 * c_vars + 1);
+        REGION_RESIZE(solver->region, solver->assumptions, 2 * c_vars);
+        REGION_RESIZE(solver->region, solver->failed, 2 * c_vars + 1);
+        REGION_RESIZE(solver->region, solver->activity, c_vars);
+        REGION_RESIZE(solver->region, solver->learnt_lits, c_vars);
+        REGION_RESIZE(solver->region, solver->level_stamps, 2 * c_vars + 1);
+        resize_heap(&solver->order, c_vars, solver->activity);
+
+        for (i = 2 * solver->c_vars + 1; i <= 2 * c_vars; ++i) {
+            solver->level_stamps[i] = 0;
         }
 
-        for (i = 0; i < lstate->n_cont_clauses; ++i) {
+        if (solver->unit_ids != NULL) {
+            REGION_RESIZE(solver->region, solver->unit_ids, c_vars);
+            REGION_RESIZE(solver->region, solver->hints, c_vars + 1);
+        }
 
-            ClauseState *cstate = lstate->cont_clauses[i];
+        solver->c_vars = c_vars;
+    }
 
-            // Skip clauses that have been satisfied
-            if (cstate->n_assigned_true != 0) {
-                continue;
-            }
+    /*
+     * 2. Set up the new variables
+     */
 
-            switch (cstate->n_free_lits) {
+    for (i = solver->n_vars << 1; i < (num_vars << 1); ++i) {
+        create_lit_state(&solver->lits[i]);
+        solver->values[i] = VALUE_UNSET;
+        solver->lit_marks[i] = false;
+    }
 
-            case 2:
-                lstate->score += 4;
-                break;
+    for (i = solver->n_vars; i < num_vars; ++i) {
 
-            case 3:
-                lstate->score += 2;
-                break;
+        solver->vars[i].level = 0;
+        solver->vars[i].reason = CLAUSE_NONE;
+        solver->vars[i].seen = false;
+        solver->vars[i].phase = PHASE_UNSET;
+        solver->vars[i].eliminated = false;
+        solver->activity[i] = 0.0;
 
-            // All further cases must be 4 or more
-            default:
-                lstate->score += 1;
-                break;
+        if (solver->unit_ids != NULL) {
+            solver->unit_ids[i] = 0;
+        }
 
-            }
+        // Variables only enter the order once the search begins
+        if (solver->started &&
+            solver->config.branching == BRANCH_VSIDS) {
+            heap_insert(&solver->order, i);
         }
     }
+
+    solver->n_vars = num_vars;
 }
 
-void add_true_assignment(Solver *solver, ClauseState *cstate)
+ClauseState *get_clause(const Solver *solver, ClauseRef ref)
 {
-    assert(cstate->n_free_lits > 0);
+    return (ClauseState *) &solver->arena[ref];
+}
 
-    // If this clause is just now being satisfied,
-    // increment the number of satisfied clauses
-    if (cstate->n_assigned_true == 0) {
-        solver->n_sat_clauses += 1;
+static void reserve_arena(Solver *solver, uint64_t num_words)
+{
+    if (num_words > OFFSET_MAX) {
+        arena_overflow();
     }
 
-    cstate->n_assigned_true += 1;
-    cstate->n_free_lits -= 1;
+    // Doubling stops at the largest size that offsets can reach
+    while (num_words > solver->c_arena) {
+        solver->c_arena = solver->c_arena <= OFFSET_MAX / 2 ?
+                          2 * solver->c_arena : OFFSET_MAX;
+    }
+    REGION_RESIZE(solver->region, solver->arena, solver->c_arena);
 }
 
-void add_false_assignment(Solver *solver, ClauseState *cstate)
+ClauseRef alloc_clause(Solver *solver, unsigned int num_lits)
 {
-    assert(cstate->n_free_lits > 0);
-
-    // If this clause is just now becoming a contradiction,
-    // increment the number of contradictions
-    if (cstate->n_assigned_true == 0 && cstate->n_free_lits == 1) {
-        solver->n_unsat_clauses += 1;
+    ClauseRef ref;
+    ClauseState *cstate;
+    unsigned int words = solver->proof_words + CLAUSE_WORDS(num_lits);
+
+    // This may move the arena, so any pointers
+    // to clauses are invalid after calling this
+    if ((uint64_t) solver->n_arena + words > solver->c_arena) {
+        reserve_arena(solver, (uint64_t) solver->n_arena + words);
     }
 
-    cstate->n_assigned_false += 1;
-    cstate->n_free_lits -= 1;
+    ref = solver->n_arena + solver->proof_words;
+    solver->n_arena += words;
+
+    cstate = get_clause(solver, ref);
+    cstate->n_lits = num_lits;
+    cstate->learnt = 0;
+    cstate->deleted = 0;
+    cstate->moved = 0;
+    cstate->vivified = 0;
+    cstate->lbd = 0;
+
+    return ref;
+}
+
+void add_clause(Solver *solver, const Literal *lits, unsigned int num_lits)
+{
+    unsigned int i;
 
-    // If this is a new unit clause, add it to the stack
-    if (cstate->n_assigned_true == 0 && cstate->n_free_lits == 1) {
-        Literal unit = get_unit(solver, cstate);
-        solver->unit_stack[solver->n_units++] = unit;
+    start_clause(solver);
+    for (i = 0; i < num_lits; ++i) {
+        push_literal(solver, lits[i]);
     }
+    finish_clause(solver);
 }
 
-void undo_true_assignment(Solver *solver, ClauseState *cstate)
+void start_clause(Solver *solver)
 {
-    assert(cstate->n_free_lits < cstate->n_lits);
+    assert(solver->building == CLAUSE_NONE);
+
+    // The clause grows at the end of the arena until it is finished
+    solver->building = alloc_clause(solver, 0);
+}
 
-    cstate->n_assigned_true -= 1;
-    cstate->n_free_lits += 1;
+void push_literal(Solver *solver, Literal lit)
+{
+    assert(solver->building != CLAUSE_NONE);
 
-    // If this clause just stopped being satisfied,
-    // decrement the number of satisfied clauses
-    if (cstate->n_assigned_true == 0) {
-        solver->n_sat_clauses -= 1;
+    if (solver->n_arena == solver->c_arena) {
+        reserve_arena(solver, (uint64_t) solver->n_arena + 1);
     }
+
+    solver->arena[solver->n_arena++] = lit;
 }
 
-void undo_false_assignment(Solver *solver, ClauseState *cstate)
+void finish_clause(Solver *solver)
 {
-    assert(cstate->n_free_lits < cstate->n_lits);
+    ClauseRef ref = solver->building;
+    ClauseState *cstate = get_clause(solver, ref);
+    Literal *lits = cstate->lits;
+    unsigned int num_lits =
+        (unsigned int) (solver->n_arena - ref - CLAUSE_WORDS(0));
+    unsigned int i;
+    unsigned int j;
+
+    // Make sure the clause has at most one copy of each literal.
+    // The two watched literals of a clause must be distinct,
+    // otherwise a clause could lose both its watches at once.
+    for (i = j = 0; i < num_lits; ++i) {
+        if (! solver->lit_marks[lits[i]]) {
+            solver->lit_marks[lits[i]] = true;
+            lits[j++] = lits[i];
+        }
+    }
+
+    for (i = 0; i < j; ++i) {
+        solver->lit_marks[lits[i]] = false;
+    }
 
-    cstate->n_assigned_false -= 1;
-    cstate->n_free_lits += 1;
+    // Give back the space of any duplicates
+    cstate->n_lits = j;
+    solver->n_arena = ref + CLAUSE_WORDS(j);
+    solver->building = CLAUSE_NONE;
 
-    // If this clause just stopped being a contradiction,
-    // decrement the number of contradictions
-    if (cstate->n_assigned_true == 0 && cstate->n_free_lits == 1) {
-        solver->n_unsat_clauses -= 1;
+    if (solver->n_clauses == solver->c_clauses) {
+        solver->c_clauses *= 2;
+        REGION_RESIZE(solver->region, solver->clauses, solver->c_clauses);
     }
+    solver->clauses[solver->n_clauses++] = ref;
 }
 
-Literal get_unit(const Solver *solver, const ClauseState *cstate)
+void insert_clause(Solver *solver, const Literal *lits, unsigned int num_lits)
 {
+    ClauseRef ref;
+    ClauseState *cstate;
+    bool satisfied;
+    unsigned int n_lits;
     unsigned int i;
-    Literal lit;
 
-    // The correctness of this function depends on the guarantee that each
-    // clause contains at most one copy of each literal. If it is possible
-    // for a clause to contain two of the same literal, then a situation may
-    // arise in which `get_unit` is called on a clause where all literals are
-    // false, but the number of free literals has not been decremented yet.
+    // Until the search begins, clauses can simply be stored
+    if (! solver->started) {
+        add_clause(solver, lits, num_lits);
+        return;
+    }
+
+    assert(solver->n_eliminated == 0);
+
+    backtrack(solver, 0);
+    if (solver->inconsistent) {
+        return;
+    }
+
+    /*
+     * 1. Drop repeated literals and those already false
+     */
 
-    assert(cstate->n_free_lits == 1);
-    assert(cstate->n_assigned_true == 0);
+    ref = alloc_clause(solver, num_lits);
+    cstate = get_clause(solver, ref);
 
-    for (i = 0; i < cstate->n_lits; ++i) {
-        lit = cstate->lits[i];
-        // The first unassigned literal must be the unit
-        if (solver->lits[lit].fixed == false) {
-            return lit;
+    satisfied = false;
+    n_lits = 0;
+    for (i = 0; i < num_lits; ++i) {
+
+        Literal lit = lits[i];
+
+        assert(var_from_lit(lit) < solver->n_vars);
+
+        if (solver->lit_marks[lit]) {
+            continue;
+        } else if (solver->lit_marks[negate(lit)] ||
+                   solver->values[lit] == VALUE_TRUE) {
+            satisfied = true;
+            break;
+        } else if (solver->values[lit] == VALUE_UNSET) {
+            solver->lit_marks[lit] = true;
+            cstate->lits[n_lits++] = lit;
         }
     }
 
-    // Should be unreachable
-    return -1;
-}
+    for (i = 0; i < n_lits; ++i) {
+        solver->lit_marks[cstate->lits[i]] = false;
+    }
 
-void make_assignment(Solver *solver, Literal lit)
-{
-    unsigned int i;
-    LitState *lstate = &solver->lits[lit];
-    LitState *nlstate = &solver->lits[negate(lit)];
+    // Give back the space of anything dropped
+    cstate->n_lits = n_lits;
+    solver->n_arena = ref + CLAUSE_WORDS(n_lits);
 
-    // Make sure the variable is not assigned
-    assert(lstate->fixed == false);
-    assert(nlstate->fixed == false);
+    /*
+     * 2. Keep the clause, unless it is already decided
+     */
 
-    // This must happen before unit propagation
-    // to ensure the correct literal is selected
-    lstate->fixed = true;
-    lstate->assigned = true;
-    nlstate->fixed = true;
-    nlstate->assigned = false;
+    if (satisfied) {
+        solver->n_arena = ref - solver->proof_words;
+        return;
+    } else if (n_lits == 0) {
+        solver->n_arena = ref - solver->proof_words;
+        solver->inconsistent = true;
+        return;
+    } else if (n_lits == 1) {
+        // The next search propagates the unit first
+        solver->n_arena = ref - solver->proof_words;
+        assign_literal(solver, cstate->lits[0], CLAUSE_NONE);
+        return;
+    }
 
-    // Add a true assignment to each clause in which
-    // this literal appears unnegated
-    for (i = 0; i < lstate->n_cont_clauses; ++i) {
-        ClauseState *cstate = lstate->cont_clauses[i];
-        add_true_assignment(solver, cstate);
+    if (solver->n_clauses == solver->c_clauses) {
+        solver->c_clauses *= 2;
+        REGION_RESIZE(solver->region, solver->clauses, solver->c_clauses);
     }
+    solver->clauses[solver->n_clauses++] = ref;
+
+    // Nothing in the clause is assigned, so any two literals will do
+    watch_clause(solver, ref);
+}
 
-    // Add a false assignment to each clause in which
-    // this literal appears negated
-    for (i = 0; i < nlstate->n_cont_clauses; ++i) {
-        ClauseState *cstate = nlstate->cont_clauses[i];
-        add_false_assignment(solver, cstate);
+static void push_watch(Solver *solver,
+                       Watch **list,
+                       unsigned int *n_list,
+                       unsigned int *c_list,
+                       ClauseRef ref,
+                       Literal blocker)
+{
+    if (*n_list == *c_list) {
+
+        Watch *watches = *list;
+        unsigned int i;
+
+        // Lists in the pool cannot be resized in place,
+        // so they move to their own allocation instead
+        *c_list = *c_list ? *c_list * 2 : 4;
+        if (watches >= solver->watch_pool &&
+            watches < solver->watch_pool + solver->c_watch_pool) {
+            REGION_CREATE(solver->region, *list, *c_list);
+            for (i = 0; i < *n_list; ++i) {
+                (*list)[i] = watches[i];
+            }
+        } else {
+            REGION_RESIZE(solver->region, *list, *c_list);
+        }
     }
+
+    (*list)[*n_list].clause = ref;
+    (*list)[*n_list].blocker = blocker;
+    *n_list += 1;
 }
 
-void undo_assignment(Solver *solver, Literal lit)
+void add_watch(Solver *solver, Literal lit, ClauseRef ref, Literal blocker)
 {
-    unsigned int i;
     LitState *lstate = &solver->lits[lit];
-    LitState *nlstate = &solver->lits[negate(lit)];
 
-    // Make sure the variable is assigned true
-    assert(lstate->fixed == true);
-    assert(lstate->assigned == true);
-    assert(nlstate->fixed == true);
-    assert(nlstate->assigned == false);
+    push_watch(solver, &lstate->watches,
+               &lstate->n_watches, &lstate->c_watches, ref, blocker);
+}
 
-    // Undo this variable's true assignments
-    for (i = 0; i < lstate->n_cont_clauses; ++i) {
-        ClauseState *cstate = lstate->cont_clauses[i];
-        undo_true_assignment(solver, cstate);
-    }
+void add_binary(Solver *solver, Literal lit, ClauseRef ref, Literal other)
+{
+    LitState *lstate = &solver->lits[lit];
 
-    // Undo this variable's false assignments
-    for (i = 0; i < nlstate->n_cont_clauses; ++i) {
-        ClauseState *cstate = nlstate->cont_clauses[i];
-        undo_false_assignment(solver, cstate);
-    }
+    push_watch(solver, &lstate->binaries,
+               &lstate->n_binaries, &lstate->c_binaries, ref, other);
+}
+
+void watch_clause(Solver *solver, ClauseRef ref)
+{
+    ClauseState *cstate = get_clause(solver, ref);
+    Literal first = cstate->lits[0];
+    Literal second = cstate->lits[1];
+
+    assert(cstate->n_lits >= 2);
 
-    lstate->fixed = false;
-    nlstate->fixed = false;
+    if (cstate->n_lits == 2) {
+        add_binary(solver, first, ref, second);
+        add_binary(solver, second, ref, first);
+    } else {
+        add_watch(solver, first, ref, second);
+        add_watch(solver, second, ref, first);
+    }
 }
 
-Solution search_assignments(Solver *solver)
+void attach_watches(Solver *solver)
 {
-    Solution solution;
-    Literal branch;
+    Literal lit;
+    unsigned int i;
+    unsigned int offset;
 
-    if (any_contradiction(solver)) {
-        return SOLUTION_UNSATISFIABLE;
-    } else if (all_satisfied(solver)) {
-        return SOLUTION_SATISFIABLE;
+    /*
+     * 1. Count the watches of each literal
+     */
+
+    for (i = 0; i < solver->n_clauses; ++i) {
+        ClauseState *cstate = get_clause(solver, solver->clauses[i]);
+        if (cstate->n_lits == 2) {
+            solver->lits[cstate->lits[0]].c_binaries += 1;
+            solver->lits[cstate->lits[1]].c_binaries += 1;
+        } else if (cstate->n_lits > 2) {
+            solver->lits[cstate->lits[0]].c_watches += 1;
+            solver->lits[cstate->lits[1]].c_watches += 1;
+        }
     }
 
-    branch = choose_branch(solver);
+    /*
+     * 2. Give each literal a slice of one large block
+     */
 
-    solution = try_assignment(solver, branch);
-    if (solution != SOLUTION_UNSATISFIABLE) {
-        return solution;
+    // Leave room to pick up as many watches again
+    // before the list has to move out of the pool
+    solver->c_watch_pool = 0;
+    for (lit = 0; lit < (solver->n_vars << 1); ++lit) {
+        LitState *lstate = &solver->lits[lit];
+        lstate->c_watches = 2 * lstate->c_watches + 2;
+        lstate->c_binaries = 2 * lstate->c_binaries + 2;
+        solver->c_watch_pool += lstate->c_watches + lstate->c_binaries;
     }
+    REGION_CREATE(solver->region, solver->watch_pool, solver->c_watch_pool);
 
-    solution = try_assignment(solver, negate(branch));
-    if (solution != SOLUTION_UNSATISFIABLE) {
-        return solution;
+    offset = 0;
+    for (lit = 0; lit < (solver->n_vars << 1); ++lit) {
+        LitState *lstate = &solver->lits[lit];
+        lstate->watches = &solver->watch_pool[offset];
+        offset += lstate->c_watches;
+        lstate->binaries = &solver->watch_pool[offset];
+        offset += lstate->c_binaries;
     }
 
-    return SOLUTION_UNSATISFIABLE;
+    /*
+     * 3. Watch the first two literals of each clause
+     */
+
+    for (i = 0; i < solver->n_clauses; ++i) {
+        ClauseRef ref = solver->clauses[i];
+        if (get_clause(solver, ref)->n_lits >= 2) {
+            watch_clause(solver, ref);
+        }
+    }
 }
 
-Solution try_assignment(Solver *solver, Literal branch)
+Literal choose_branch(Solver *solver)
 {
-    Solution solution;
-    unsigned int prev_n_assigned;
+    Literal best_lit;
 
-    /*
-     * 1. Assign branch and do unit propagation
-     */
+    assert(solver->n_assigned + solver->n_eliminated != solver->n_vars);
 
-    prev_n_assigned = solver->n_assigned;
+    if (solver->config.branching == BRANCH_VSIDS) {
 
-    solver->t_branches += 1;
-    solver->assigned[solver->n_assigned++] = branch;
-    make_assignment(solver, branch);
+        unsigned int var;
+
+        // Assigned variables are only removed lazily from the heap
+        do {
+            var = heap_pop(&solver->order);
+        } while (solver->values[var << 1] != VALUE_UNSET);
+
+        switch (solver->vars[var].phase) {
+
+        case PHASE_POSITIVE:
+            return var << 1;
+
+        case PHASE_NEGATIVE:
+            return (var << 1) | 1;
+
+        case PHASE_UNSET:
+            break;
 
-    while (solver->n_units > 0) {
-        Literal unit = solver->unit_stack[--solver->n_units];
-        if (! solver->lits[unit].fixed) {
-            solver->t_unit_props += 1;
-            solver->assigned[solver->n_assigned++] = unit;
-            make_assignment(solver, unit);
-        } else if (! solver->lits[unit].assigned) {
-            // If a false unit has been derived,
-            // the formula is unsatisfiable
-            solution = SOLUTION_UNSATISFIABLE;
-            solver->n_units = 0;
-            goto backtrack;
+        }
+
+        if (solver->config.initial_phase == PHASE_POSITIVE) {
+            return var << 1;
+        } else {
+            return (var << 1) | 1;
         }
     }
 
-    /*
-     * 2. Recursively search for a valid assignment.
-     */
+    best_lit = choose_lookahead(solver);
+
+    // A saved phase takes precedence over the scores
+    switch (solver->vars[var_from_lit(best_lit)].phase) {
+
+    case PHASE_POSITIVE:
+        return best_lit & ~1u;
+
+    case PHASE_NEGATIVE:
+        return best_lit | 1;
+
+    case PHASE_UNSET:
+        break;
 
-    solution = search_assignments(solver);
-    if (solution == SOLUTION_UNSATISFIABLE) {
-    backtrack:
-        while (solver->n_assigned > prev_n_assigned) {
-            Literal lit = solver->assigned[--solver->n_assigned];
-            undo_assignment(solver, lit);
-        }
-        assert(solver->n_assigned == prev_n_assigned);
     }
 
-    return solution;
+    return best_lit;
 }
 
-bool all_satisfied(const Solver *solver)
+Literal choose_lookahead(Solver *solver)
 {
-    return solver->n_sat_clauses == solver->n_clauses;
-}
+    Literal lit;
+    Literal best_lit;
+    unsigned int score;
+    unsigned int best_score;
+
+    update_scores(solver);
+
+    // Should always be overwritten
+    best_lit = 0;
+    best_score = 0;
+
+    for (lit = 0; lit < (solver->n_vars << 1); lit += 2) {
+
+        unsigned int a;
+        unsigned int b;
+
+        // Skip assigned and eliminated variables
+        if (solver->values[lit] != VALUE_UNSET ||
+            solver->vars[lit >> 1].eliminated) {
+            continue;
+        }
 
-bool any_contradiction(const Solver *solver)
+        // Calculate the score for this literal pair
+        a = solver->lits[lit].score;
+        b = solver->lits[negate(lit)].score;
+        score = (a + 1) * (b + 1); 
+
+        if (score > best_score) {
+            best_score = score;
+            // Choose the higher-scoring of the pair
+            if (a >= b) {
+                best_lit = lit;
+            } else {
+                best_lit = negate(lit);
+            }
+        }
+    }
+
+    return best_lit;
+}
+
+void update_scores(Solver *solver)
+{
+    Literal lit;
+    unsigned int i;
+    unsigned int j;
+
+    // Set all scores to zero
+    for (lit = 0; lit < (solver->n_vars << 1); ++lit) {
+        solver->lits[lit].score = 0;
+    }
+
+    for (i = 0; i < solver->n_clauses; ++i) {
+
+        ClauseState *cstate = get_clause(solver, solver->clauses[i]);
+        unsigned int n_free_lits = 0;
+        unsigned int weight;
+
+        // Count the free literals, skipping clauses
+        // that have already been satisfied
+        for (j = 0; j < cstate->n_lits; ++j) {
+            signed char value = solver->values[cstate->lits[j]];
+            if (value == VALUE_UNSET) {
+                n_free_lits += 1;
+            } else if (value == VALUE_TRUE) {
+                break;
+            }
+        }
+
+        if (j != cstate->n_lits) {
+            continue;
+        }
+
+        switch (n_free_lits) {
+
+        case 2:
+            weight = 4;
+            break;
+
+        case 3:
+            weight = 2;
+            break;
+
+        // All further cases must be 4 or more
+        default:
+            weight = 1;
+            break;
+
+        }
+
+        for (j = 0; j < cstate->n_lits; ++j) {
+            Literal lit = cstate->lits[j];
+            if (solver->values[lit] == VALUE_UNSET) {
+                solver->lits[lit].score += weight;
+            }
+        }
+    }
+}
+
+void bump_activity(Solver *solver, unsigned int var)
+{
+    unsigned int i;
+
+    solver->activity[var] += solver->activity_inc;
+
+    // Scale every activity down before they overflow
+    if (solver->activity[var] > 1e100) {
+        for (i = 0; i < solver->n_vars; ++i) {
+            solver->activity[i] *= 1e-100;
+        }
+        solver->activity_inc *= 1e-100;
+    }
+
+    heap_increase(&solver->order, var);
+}
+
+void decay_activities(Solver *solver)
+{
+    // Growing the increment is equivalent to shrinking
+    // every activity, but does not touch any of them
+    solver->activity_inc /= solver->config.activity_decay;
+}
+
+void make_assignment(Solver *solver, Literal lit)
+{
+    // Make sure the variable is not assigned
+    assert(solver->values[lit] == VALUE_UNSET);
+    assert(solver->values[negate(lit)] == VALUE_UNSET);
+
+    solver->values[lit] = VALUE_TRUE;
+    solver->values[negate(lit)] = VALUE_FALSE;
+}
+
+void undo_assignment(Solver *solver, Literal lit)
+{
+    // Make sure the variable is assigned true
+    assert(solver->values[lit] == VALUE_TRUE);
+    assert(solver->values[negate(lit)] == VALUE_FALSE);
+
+    // Watches do not need to be restored, since a watched literal
+    // can only become false after the literals assigned before it
+    solver->values[lit] = VALUE_UNSET;
+    solver->values[negate(lit)] = VALUE_UNSET;
+
+    if (solver->config.phase_saving) {
+        solver->vars[var_from_lit(lit)].phase =
+            (lit & 1) ? PHASE_NEGATIVE : PHASE_POSITIVE;
+    }
+
+    // The variable can be chosen as a branch again
+    if (solver->config.branching == BRANCH_VSIDS &&
+        ! heap_contains(&solver->order, var_from_lit(lit))) {
+        heap_insert(&solver->order, var_from_lit(lit));
+    }
+}
+
+void assign_literal(Solver *solver, Literal lit, ClauseRef reason)
+{
+    VarState *vstate = &solver->vars[var_from_lit(lit)];
+
+    vstate->level = solver->n_levels;
+    vstate->reason = reason;
+
+    solver->assigned[solver->n_assigned++] = lit;
+    make_assignment(solver, lit);
+}
+
+void backtrack(Solver *solver, unsigned int level)
+{
+    unsigned int start;
+
+    assert(level <= solver->n_levels);
+
+    if (level == solver->n_levels) {
+        return;
+    }
+
+    // Undo every assignment made after the start of the next level
+    start = solver->level_starts[level];
+    while (solver->n_assigned > start) {
+        Literal lit = solver->assigned[--solver->n_assigned];
+        undo_assignment(solver, lit);
+    }
+
+    solver->n_propagated = solver->n_assigned;
+    solver->n_levels = level;
+
+    if (solver->xors.n_checked > solver->n_assigned) {
+        solver->xors.n_checked = solver->n_assigned;
+    }
+}
+
+static ClauseRef propagate_clauses(Solver *solver)
+{
+    const signed char *values = solver->values;
+
+    while (solver->n_propagated < solver->n_assigned) {
+
+        Literal false_lit = negate(solver->assigned[solver->n_propagated++]);
+        LitState *lstate = &solver->lits[false_lit];
+        Watch *binaries = lstate->binaries;
+        Watch *watches = lstate->watches;
+        unsigned int i;
+        unsigned int j;
+
+        // Binary clauses come first, since the literal they imply
+        // is at hand without reading the clause from the arena
+        for (i = 0; i < lstate->n_binaries; ++i) {
+            Literal other = binaries[i].blocker;
+            if (values[other] == VALUE_UNSET) {
+                solver->t_unit_props += 1;
+                assign_literal(solver, other, binaries[i].clause);
+            } else if (values[other] == VALUE_FALSE) {
+                solver->n_propagated = solver->n_assigned;
+                return binaries[i].clause;
+            }
+        }
+
+        // Visit each clause watching the literal that just became false,
+        // compacting the watch list in place as watches are moved away
+        for (i = j = 0; i < lstate->n_watches; ++i) {
+
+            Watch watch = watches[i];
+            ClauseState *cstate;
+            Literal *lits;
+            Literal other;
+            unsigned int k;
+
+            // Satisfied clauses can often be skipped without
+            // reading the clause from the arena at all
+            if (values[watch.blocker] == VALUE_TRUE) {
+                watches[j++] = watch;
+                continue;
+            }
+
+            cstate = get_clause(solver, watch.clause);
+            lits = cstate->lits;
+
+            // Make sure the false literal is the second watch
+            if (lits[0] == false_lit) {
+                lits[0] = lits[1];
+                lits[1] = false_lit;
+            }
+            other = lits[0];
+            watch.blocker = other;
+
+            // If the other watch is true, the clause is satisfied
+            if (values[other] == VALUE_TRUE) {
+                watches[j++] = watch;
+                continue;
+            }
+
+            // Look for a literal that is not false to watch instead
+            // This never adds to the list being visited
+            for (k = 2; k < cstate->n_lits; ++k) {
+                if (values[lits[k]] != VALUE_FALSE) {
+                    lits[1] = lits[k];
+                    lits[k] = false_lit;
+                    add_watch(solver, lits[1], watch.clause, other);
+                    break;
+                }
+            }
+
+            if (k != cstate->n_lits) {
+                continue;
+            }
+
+            // Otherwise the clause is unit or a contradiction
+            watches[j++] = watch;
+
+            if (values[other] == VALUE_FALSE) {
+                // Keep the remaining watches and stop propagating
+                while (++i < lstate->n_watches) {
+                    watches[j++] = watches[i];
+                }
+                lstate->n_watches = j;
+                solver->n_propagated = solver->n_assigned;
+                return watch.clause;
+            }
+
+            // The implied literal is always the first in its reason
+            solver->t_unit_props += 1;
+            assign_literal(solver, other, watch.clause);
+        }
+
+        lstate->n_watches = j;
+    }
+
+    return CLAUSE_NONE;
+}
+
+ClauseRef propagate(Solver *solver)
+{
+    ClauseRef conflict;
+
+    // The XOR constraints are only reduced once the clauses
+    // have nothing more to propagate, and until they do too
+    for (;;) {
+
+        conflict = propagate_clauses(solver);
+        if (conflict != CLAUSE_NONE || solver->xors.n_rows == 0) {
+            return conflict;
+        }
+
+        conflict = propagate_xors(solver);
+        if (conflict != CLAUSE_NONE ||
+            solver->n_propagated == solver->n_assigned) {
+            return conflict;
+        }
+    }
+}
+
+static ClauseState *get_reason(Solver *solver, Literal lit)
+{
+    ClauseRef ref = solver->vars[var_from_lit(lit)].reason;
+    ClauseState *cstate = get_clause(solver, ref);
+
+    // Binary clauses are propagated without being read, so the
+    // literal they implied is only moved to the front once needed
+    if (cstate->lits[0] != lit) {
+        assert(cstate->n_lits == 2);
+        cstate->lits[1] = cstate->lits[0];
+        cstate->lits[0] = lit;
+    }
+
+    return cstate;
+}
+
+static void note_hints(Solver *solver, const ClauseState *cstate, bool first)
+{
+    unsigned int i;
+
+    // Marks go on the literals of the trail, so that they can be
+    // picked up in the order they were assigned; each literal fixed
+    // at level 0 is justified by its own unit clause
+    for (i = first ? 0 : 1; i < cstate->n_lits; ++i) {
+        Literal lit = cstate->lits[i];
+        if (solver->vars[var_from_lit(lit)].level == 0) {
+            solver->lit_marks[negate(lit)] = true;
+        }
+    }
+
+    // Every clause but the conflicting one is the reason
+    // for its first literal, which is resolved on
+    if (! first) {
+        unsigned int level;
+        level = solver->vars[var_from_lit(cstate->lits[0])].level;
+        solver->lit_marks[cstate->lits[0]] = true;
+        if (level < solver->hint_level) {
+            solver->hint_level = level;
+        }
+    }
+}
+
+static void add_hint(Solver *solver, Literal lit)
+{
+    unsigned int var = var_from_lit(lit);
+
+    if (! solver->lit_marks[lit]) {
+        return;
+    }
+    solver->lit_marks[lit] = false;
+
+    if (solver->vars[var].level == 0) {
+        solver->hints[solver->n_hints++] = solver->unit_ids[var];
+    } else {
+        solver->hints[solver->n_hints++] =
+            clause_id(solver, solver->vars[var].reason);
+    }
+}
+
+static void collect_hints(Solver *solver, ClauseRef conflict)
+{
+    unsigned int start = solver->n_assigned;
+    unsigned int i;
+
+    // Only the levels from the lowest one resolved on need visiting
+    if (solver->hint_level <= solver->n_levels) {
+        start = solver->level_starts[solver->hint_level - 1];
+    }
+
+    // Each clause is unit by the time it is reached, given the
+    // negation of the learned clause and the clauses before it
+    solver->n_hints = 0;
+    for (i = 0; i < solver->level_starts[0]; ++i) {
+        add_hint(solver, solver->assigned[i]);
+    }
+    for (i = start; i < solver->n_assigned; ++i) {
+        add_hint(solver, solver->assigned[i]);
+    }
+
+    solver->hints[solver->n_hints++] = clause_id(solver, conflict);
+}
+
+unsigned int analyze_conflict(Solver *solver, ClauseRef conflict)
+{
+    ClauseRef first_conflict = conflict;
+    bool proving = solver->unit_ids != NULL;
+    unsigned int n_current;
+    unsigned int pos;
+    unsigned int level;
+    unsigned int i;
+    unsigned int j;
+    bool first;
+    Literal uip;
+
+    /*
+     * 1. Resolve away literals of the current level until
+     *    only one remains (the first unique implication point)
+     */
+
+    // The first slot is reserved for the asserting literal
+    solver->n_learnt_lits = 1;
+
+    n_current = 0;
+    pos = solver->n_assigned;
+    first = true;
+    solver->hint_level = solver->n_levels + 1;
+
+    do {
+        ClauseState *cstate;
+
+        assert(conflict != CLAUSE_NONE);
+        cstate = first ? get_clause(solver, conflict) :
+                         get_reason(solver, uip);
+
+        if (proving) {
+            note_hints(solver, cstate, first);
+        }
+
+        // Clauses that take part in conflicts again may have
+        // their literals spread over fewer levels by now
+        if (cstate->learnt && cstate->lbd > solver->config.glue_lbd) {
+            unsigned int lbd;
+            lbd = compute_lbd(solver, cstate->lits, cstate->n_lits);
+            if (lbd < cstate->lbd) {
+                cstate->lbd = lbd;
+            }
+        }
+
+        // Skip the literal that the reason clause implied
+        for (i = first ? 0 : 1; i < cstate->n_lits; ++i) {
+
+            Literal lit = cstate->lits[i];
+            VarState *vstate = &solver->vars[var_from_lit(lit)];
+
+            // Level 0 literals are false in every assignment
+            if (vstate->seen || vstate->level == 0) {
+                continue;
+            }
+
+            vstate->seen = true;
+            bump_activity(solver, var_from_lit(lit));
+
+            if (vstate->level == solver->n_levels) {
+                n_current += 1;
+            } else {
+                solver->learnt_lits[solver->n_learnt_lits++] = lit;
+            }
+        }
+
+        // Find the most recent assignment involved in the conflict
+        do {
+            uip = solver->assigned[--pos];
+        } while (! solver->vars[var_from_lit(uip)].seen);
+
+        conflict = solver->vars[var_from_lit(uip)].reason;
+        solver->vars[var_from_lit(uip)].seen = false;
+        first = false;
+        n_current -= 1;
+
+    } while (n_current > 0);
+
+    solver->learnt_lits[0] = negate(uip);
+
+    /*
+     * 2. Drop literals implied by the rest of the clause
+     */
+
+    for (i = j = 1; i < solver->n_learnt_lits; ++i) {
+
+        Literal lit = solver->learnt_lits[i];
+        ClauseRef ref = solver->vars[var_from_lit(lit)].reason;
+        unsigned int k;
+
+        if (ref != CLAUSE_NONE) {
+            ClauseState *reason = get_reason(solver, negate(lit));
+
+            // A literal is redundant when every other literal of its
+            // reason is already in the clause or fixed at level 0
+            for (k = 1; k < reason->n_lits; ++k) {
+                VarState *vstate;
+                vstate = &solver->vars[var_from_lit(reason->lits[k])];
+                if (! vstate->seen && vstate->level > 0) {
+                    break;
+                }
+            }
+            if (k == reason->n_lits) {
+                if (proving) {
+                    note_hints(solver, reason, false);
+                }
+                continue;
+            }
+        }
+
+        // Swap rather than overwrite, so that the dropped
+        // literals are still around to have their marks cleared
+        solver->learnt_lits[i] = solver->learnt_lits[j];
+        solver->learnt_lits[j++] = lit;
+    }
+
+    // Clear the marks, including those of the dropped literals
+    for (i = 1; i < solver->n_learnt_lits; ++i) {
+        solver->vars[var_from_lit(solver->learnt_lits[i])].seen = false;
+    }
+    solver->n_learnt_lits = j;
+
+    // The proof lists the clauses resolved on in trail order
+    if (proving) {
+        collect_hints(solver, first_conflict);
+    }
+
+    /*
+     * 3. Find the level to jump back to
+     */
+
+    // Move the literal with the highest level into the second slot
+    // so that it is watched alongside the asserting literal
+    level = 0;
+    for (i = 1; i < solver->n_learnt_lits; ++i) {
+        unsigned int lit_level;
+        lit_level = solver->vars[var_from_lit(solver->learnt_lits[i])].level;
+        if (lit_level > level) {
+            Literal tmp = solver->learnt_lits[1];
+            solver->learnt_lits[1] = solver->learnt_lits[i];
+            solver->learnt_lits[i] = tmp;
+            level = lit_level;
+        }
+    }
+
+    return level;
+}
+
+unsigned int compute_lbd(Solver *solver,
+                         const Literal *lits,
+                         unsigned int num_lits)
+{
+    unsigned int lbd = 0;
+    unsigned int i;
+
+    // A fresh stamp avoids clearing the marks of the previous call
+    solver->lbd_stamp += 1;
+
+    for (i = 0; i < num_lits; ++i) {
+        unsigned int level = solver->vars[var_from_lit(lits[i])].level;
+        if (solver->level_stamps[level] != solver->lbd_stamp) {
+            solver->level_stamps[level] = solver->lbd_stamp;
+            lbd += 1;
+        }
+    }
+
+    return lbd;
+}
+
+void learn_clause(Solver *solver, unsigned int lbd)
+{
+    ClauseRef ref;
+    ClauseState *cstate;
+    uint64_t id = 0;
+    unsigned int i;
+
+    if (solver->proof != NULL) {
+        id = add_proof_clause(solver->proof,
+                              solver->learnt_lits, solver->n_learnt_lits,
+                              solver->hints, solver->n_hints);
+    }
+
+    // Unit clauses do not need to be stored
+    if (solver->n_learnt_lits == 1) {
+        if (solver->unit_ids != NULL) {
+            solver->unit_ids[var_from_lit(solver->learnt_lits[0])] = id;
+        }
+        assign_literal(solver, solver->learnt_lits[0], CLAUSE_NONE);
+        return;
+    }
+
+    ref = alloc_clause(solver, solver->n_learnt_lits);
+    cstate = get_clause(solver, ref);
+    cstate->learnt = 1;
+    cstate->lbd = lbd;
+    if (solver->proof_words > 0) {
+        set_clause_id(solver, ref, id);
+    }
+    for (i = 0; i < solver->n_learnt_lits; ++i) {
+        cstate->lits[i] = solver->learnt_lits[i];
+    }
+
+    if (solver->n_learnts == solver->c_learnts) {
+        solver->c_learnts *= 2;
+        REGION_RESIZE(solver->region, solver->learnts, solver->c_learnts);
+    }
+    solver->learnts[solver->n_learnts++] = ref;
+
+    watch_clause(solver, ref);
+
+    // The clause is now unit under the current assignment
+    assign_literal(solver, solver->learnt_lits[0], ref);
+}
+
+static bool implies(const Solver *solver, ClauseRef ref, Literal lit)
+{
+    return solver->values[lit] == VALUE_TRUE &&
+           solver->vars[var_from_lit(lit)].reason == ref;
+}
+
+bool clause_locked(const Solver *solver, ClauseRef ref)
+{
+    const ClauseState *cstate = get_clause(solver, ref);
+
+    // A clause cannot be removed while it is the reason for an
+    // assignment, which for a binary clause may be either literal
+    return implies(solver, ref, cstate->lits[0]) ||
+           (cstate->n_lits == 2 && implies(solver, ref, cstate->lits[1]));
+}
+
+typedef struct
+{
+    unsigned int lbd;
+    unsigned int n_lits;
+    ClauseRef ref;
+}
+ReduceCandidate;
+
+static int compare_candidates(const void *a, const void *b)
+{
+    const ReduceCandidate *x = a;
+    const ReduceCandidate *y = b;
+
+    // Worst clauses first, with ties broken by length
+    if (x->lbd != y->lbd) {
+        return x->lbd > y->lbd ? -1 : 1;
+    } else if (x->n_lits != y->n_lits) {
+        return x->n_lits > y->n_lits ? -1 : 1;
+    } else {
+        return 0;
+    }
+}
+
+void reduce_learnts(Solver *solver)
+{
+    ReduceCandidate *candidates;
+    unsigned int n_candidates;
+    unsigned int n_delete;
+    unsigned int i;
+    unsigned int j;
+
+    /*
+     * 1. Collect the clauses that are allowed to be deleted
+     */
+
+    CREATE_ARRAY(candidates, solver->n_learnts + 1);
+    n_candidates = 0;
+
+    for (i = 0; i < solver->n_learnts; ++i) {
+        ClauseRef ref = solver->learnts[i];
+        ClauseState *cstate = get_clause(solver, ref);
+        if (cstate->lbd > solver->config.glue_lbd &&
+            ! clause_locked(solver, ref)) {
+            candidates[n_candidates].lbd = cstate->lbd;
+            candidates[n_candidates].n_lits = cstate->n_lits;
+            candidates[n_candidates].ref = ref;
+            n_candidates += 1;
+        }
+    }
+
+    /*
+     * 2. Delete the worst of them
+     */
+
+    qsort(candidates, n_candidates, sizeof(*candidates), compare_candidates);
+
+    n_delete = (unsigned int) (n_candidates * solver->config.reduce_fraction);
+    for (i = 0; i < n_delete; ++i) {
+        ClauseState *cstate = get_clause(solver, candidates[i].ref);
+        cstate->deleted = 1;
+        if (solver->proof != NULL) {
+            delete_proof_clause(solver->proof,
+                                solver->proof_words > 0 ?
+                                clause_id(solver, candidates[i].ref) : 0,
+                                cstate->lits, cstate->n_lits);
+        }
+    }
+
+    DELETE_ARRAY(candidates);
+
+    for (i = j = 0; i < solver->n_learnts; ++i) {
+        if (! get_clause(solver, solver->learnts[i])->deleted) {
+            solver->learnts[j++] = solver->learnts[i];
+        }
+    }
+    solver->n_learnts = j;
+    solver->t_deleted += n_delete;
+
+    /*
+     * 3. Schedule the next reduction
+     */
+
+    solver->reduce_interval += solver->config.reduce_increment;
+    solver->next_reduce = solver->t_conflicts + solver->reduce_interval;
+
+    collect_garbage(solver);
+}
+
+static ClauseRef forwarded_ref(const ClauseState *cstate)
+{
+#ifdef SIMPLESAT_WIDE_INDEX
+    return (ClauseRef) cstate->lbd << 32 | cstate->n_lits;
+#else
+    return cstate->n_lits;
+#endif
+}
+
+static ClauseRef move_clause(Solver *solver,
+                             Literal *arena,
+                             Offset *n_arena,
+                             ClauseRef ref)
+{
+    ClauseState *cstate = get_clause(solver, ref);
+    unsigned int words;
+    unsigned int i;
+
+    // Leave the new offset behind for the other references,
+    // taking along the identifier in front of the clause
+    if (! cstate->moved) {
+        const Literal *start = &solver->arena[ref - solver->proof_words];
+        ClauseRef new_ref = *n_arena + solver->proof_words;
+        words = solver->proof_words + CLAUSE_WORDS(cstate->n_lits);
+        for (i = 0; i < words; ++i) {
+            arena[*n_arena + i] = start[i];
+        }
+        *n_arena += words;
+        cstate->moved = 1;
+        cstate->n_lits = (unsigned int) new_ref;
+#ifdef SIMPLESAT_WIDE_INDEX
+        // The old copy has no more use for its LBD,
+        // which holds the rest of the offset instead
+        cstate->lbd = (unsigned int) (new_ref >> 32);
+#endif
+    }
+
+    return forwarded_ref(cstate);
+}
+
+void collect_garbage(Solver *solver)
+{
+    Literal *arena;
+    Offset n_arena;
+    Offset c_arena;
+    unsigned int i;
+    unsigned int j;
+    Literal lit;
+
+    /*
+     * 1. Drop the watches of deleted clauses
+     */
+
+    for (lit = 0; lit < (solver->n_vars << 1); ++lit) {
+        LitState *lstate = &solver->lits[lit];
+        for (i = j = 0; i < lstate->n_watches; ++i) {
+            if (! get_clause(solver, lstate->watches[i].clause)->deleted) {
+                lstate->watches[j++] = lstate->watches[i];
+            }
+        }
+        lstate->n_watches = j;
+        for (i = j = 0; i < lstate->n_binaries; ++i) {
+            if (! get_clause(solver, lstate->binaries[i].clause)->deleted) {
+                lstate->binaries[j++] = lstate->binaries[i];
+            }
+        }
+        lstate->n_binaries = j;
+    }
+
+    /*
+     * 2. Copy the remaining clauses into a new, compact arena
+     */
+
+    n_arena = 0;
+    c_arena = solver->c_arena;
+    REGION_CREATE(solver->region, arena, c_arena);
+
+    for (i = 0; i < solver->n_clauses; ++i) {
+        solver->clauses[i] = move_clause(solver, arena, &n_arena,
+                                         solver->clauses[i]);
+    }
+
+    for (i = 0; i < solver->n_learnts; ++i) {
+        solver->learnts[i] = move_clause(solver, arena, &n_arena,
+                                         solver->learnts[i]);
+    }
+
+    /*
+     * 3. Update the references held elsewhere
+     */
+
+    // Lists are visited while the old arena still
+    // holds the forwarding offsets
+    for (i = 0; i < solver->n_assigned; ++i) {
+        VarState *vstate = &solver->vars[var_from_lit(solver->assigned[i])];
+        if (vstate->reason != CLAUSE_NONE) {
+            vstate->reason = forwarded_ref(get_clause(solver,
+                                                      vstate->reason));
+        }
+    }
+
+    for (lit = 0; lit < (solver->n_vars << 1); ++lit) {
+        LitState *lstate = &solver->lits[lit];
+        for (i = 0; i < lstate->n_watches; ++i) {
+            Watch *watch = &lstate->watches[i];
+            watch->clause = forwarded_ref(get_clause(solver, watch->clause));
+        }
+        for (i = 0; i < lstate->n_binaries; ++i) {
+            Watch *watch = &lstate->binaries[i];
+            watch->clause = forwarded_ref(get_clause(solver, watch->clause));
+        }
+    }
+
+    REGION_DELETE(solver->region, solver->arena);
+    solver->arena = arena;
+    solver->n_arena = n_arena;
+}
+
+static void prove_units(Solver *solver)
+{
+    // Level 0 assignments made by propagation are derived as units
+    // of their own, so that later steps need not follow their reasons
+    if (solver->unit_ids == NULL) {
+        return;
+    }
+
+    assert(solver->n_levels == 0);
+
+    for (; solver->n_proved_units < solver->n_assigned;
+         ++solver->n_proved_units) {
+
+        Literal lit = solver->assigned[solver->n_proved_units];
+        unsigned int var = var_from_lit(lit);
+        ClauseRef reason = solver->vars[var].reason;
+        ClauseState *cstate;
+        unsigned int i;
+
+        // Units of the problem and learned units already have one
+        if (solver->unit_ids[var] != 0) {
+            continue;
+        }
+
+        cstate = get_reason(solver, lit);
+        solver->n_hints = 0;
+        for (i = 1; i < cstate->n_lits; ++i) {
+            solver->hints[solver->n_hints++] =
+                solver->unit_ids[var_from_lit(cstate->lits[i])];
+        }
+        solver->hints[solver->n_hints++] = clause_id(solver, reason);
+
+        solver->unit_ids[var] = add_proof_clause(solver->proof, &lit, 1,
+                                                 solver->hints,
+                                                 solver->n_hints);
+    }
+}
+
+static void prove_empty(Solver *solver, ClauseRef conflict)
+{
+    unsigned int i;
+
+    if (solver->proof == NULL) {
+        return;
+    }
+
+    // Every literal of the conflicting clause is false at level 0
+    solver->n_hints = 0;
+    if (solver->unit_ids != NULL) {
+        ClauseState *cstate = get_clause(solver, conflict);
+        for (i = 0; i < cstate->n_lits; ++i) {
+            solver->hints[solver->n_hints++] =
+                solver->unit_ids[var_from_lit(cstate->lits[i])];
+        }
+        solver->hints[solver->n_hints++] = clause_id(solver, conflict);
+    }
+
+    add_proof_clause(solver->proof, NULL, 0,
+                     solver->hints, solver->n_hints);
+}
+
+bool start_search(Solver *solver)
+{
+    unsigned int i;
+    double preprocess_start;
+    ClauseRef conflict;
+    bool consistent;
+
+    solver->started = true;
+
+    // Limits on the search hold over every later call as well,
+    // and reports count from here too
+    solver->report_start = wall_time();
+    solver->deadline = solver->report_start + solver->config.max_seconds;
+    solver->next_report = solver->report_start +
+                          solver->config.report_interval;
+    solver->n_report_requests = report_requests();
+    solver->last_report_time = solver->report_start;
+
+    /*
+     * 1. Watch the first two literals of each clause
+     */
+
+    if (solver->config.preprocess) {
+        preprocess_start = wall_time();
+        consistent = preprocess(solver);
+        solver->preprocess_time = wall_time() - preprocess_start;
+        if (! consistent) {
+            solver->inconsistent = true;
+            prove_empty(solver, CLAUSE_NONE);
+            return false;
+        }
+    }
+
+    attach_watches(solver);
+
+    for (i = 0; i < solver->n_clauses; ++i) {
+
+        ClauseRef ref = solver->clauses[i];
+        ClauseState *cstate = get_clause(solver, ref);
+        Literal lit;
+
+        if (cstate->n_lits == 0) {
+            // The empty clause can never be satisfied
+            solver->inconsistent = true;
+            prove_empty(solver, ref);
+            return false;
+        } else if (cstate->n_lits == 1) {
+            // Unit clauses are assigned before searching
+            lit = cstate->lits[0];
+            if (solver->values[lit] == VALUE_UNSET) {
+                assign_literal(solver, lit, CLAUSE_NONE);
+                if (solver->unit_ids != NULL) {
+                    solver->unit_ids[var_from_lit(lit)] =
+                        clause_id(solver, ref);
+                }
+            } else if (solver->values[lit] == VALUE_FALSE) {
+                solver->inconsistent = true;
+                prove_empty(solver, ref);
+                return false;
+            }
+        }
+    }
+
+    /*
+     * 2. Order the variables and propagate the unit clauses
+     */
+
+    if (solver->config.branching == BRANCH_VSIDS) {
+
+        // Tiny random activities only matter until the first conflict
+        if (solver->config.seed != 0) {
+            unsigned int state = solver->config.seed;
+            for (i = 0; i < solver->n_vars; ++i) {
+                state ^= state << 13;
+                state ^= state >> 17;
+                state ^= state << 5;
+                solver->activity[i] = (state & 0xffff) * 1e-10;
+            }
+        }
+
+        for (i = 0; i < solver->n_vars; ++i) {
+            if (! solver->vars[i].eliminated) {
+                heap_insert(&solver->order, i);
+            }
+        }
+    }
+
+    solver->reduce_interval = solver->config.reduce_interval;
+    solver->next_reduce = solver->reduce_interval;
+
+    // The clauses each XOR constraint gives as reasons need learning,
+    // and the steps from one to the next are too long for a proof
+    if (solver->config.gauss &&
+        solver->config.search == SEARCH_CDCL &&
+        solver->proof == NULL) {
+        find_xors(solver);
+    }
+
+    conflict = propagate(solver);
+    prove_units(solver);
+    if (conflict != CLAUSE_NONE) {
+        solver->inconsistent = true;
+        prove_empty(solver, conflict);
+        return false;
+    }
+
+    return true;
+}
+
+Solution solve(Solver *solver)
+{
+    return solve_assuming(solver, NULL, 0);
+}
+
+Solution solve_assuming(Solver *solver,
+                        const Literal *assumptions,
+                        unsigned int num_assumptions)
+{
+    Solution solution;
+    RestartMode restarts;
+    unsigned int i;
+
+    solver->n_failed = 0;
+
+    if (! solver->started && ! start_search(solver)) {
+        return SOLUTION_UNSATISFIABLE;
+    } else if (solver->inconsistent) {
+        return SOLUTION_UNSATISFIABLE;
+    }
+
+    // Anything learned by an earlier call is kept
+    backtrack(solver, 0);
+
+    // Repeating an assumption would take up another level
+    solver->n_assumptions = 0;
+    for (i = 0; i < num_assumptions; ++i) {
+        Literal lit = assumptions[i];
+        assert(var_from_lit(lit) < solver->n_vars);
+        assert(! solver->vars[var_from_lit(lit)].eliminated);
+        if (! solver->lit_marks[lit]) {
+            solver->lit_marks[lit] = true;
+            solver->assumptions[solver->n_assumptions++] = lit;
+        }
+    }
+
+    for (i = 0; i < solver->n_assumptions; ++i) {
+        solver->lit_marks[solver->assumptions[i]] = false;
+    }
+
+    // Plain backtracking would lose track of
+    // the polarities it has tried after a restart
+    restarts = solver->config.restarts;
+    if (solver->config.search != SEARCH_CDCL) {
+        restarts = RESTART_NONE;
+    }
+
+    // Local search runs before the first decision, and in the
+    // hybrid mode again after every so many restarts
+    if (solver->config.search == SEARCH_WALK ||
+        solver->config.walk_interval != 0) {
+        solver->next_walk = solver->t_restarts;
+    } else {
+        solver->next_walk = UINT64_MAX;
+    }
+
+    // Failed literals only become units through conflict analysis,
+    // and the clauses that inprocessing adds have no LRAT hints
+    if (solver->config.search == SEARCH_CDCL &&
+        solver->config.inprocess_interval != 0 &&
+        solver->proof_words == 0) {
+        solver->next_inprocess = solver->t_conflicts +
+                                 solver->config.inprocess_interval;
+    } else {
+        solver->next_inprocess = UINT64_MAX;
+    }
+
+    create_restart_state(&solver->restarts,
+                         restarts,
+                         solver->config.luby_unit,
+                         solver->config.lbd_window,
+                         solver->config.restart_margin);
+
+    solution = search_assignments(solver);
+
+    delete_restart_state(&solver->restarts);
+
+    if (solution == SOLUTION_SATISFIABLE) {
+        extend_model(solver);
+    }
+
+    return solution;
+}
+
+void join_exchange(Solver *solver, Exchange *exchange, unsigned int index)
+{
+    unsigned int i;
+
+    solver->exchange = exchange;
+    solver->exchange_index = index;
+
+    REGION_CREATE(solver->region, solver->import_cursors, exchange->n_rings);
+    for (i = 0; i < exchange->n_rings; ++i) {
+        solver->import_cursors[i] = 0;
+    }
+}
+
+static bool learn_shared_clause(Solver *solver, const SharedClause *clause)
+{
+    Literal lits[SHARE_MAX_LITS];
+    unsigned int n_lits = 0;
+    ClauseRef ref;
+    ClauseState *cstate;
+    unsigned int i;
+
+    // Drop literals already false at level 0, and the clause
+    // altogether if one of them is true or has been eliminated
+    for (i = 0; i < clause->n_lits; ++i) {
+
+        Literal lit = clause->lits[i];
+
+        if (var_from_lit(lit) >= solver->n_vars ||
+            solver->vars[var_from_lit(lit)].eliminated) {
+            return true;
+        }
+
+        if (solver->values[lit] == VALUE_UNSET) {
+            lits[n_lits++] = lit;
+        } else if (solver->values[lit] == VALUE_TRUE) {
+            return true;
+        }
+    }
+
+    if (n_lits == 0) {
+        // Every solver's clauses follow from the same problem,
+        // so the problem itself cannot be satisfied
+        return false;
+    } else if (n_lits == 1) {
+        assign_literal(solver, lits[0], CLAUSE_NONE);
+        solver->t_imported += 1;
+        return true;
+    }
+
+    ref = alloc_clause(solver, n_lits);
+    cstate = get_clause(solver, ref);
+    cstate->learnt = 1;
+    cstate->lbd = clause->lbd;
+    for (i = 0; i < n_lits; ++i) {
+        cstate->lits[i] = lits[i];
+    }
+
+    if (solver->n_learnts == solver->c_learnts) {
+        solver->c_learnts *= 2;
+        REGION_RESIZE(solver->region, solver->learnts, solver->c_learnts);
+    }
+    solver->learnts[solver->n_learnts++] = ref;
+
+    // Nothing in the clause is assigned, so any two literals will do
+    watch_clause(solver, ref);
+
+    solver->t_imported += 1;
+    return true;
+}
+
+bool import_clauses(Solver *solver)
+{
+    Exchange *exchange = solver->exchange;
+    SharedClause clause;
+    unsigned int n_read;
+    bool progress;
+    unsigned int i;
+
+    // Clauses are only taken in at level 0,
+    // where they cannot be unit or conflicting
+    assert(solver->n_levels == 0);
+
+    if (exchange == NULL) {
+        return true;
+    }
+
+    // Read the rings in turns, so that a busy
+    // solver does not crowd out the others
+    n_read = 0;
+    do {
+        progress = false;
+        for (i = 0; i < exchange->n_rings; ++i) {
+            if (i == solver->exchange_index ||
+                n_read == solver->config.share_import_limit) {
+                continue;
+            }
+            if (import_clause(exchange, i,
+                              &solver->import_cursors[i], &clause)) {
+                n_read += 1;
+                progress = true;
+                if (! learn_shared_clause(solver, &clause)) {
+                    return false;
+                }
+            }
+        }
+    } while (progress);
+
+    return true;
+}
+
+void make_decision(Solver *solver, Literal branch)
+{
+    solver->t_branches += 1;
+    solver->level_flipped[solver->n_levels] = false;
+    solver->level_starts[solver->n_levels++] = solver->n_assigned;
+    assign_literal(solver, branch, CLAUSE_NONE);
+}
+
+bool backjump(Solver *solver, ClauseRef conflict)
+{
+    unsigned int level;
+    unsigned int lbd;
+
+    // A conflict without any decisions cannot be avoided
+    if (solver->n_levels == 0) {
+        return false;
+    }
+
+    // Jump back to the level where the learned clause is unit
+    level = analyze_conflict(solver, conflict);
+    lbd = compute_lbd(solver, solver->learnt_lits, solver->n_learnt_lits);
+    note_conflict(&solver->restarts, lbd);
+
+    backtrack(solver, level);
+    learn_clause(solver, lbd);
+
+    // Short clauses over few levels are worth having elsewhere too
+    if (solver->exchange != NULL &&
+        solver->config.share_clauses &&
+        solver->n_learnt_lits <= solver->config.share_max_lits &&
+        solver->n_learnt_lits <= SHARE_MAX_LITS &&
+        lbd <= solver->config.share_max_lbd) {
+        export_clause(solver->exchange, solver->exchange_index,
+                      solver->learnt_lits, solver->n_learnt_lits, lbd);
+        solver->t_exported += 1;
+    }
+
+    decay_activities(solver);
+
+    return true;
+}
+
+static void prove_decisions(Solver *solver)
+{
+    unsigned int i;
+
+    if (solver->proof == NULL) {
+        return;
+    }
+
+    // The decisions cannot all hold together, either because they
+    // lead to a conflict or because the last one failed both ways
+    for (i = 0; i < solver->n_levels; ++i) {
+        Literal branch = solver->assigned[solver->level_starts[i]];
+        solver->learnt_lits[i] = negate(branch);
+    }
+    add_proof_clause(solver->proof, solver->learnt_lits, solver->n_levels,
+                     NULL, 0);
+}
+
+bool flip_decision(Solver *solver)
+{
+    // Undo levels until one is found whose decision has not
+    // been tried both ways, leaving the assumptions alone
+    while (solver->n_levels > solver->n_assumptions) {
+
+        unsigned int level = solver->n_levels - 1;
+        Literal branch = solver->assigned[solver->level_starts[level]];
+        bool flipped = solver->level_flipped[level];
+
+        prove_decisions(solver);
+
+        backtrack(solver, level);
+
+        if (! flipped) {
+            make_decision(solver, negate(branch));
+            solver->level_flipped[level] = true;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void restart(Solver *solver)
+{
+    // Learned clauses and activities are kept,
+    // so the search does not start over entirely
+    solver->t_restarts += 1;
+    backtrack(solver, 0);
+    note_restart(&solver->restarts);
+}
+
+static bool budget_exhausted(Solver *solver)
+{
+    const SolverConfig *config = &solver->config;
+    unsigned int requests;
+    double now;
+
+    if ((config->max_conflicts != 0 &&
+         solver->t_conflicts >= config->max_conflicts) ||
+        (config->max_propagations != 0 &&
+         solver->t_unit_props >= config->max_propagations)) {
+        return true;
+    }
+
+    if (solver->poll_countdown-- > 0) {
+        return false;
+    }
+    solver->poll_countdown = POLL_PERIOD;
+
+    // Reports are written on a schedule and whenever a signal
+    // asks for one, without interrupting the search
+    now = wall_time();
+    requests = report_requests();
+    if ((config->report_interval > 0.0 && now >= solver->next_report) ||
+        requests != solver->n_report_requests) {
+        solver->n_report_requests = requests;
+        solver->next_report = now + config->report_interval;
+        write_report(solver, now);
+    }
+
+    if (config->max_seconds > 0.0 && now >= solver->deadline) {
+        return true;
+    }
+
+    // Only what this solver holds now counts, so that other solvers
+    // in the same process, before or alongside it, use up none of it
+    return config->max_memory != 0 &&
+           solver->region->n_used >> 20 >= config->max_memory;
+}
+
+bool search_interrupted(Solver *solver)
+{
+    if (solver->stop != NULL &&
+        atomic_load_explicit(solver->stop, memory_order_relaxed)) {
+        return true;
+    }
+
+    return budget_exhausted(solver);
+}
+
+Solution search_assignments(Solver *solver)
+{
+    unsigned int i;
+
+    for (;;) {
+
+        ClauseRef conflict;
+
+        // Another solver may already have found the answer,
+        // or this one may have used up what it was allowed
+        if (search_interrupted(solver)) {
+            return SOLUTION_UNKNOWN;
+        }
+
+        conflict = propagate(solver);
+        if (solver->n_levels == 0) {
+            prove_units(solver);
+        }
+
+        if (conflict != CLAUSE_NONE) {
+
+            bool resolved;
+            bool at_root = solver->n_levels == 0;
+
+            solver->t_conflicts += 1;
+
+            switch (solver->config.search) {
+
+            case SEARCH_CDCL:
+                resolved = backjump(solver, conflict);
+                break;
+
+            // Local search hands over to plain backtracking
+            case SEARCH_DPLL:
+            case SEARCH_WALK:
+            default:
+                resolved = flip_decision(solver);
+                break;
+
+            }
+
+            // Every way out of the conflict has been tried, which
+            // only rules out the assumptions if there were any
+            if (! resolved) {
+                if (solver->config.search == SEARCH_CDCL ||
+                    solver->n_assumptions == 0 || at_root) {
+                    solver->inconsistent = true;
+                    prove_empty(solver, conflict);
+                } else {
+                    // Backtracking does not say which of them failed
+                    for (i = 0; i < solver->n_assumptions; ++i) {
+                        solver->failed[i] = solver->assumptions[i];
+                    }
+                    solver->n_failed = solver->n_assumptions;
+                }
+                return SOLUTION_UNSATISFIABLE;
+            }
+
+        } else if (solver->n_levels >= solver->n_assumptions &&
+                   all_satisfied(solver)) {
+
+            return SOLUTION_SATISFIABLE;
+
+        } else if (restart_due(&solver->restarts)) {
+
+            restart(solver);
+
+            if (! import_clauses(solver)) {
+                solver->inconsistent = true;
+                return SOLUTION_UNSATISFIABLE;
+            }
+
+        } else if (solver->config.search == SEARCH_CDCL &&
+                   solver->t_conflicts >= solver->next_reduce) {
+
+            reduce_learnts(solver);
+
+        } else if (solver->n_levels == 0 &&
+                   solver->t_conflicts >= solver->next_inprocess) {
+
+            // Every unit found is propagated before it returns, so
+            // the proof already shows that the clauses are refuted
+            if (! inprocess(solver)) {
+                solver->inconsistent = true;
+                prove_empty(solver, CLAUSE_NONE);
+                return SOLUTION_UNSATISFIABLE;
+            }
+
+        } else if (solver->n_levels == 0 &&
+                   solver->t_restarts >= solver->next_walk) {
+
+            // On its own, local search only stops short of a solution
+            // when the search as a whole has to; what it finds is
+            // then assigned without a conflict by branching on it
+            if (solver->config.search == SEARCH_WALK) {
+                if (! walk(solver, 0, solver->t_flips == 0)) {
+                    return SOLUTION_UNKNOWN;
+                }
+                solver->next_walk = UINT64_MAX;
+            } else {
+                walk(solver, solver->config.walk_flips, false);
+                solver->next_walk = solver->t_restarts +
+                                    solver->config.walk_interval;
+            }
+
+        } else if (solver->n_levels < solver->n_assumptions) {
+
+            Literal lit = solver->assumptions[solver->n_levels];
+
+            if (solver->values[lit] == VALUE_UNSET) {
+                make_decision(solver, lit);
+            } else if (solver->values[lit] == VALUE_TRUE) {
+                // Keep one level for each assumption
+                // even when it is already implied
+                solver->level_flipped[solver->n_levels] = true;
+                solver->level_starts[solver->n_levels++] =
+                    solver->n_assigned;
+            } else {
+                // The assumptions contradict each other or the clauses
+                analyze_final(solver, lit);
+                return SOLUTION_UNSATISFIABLE;
+            }
+
+        } else {
+
+            make_decision(solver, choose_branch(solver));
+        }
+    }
+}
+
+void analyze_final(Solver *solver, Literal lit)
+{
+    unsigned int i;
+    unsigned int j;
+
+    solver->failed[0] = lit;
+    solver->n_failed = 1;
+
+    // The assumption is false whatever else is assumed
+    if (solver->vars[var_from_lit(lit)].level == 0) {
+        return;
+    }
+
+    // Follow the reasons back from the assumption's negation;
+    // the decisions they lead to are all assumptions as well
+    solver->vars[var_from_lit(lit)].seen = true;
+    for (i = solver->n_assigned; i-- > solver->level_starts[0];) {
+
+        Literal trail_lit = solver->assigned[i];
+        VarState *vstate = &solver->vars[var_from_lit(trail_lit)];
+        ClauseState *cstate;
+
+        if (! vstate->seen) {
+            continue;
+        }
+        vstate->seen = false;
+
+        if (vstate->reason == CLAUSE_NONE) {
+            solver->failed[solver->n_failed++] = trail_lit;
+            continue;
+        }
+
+        cstate = get_reason(solver, trail_lit);
+        for (j = 1; j < cstate->n_lits; ++j) {
+            VarState *other = &solver->vars[var_from_lit(cstate->lits[j])];
+            if (other->level > 0) {
+                other->seen = true;
+            }
+        }
+    }
+}
+
+bool all_satisfied(const Solver *solver)
 {
-    return solver->n_unsat_clauses > 0;
+    // Propagation never leaves a clause with every literal false,
+    // so once every variable is assigned all clauses are satisfied
+    return solver->n_assigned + solver->n_eliminated == solver->n_vars;
 }
 
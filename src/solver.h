@@ -2,57 +2,252 @@
 #ifndef SIMPLESAT_SOLVER_H
 #define SIMPLESAT_SOLVER_H
 
+#include <stdatomic.h>
 #include <stdbool.h>
-#include <time.h>
+#include <stdint.h>
 
-typedef unsigned int Literal;
+#include "exchange.h"
+#include "heap.h"
+#include "problem.h"
+#include "proof.h"
+#include "region.h"
+#include "restart.h"
 
 Literal negate(Literal);
 Literal lit_from_int(int);
 int int_from_lit(Literal);
+unsigned int var_from_lit(Literal);
+
+// Clauses are referred to by their offset in the clause arena
+typedef Offset ClauseRef;
+
+#define CLAUSE_NONE ((ClauseRef) -1)
 
 typedef struct
 {
-    // Array of literals in this clause
+    // Array of literals in this clause, stored inline
+    // The first two literals are the ones being watched
     unsigned int n_lits;
-    unsigned int c_lits;
-    Literal *lits;
 
-    // Assignment counts allow detection of SAT/UNSAT
-    // faster than examining the literals every time
-    unsigned int n_assigned_true;
-    unsigned int n_assigned_false;
-    unsigned int n_free_lits;
+    // Learned clauses may be deleted, and a clause that has been
+    // moved during compaction keeps its new offset in `n_lits`,
+    // and in `lbd` whatever of it does not fit there
+    unsigned int learnt : 1;
+    unsigned int deleted : 1;
+    unsigned int moved : 1;
+
+    // Learned clauses are only vivified once
+    unsigned int vivified : 1;
+
+    // Number of distinct decision levels among the literals
+    unsigned int lbd : 28;
+
+    Literal lits[];
 }
 ClauseState;
 
-void create_clause_state(ClauseState *);
-void delete_clause_state(ClauseState *);
-
-void add_literal(ClauseState *, Literal);
+// Number of arena words taken by a clause with the given length
+#define CLAUSE_WORDS(N) ((sizeof(ClauseState) / sizeof(Literal)) + (N))
 
 typedef struct
 {
-    // Record assigned value
-    bool fixed;
-    bool assigned;
+    ClauseRef clause;
 
+    // Some other literal of the clause; when it is true the
+    // clause is satisfied and does not need to be looked at
+    Literal blocker;
+}
+Watch;
+
+// Value of a literal under the current assignment, where the two
+// literals of a variable are either both unset or opposite
+#define VALUE_UNSET 0
+#define VALUE_TRUE 1
+#define VALUE_FALSE (-1)
+
+typedef struct
+{
     // Overall favorability of this literal as a branch choice
     unsigned int score;
 
-    // Array of clauses containing this literal
-    unsigned int n_cont_clauses;
-    unsigned int c_cont_clauses;
-    ClauseState **cont_clauses;
+    // Array of clauses watching this literal
+    // Initially a slice of the solver's watch pool
+    unsigned int n_watches;
+    unsigned int c_watches;
+    Watch *watches;
+
+    // Binary clauses containing this literal, kept apart from the
+    // others since the blocker is the literal they imply as soon as
+    // this one is false; also a slice of the pool to begin with
+    unsigned int n_binaries;
+    unsigned int c_binaries;
+    Watch *binaries;
 }
 LitState;
 
 void create_lit_state(LitState *);
-void delete_lit_state(LitState *);
 
-// Adds the clause to the array in the LitState
-// Does NOT modify the ClauseState
-void add_cont_clause(LitState *, ClauseState *);
+typedef enum
+{
+    PHASE_UNSET,
+    PHASE_POSITIVE,
+    PHASE_NEGATIVE
+}
+Phase;
+
+typedef struct
+{
+    // Implication level and the clause that forced the assignment
+    // There is no reason for decisions and for level 0 literals
+    unsigned int level;
+    ClauseRef reason;
+
+    // Marks variables already visited during conflict analysis
+    bool seen;
+
+    // Polarity of the most recent assignment
+    Phase phase;
+
+    // Removed from the problem by the preprocessor
+    bool eliminated;
+}
+VarState;
+
+// Marks a variable that is not in the XOR matrix
+#define COLUMN_NONE ((unsigned int) -1)
+
+typedef struct
+{
+    // Variable of each column, and column of each variable
+    // among the first `n_mapped`, or COLUMN_NONE
+    unsigned int n_cols;
+    unsigned int *col_vars;
+    unsigned int n_mapped;
+    unsigned int *var_cols;
+
+    // One XOR constraint per row, as `n_words` words of column bits
+    // and the parity they add up to, kept in reduced row echelon
+    // form where each pivot column is an unassigned variable that
+    // no other row contains
+    unsigned int n_rows;
+    unsigned int n_words;
+    uint64_t *rows;
+    bool *parities;
+    unsigned int *pivots;
+
+    // Columns of the unassigned and of the true variables
+    uint64_t *unassigned;
+    uint64_t *true_cols;
+
+    // Literals of the clause made from a row
+    Literal *lits;
+
+    // Trail position up to which the assignments have been taken
+    // into account, once the rows have been reduced at all
+    unsigned int n_checked;
+    bool reduced;
+}
+XorMatrix;
+
+typedef enum
+{
+    SEARCH_CDCL,
+    SEARCH_DPLL,
+    SEARCH_WALK
+}
+SearchMode;
+
+typedef enum
+{
+    BRANCH_VSIDS,
+    BRANCH_OCCURRENCE
+}
+BranchMode;
+
+typedef enum
+{
+    WALK_PROBSAT,
+    WALK_WALKSAT
+}
+WalkMode;
+
+typedef struct
+{
+    SearchMode search;
+    BranchMode branching;
+
+    // Simplify the clauses before searching
+    bool preprocess;
+
+    // Factor by which variable activities fade after each conflict
+    double activity_decay;
+
+    // Reason about XOR constraints found among the clauses
+    // by Gaussian elimination as well
+    bool gauss;
+
+    // Restart policy and its parameters
+    RestartMode restarts;
+    unsigned int luby_unit;
+    unsigned int lbd_window;
+    double restart_margin;
+
+    // Branch on the polarity a variable last had, and the
+    // polarity tried for variables that have not had one yet
+    bool phase_saving;
+    Phase initial_phase;
+
+    // Local search flips variables by how many clauses they would
+    // break, as ProbSAT or WalkSAT does; besides searching on its
+    // own, it can run for `walk_flips` flips every `walk_interval`
+    // restarts, leaving its best assignment as the saved phases
+    WalkMode walk;
+    unsigned int walk_interval;
+    unsigned int walk_flips;
+
+    // Every `inprocess_interval` conflicts, unless that is zero,
+    // failed literals are probed for and learned clauses vivified
+    // at level 0, for at most `inprocess_effort` times as many
+    // propagations as the search has made since the last time
+    unsigned int inprocess_interval;
+    double inprocess_effort;
+
+    // Breaks ties between equally active variables at random
+    // when nonzero, so that differently seeded solvers diverge
+    unsigned int seed;
+
+    // Conflicts before the first reduction of the learned clauses,
+    // and how much longer each following interval is
+    unsigned int reduce_interval;
+    unsigned int reduce_increment;
+
+    // Learned clauses with at most this LBD are never deleted,
+    // and this fraction of the others is deleted at each reduction
+    unsigned int glue_lbd;
+    double reduce_fraction;
+
+    // Learned clauses passed on to other solvers must be this short
+    // and have at most this LBD, and each restart takes in at most
+    // this many of the clauses passed on by the others
+    bool share_clauses;
+    unsigned int share_max_lits;
+    unsigned int share_max_lbd;
+    unsigned int share_import_limit;
+
+    // The search gives up with an unknown solution after this many
+    // conflicts or propagations, seconds since it began, or once
+    // a solver holds this many megabytes, unless zero
+    uint64_t max_conflicts;
+    uint64_t max_propagations;
+    double max_seconds;
+    unsigned int max_memory;
+
+    // Seconds between progress reports, or zero for none
+    double report_interval;
+}
+SolverConfig;
+
+void default_config(SolverConfig *);
 
 typedef enum
 {
@@ -64,54 +259,280 @@ Solution;
 
 typedef struct
 {
-    // Problem state
+    // Memory behind the arrays below, which is the solver's own
+    // unless it was given a region to share with other solvers
+    Region own_region;
+    Region *region;
+
+    // Problem state, with room for `c_vars` variables
+    // before the per-variable arrays have to grow
     unsigned int n_vars;
-    unsigned int n_clauses;
+    unsigned int c_vars;
     LitState *lits;
-    ClauseState *clauses;
+    VarState *vars;
+
+    // Value of each literal, kept apart from the rest of its state
+    // since a byte is all that propagation reads for most literals
+    signed char *values;
+
+    // Storage for the headers and literals of every clause
+    Offset n_arena;
+    Offset c_arena;
+    Literal *arena;
+
+    // Clauses of the problem
+    unsigned int n_clauses;
+    unsigned int c_clauses;
+    ClauseRef *clauses;
+
+    // Clause currently being built at the end of the arena
+    ClauseRef building;
+
+    // Per-literal marks for scans over a single clause
+    bool *lit_marks;
+
+    // Clauses removed along with eliminated variables, which
+    // are needed to give those variables a value afterwards
+    unsigned int n_eliminated;
+    unsigned int n_elim_lits;
+    unsigned int c_elim_lits;
+    Literal *elim_lits;
+
+    // XOR constraints encoded by the clauses, which propagate
+    // alongside them; the clauses they give as the reason for an
+    // implication or a conflict are learned like any other
+    XorMatrix xors;
+
+    // Clauses derived from conflicts
+    unsigned int n_learnts;
+    unsigned int c_learnts;
+    ClauseRef *learnts;
+
+    // Block holding the initial watch lists of every literal
+    Watch *watch_pool;
+    unsigned int c_watch_pool;
+
+    // Parameters of the search
+    SolverConfig config;
 
     // Used during solver operation
-    unsigned int n_sat_clauses;
-    unsigned int n_unsat_clauses;
-    unsigned int n_units;
+    // Literals in `assigned` before `n_propagated`
+    // have already had their watches visited
     unsigned int n_assigned;
-    Literal *unit_stack;
+    unsigned int n_propagated;
     Literal *assigned;
 
+    // Trail position at which each decision level begins, and
+    // whether its decision is already the second polarity tried
+    unsigned int n_levels;
+    unsigned int *level_starts;
+    bool *level_flipped;
+
+    // Literals decided first, one level each, before any branching
+    unsigned int n_assumptions;
+    Literal *assumptions;
+
+    // Assumptions that together made the last search fail
+    unsigned int n_failed;
+    Literal *failed;
+
+    // Unassigned variables ordered by how often
+    // they have recently been involved in conflicts
+    double *activity;
+    double activity_inc;
+    Heap order;
+
+    // Clause being built by conflict analysis
+    unsigned int n_learnt_lits;
+    Literal *learnt_lits;
+
+    // Marks decision levels already counted in an LBD
+    unsigned int lbd_stamp;
+    unsigned int *level_stamps;
+
+    // Decides when to abandon the current assignment
+    RestartState restarts;
+
+    // Conflict count at which learned clauses are next reduced
+    uint64_t next_reduce;
+    unsigned int reduce_interval;
+
+    // Restart count at which local search next runs, if it does
+    uint64_t next_walk;
+
+    // Conflict count at which inprocessing next runs, if it does,
+    // the propagations made by the end of its last run, and the
+    // literal from which the next run carries on probing
+    uint64_t next_inprocess;
+    uint64_t inprocess_props;
+    Literal probe_cursor;
+
+    // Set by another thread to abandon the search, if any
+    const atomic_bool *stop;
+
+    // Time at which the search gives up, if it has a time limit,
+    // and the iterations left before the clock is next read
+    double deadline;
+    unsigned int poll_countdown;
+
+    // Position among the solvers running side by side
+    unsigned int worker;
+
+    // When the search began and is next reported on, the signals
+    // for a report answered so far, and the state at the last one
+    double report_start;
+    double next_report;
+    unsigned int n_report_requests;
+    double last_report_time;
+    uint64_t last_report_props;
+
+    // Where learned clauses are traded with other solvers, if
+    // anywhere, and how far each of their rings has been read
+    Exchange *exchange;
+    unsigned int exchange_index;
+    unsigned int *import_cursors;
+
+    // Where each step towards unsatisfiability is written, if
+    // anywhere; for LRAT every clause has its identifier in the
+    // `proof_words` words before it, every level 0 assignment from
+    // `n_proved_units` on is still to be derived as a unit clause of
+    // its own, and `hints` collects the clauses a new one follows
+    // from, the earliest of them assigned at `hint_level`
+    Proof *proof;
+    unsigned int proof_words;
+    uint64_t *unit_ids;
+    unsigned int n_proved_units;
+    unsigned int hint_level;
+    unsigned int n_hints;
+    uint64_t *hints;
+
+    // Set once the clauses have been prepared for searching, and
+    // once they are known to be unsatisfiable whatever is assumed
+    bool started;
+    bool inconsistent;
+
     // Solution state
     Solution solution;
 
-    // Performance statistics
-    clock_t start_time;
-    clock_t stop_time;
-    unsigned int t_branches;
-    unsigned int t_unit_props;
+    // Performance statistics, with times in seconds of wall-clock
+    // time; the solving takes from `start_time` to `stop_time`,
+    // of which `preprocess_time` goes on simplifying the clauses
+    double parse_time;
+    double start_time;
+    double stop_time;
+    double preprocess_time;
+    uint64_t t_branches;
+    uint64_t t_unit_props;
+    uint64_t t_conflicts;
+    uint64_t t_restarts;
+    uint64_t t_flips;
+    uint64_t t_failed;
+    uint64_t t_hyper;
+    uint64_t t_vivified;
+    uint64_t t_deleted;
+    uint64_t t_removed;
+    uint64_t t_exported;
+    uint64_t t_imported;
 }
 Solver;
 
-void create_solver(Solver *, unsigned int, unsigned int);
+// Solvers take a private copy of the clauses of the problem,
+// since watching them moves their literals around
+void create_solver(Solver *, const Problem *);
 void delete_solver(Solver *);
 
-void add_literal_to_clause(Solver *, ClauseState *, Literal);
+// Allocates from a region kept by the caller instead, which can be
+// reset once the solver is deleted to serve the next one
+void create_solver_in(Solver *, const Problem *, Region *);
+
+// Whether offsets into the clause arena can reach every clause
+// of the problem, which is only in doubt without -Dwide_index
+bool fits_in_arena(const Problem *);
+
+// Writes a proof of what the search derives, which for LRAT
+// numbers the clauses of the problem first; this must be done
+// before the search begins
+void attach_proof(Solver *, Proof *);
+
+// Adds variables to the problem, even once the search has begun
+void reserve_vars(Solver *, unsigned int);
+
+ClauseState *get_clause(const Solver *, ClauseRef);
+ClauseRef alloc_clause(Solver *, unsigned int);
+void add_clause(Solver *, const Literal *, unsigned int);
+
+// Clauses can also be built in place, one literal at a time
+void start_clause(Solver *);
+void push_literal(Solver *, Literal);
+void finish_clause(Solver *);
+
+// Adds a clause between searches, keeping what has been learned;
+// the problem must not have been preprocessed
+void insert_clause(Solver *, const Literal *, unsigned int);
+
+void add_watch(Solver *, Literal, ClauseRef, Literal);
+void add_binary(Solver *, Literal, ClauseRef, Literal);
+
+// Watches the first two literals of a clause, or
+// adds both implications of a binary clause
+void watch_clause(Solver *, ClauseRef);
+void attach_watches(Solver *);
 
 Literal choose_branch(Solver *);
 void update_scores(Solver *);
 
-void add_true_assignment(Solver *, ClauseState *);
-void add_false_assignment(Solver *, ClauseState *);
-void undo_true_assignment(Solver *, ClauseState *);
-void undo_false_assignment(Solver *, ClauseState *);
+// Variable that most shortens clauses whichever way it is set,
+// given in the polarity that occurs more often
+Literal choose_lookahead(Solver *);
 
-Literal get_unit(const Solver *, const ClauseState *);
+void bump_activity(Solver *, unsigned int);
+void decay_activities(Solver *);
 
 void make_assignment(Solver *, Literal);
 void undo_assignment(Solver *, Literal);
 
+void assign_literal(Solver *, Literal, ClauseRef);
+void backtrack(Solver *, unsigned int);
+
+ClauseRef propagate(Solver *);
+
+unsigned int analyze_conflict(Solver *, ClauseRef);
+unsigned int compute_lbd(Solver *, const Literal *, unsigned int);
+void learn_clause(Solver *, unsigned int);
+
+bool clause_locked(const Solver *, ClauseRef);
+void reduce_learnts(Solver *);
+void collect_garbage(Solver *);
+
+void join_exchange(Solver *, Exchange *, unsigned int);
+bool import_clauses(Solver *);
+
+void make_decision(Solver *, Literal);
+bool backjump(Solver *, ClauseRef);
+bool flip_decision(Solver *);
+void restart(Solver *);
+
+// Prepares the clauses for searching, returning false
+// if they turn out to be unsatisfiable along the way
+bool start_search(Solver *);
+
+Solution solve(Solver *);
+
+// Searches for a solution in which the given literals are true,
+// where unsatisfiability only rules out the problem as a whole
+// if `inconsistent` is set afterwards
+Solution solve_assuming(Solver *, const Literal *, unsigned int);
+
 Solution search_assignments(Solver *);
-Solution try_assignment(Solver *, Literal);
+
+// Whether another solver has found the answer or this one has used
+// up what it was allowed, writing any reports that are due
+bool search_interrupted(Solver *);
+
+// Collects the assumptions responsible for the given one being false
+void analyze_final(Solver *, Literal);
 
 bool all_satisfied(const Solver *);
-bool any_contradiction(const Solver *);
 
 #endif
 
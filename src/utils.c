@@ -6,6 +6,8 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/resource.h>
+#include <time.h>
 
 #include "constants.h"
 
@@ -33,3 +35,23 @@ void *xrealloc(void *ptr, size_t new_size)
     return new_ptr;
 }
 
+double wall_time(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+size_t peak_memory(void)
+{
+    struct rusage usage;
+
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+
+    // Linux gives the resident set size in kilobytes
+    return (size_t) usage.ru_maxrss * 1024;
+}
+
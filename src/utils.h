@@ -8,6 +8,12 @@
 void *xmalloc(size_t);
 void *xrealloc(void *, size_t);
 
+// Seconds elapsed on a clock that only ever moves forward
+double wall_time(void);
+
+// Most memory the process has held at once, in bytes
+size_t peak_memory(void);
+
 #define CREATE_ARRAY(A, S) A = xmalloc((S) * sizeof(*A))
 #define RESIZE_ARRAY(A, N) A = xrealloc(A, (N) * sizeof(*A))
 #define DELETE_ARRAY(A)    free(A);
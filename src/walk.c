@@ -0,0 +1,513 @@
+
+#include "walk.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "solver.h"
+#include "utils.h"
+
+// Break counts past this all get the same tiny probability
+#define MAX_BREAK 32
+
+// Chance that WalkSAT flips a variable at random rather than
+// the one breaking the fewest clauses, as a fraction of 1024
+#define WALKSAT_NOISE 580
+
+typedef struct
+{
+    Solver *solver;
+
+    // Clauses not already satisfied at level 0, by their offset in
+    // the solver's arena, and the longest of them
+    unsigned int n_clauses;
+    ClauseRef *clauses;
+    unsigned int max_lits;
+
+    // Number of true literals in each clause, and the exclusive or
+    // of their variables, which is the variable of the only true
+    // literal when there is just one
+    unsigned int *n_true;
+    unsigned int *true_vars;
+
+    // Clauses containing each literal that is not fixed at level 0,
+    // as a slice of `occurs` from `occur_starts[lit]`
+    Offset *occur_starts;
+    unsigned int *occurs;
+
+    // Current value of each variable, and how many clauses would be
+    // left with no true literal if it were flipped
+    bool *values;
+    unsigned int *breaks;
+
+    // Clauses with no true literal, and the position of each in the
+    // list while it is there
+    unsigned int n_unsat;
+    unsigned int *unsat;
+    unsigned int *unsat_pos;
+
+    // Assignment with the fewest unsatisfied clauses so far, apart
+    // from the variables flipped since, unless too many have been
+    unsigned int best_unsat;
+    bool *best;
+    unsigned int n_flipped;
+    unsigned int *flipped;
+    bool overflowed;
+
+    // ProbSAT's weight for each break count, which falls off
+    // faster the longer the clauses are
+    double weights[MAX_BREAK + 1];
+    double *scores;
+
+    unsigned int random;
+}
+Walker;
+
+static void create_walker(Walker *, Solver *, bool);
+static void delete_walker(Walker *);
+
+static unsigned int next_random(Walker *);
+static bool is_true(const Walker *, Literal);
+
+static void add_unsat(Walker *, unsigned int);
+static void remove_unsat(Walker *, unsigned int);
+static void flip(Walker *, unsigned int);
+static void save_best(Walker *);
+
+static unsigned int pick_probsat(Walker *, const ClauseState *);
+static unsigned int pick_walksat(Walker *, const ClauseState *);
+
+bool walk(Solver *solver, uint64_t max_flips, bool random_start)
+{
+    Walker walker;
+    uint64_t n_flips = 0;
+    bool satisfied;
+    unsigned int var;
+
+    assert(solver->n_levels == 0);
+
+    create_walker(&walker, solver, random_start);
+
+    while (walker.n_unsat > 0) {
+
+        unsigned int index;
+        const ClauseState *cstate;
+
+        if ((max_flips != 0 && n_flips == max_flips) ||
+            search_interrupted(solver)) {
+            break;
+        }
+
+        // Every clause left unsatisfied has to be fixed somehow,
+        // so it does not matter much which one is looked at
+        index = walker.unsat[next_random(&walker) % walker.n_unsat];
+        cstate = get_clause(solver, walker.clauses[index]);
+
+        if (solver->config.walk == WALK_PROBSAT) {
+            var = pick_probsat(&walker, cstate);
+        } else {
+            var = pick_walksat(&walker, cstate);
+        }
+
+        flip(&walker, var);
+        n_flips += 1;
+
+        if (walker.n_unsat < walker.best_unsat) {
+            save_best(&walker);
+        }
+    }
+
+    solver->t_flips += n_flips;
+
+    // The complete search carries on from the best assignment
+    for (var = 0; var < solver->n_vars; ++var) {
+        if (solver->values[var << 1] == VALUE_UNSET &&
+            ! solver->vars[var].eliminated) {
+            solver->vars[var].phase = walker.best[var] ? PHASE_POSITIVE :
+                                                         PHASE_NEGATIVE;
+        }
+    }
+
+    satisfied = walker.best_unsat == 0;
+    delete_walker(&walker);
+
+    return satisfied;
+}
+
+static void create_walker(Walker *walker, Solver *solver, bool random_start)
+{
+    unsigned int n_lits = solver->n_vars << 1;
+    Offset n_occurs;
+    double base;
+    unsigned int i;
+    unsigned int j;
+
+    walker->solver = solver;
+
+    // Differ from one run to the next, but not from one process
+    // to the next
+    walker->random = (solver->config.seed + 1) * 2654435761u ^
+                     (unsigned int) solver->t_flips;
+    if (walker->random == 0) {
+        walker->random = 1;
+    }
+
+    /*
+     * 1. Count the occurrences of each literal
+     */
+
+    CREATE_ARRAY(walker->clauses, solver->n_clauses);
+    CREATE_ARRAY(walker->occur_starts, n_lits + 1);
+    for (i = 0; i <= n_lits; ++i) {
+        walker->occur_starts[i] = 0;
+    }
+
+    walker->n_clauses = 0;
+    walker->max_lits = 0;
+    n_occurs = 0;
+
+    for (i = 0; i < solver->n_clauses; ++i) {
+
+        ClauseRef ref = solver->clauses[i];
+        const ClauseState *cstate = get_clause(solver, ref);
+        unsigned int n_free = 0;
+
+        for (j = 0; j < cstate->n_lits; ++j) {
+            Literal lit = cstate->lits[j];
+            if (solver->values[lit] == VALUE_TRUE) {
+                break;
+            } else if (solver->values[lit] == VALUE_UNSET) {
+                n_free += 1;
+            }
+        }
+
+        // Clauses satisfied at level 0 stay satisfied
+        if (j < cstate->n_lits) {
+            continue;
+        }
+
+        for (j = 0; j < cstate->n_lits; ++j) {
+            Literal lit = cstate->lits[j];
+            if (solver->values[lit] == VALUE_UNSET) {
+                walker->occur_starts[lit + 1] += 1;
+            }
+        }
+
+        walker->clauses[walker->n_clauses++] = ref;
+        if (n_free > walker->max_lits) {
+            walker->max_lits = n_free;
+        }
+        n_occurs += n_free;
+    }
+
+    /*
+     * 2. Gather the clauses containing each literal
+     */
+
+    for (i = 0; i < n_lits; ++i) {
+        walker->occur_starts[i + 1] += walker->occur_starts[i];
+    }
+
+    CREATE_ARRAY(walker->occurs, n_occurs + 1);
+    for (i = 0; i < walker->n_clauses; ++i) {
+        const ClauseState *cstate = get_clause(solver, walker->clauses[i]);
+        for (j = 0; j < cstate->n_lits; ++j) {
+            Literal lit = cstate->lits[j];
+            if (solver->values[lit] == VALUE_UNSET) {
+                walker->occurs[walker->occur_starts[lit]++] = i;
+            }
+        }
+    }
+
+    // Filling the slices moved each start to the next one's
+    for (i = n_lits; i > 0; --i) {
+        walker->occur_starts[i] = walker->occur_starts[i - 1];
+    }
+    walker->occur_starts[0] = 0;
+
+    /*
+     * 3. Start from the saved phases, or from a random assignment
+     */
+
+    CREATE_ARRAY(walker->values, solver->n_vars);
+    CREATE_ARRAY(walker->breaks, solver->n_vars);
+    CREATE_ARRAY(walker->best, solver->n_vars);
+
+    for (i = 0; i < solver->n_vars; ++i) {
+
+        Phase phase = solver->vars[i].phase;
+
+        if (solver->values[i << 1] != VALUE_UNSET) {
+            walker->values[i] = solver->values[i << 1] == VALUE_TRUE;
+        } else if (random_start) {
+            walker->values[i] = next_random(walker) & 1;
+        } else if (phase != PHASE_UNSET) {
+            walker->values[i] = phase == PHASE_POSITIVE;
+        } else {
+            walker->values[i] =
+                solver->config.initial_phase == PHASE_POSITIVE;
+        }
+
+        walker->breaks[i] = 0;
+        walker->best[i] = walker->values[i];
+    }
+
+    /*
+     * 4. Count the true literals of each clause
+     */
+
+    CREATE_ARRAY(walker->n_true, walker->n_clauses);
+    CREATE_ARRAY(walker->true_vars, walker->n_clauses);
+    CREATE_ARRAY(walker->unsat, walker->n_clauses);
+    CREATE_ARRAY(walker->unsat_pos, walker->n_clauses);
+    walker->n_unsat = 0;
+
+    for (i = 0; i < walker->n_clauses; ++i) {
+
+        const ClauseState *cstate = get_clause(solver, walker->clauses[i]);
+
+        walker->n_true[i] = 0;
+        walker->true_vars[i] = 0;
+
+        for (j = 0; j < cstate->n_lits; ++j) {
+            Literal lit = cstate->lits[j];
+            if (solver->values[lit] == VALUE_UNSET && is_true(walker, lit)) {
+                walker->n_true[i] += 1;
+                walker->true_vars[i] ^= var_from_lit(lit);
+            }
+        }
+
+        if (walker->n_true[i] == 0) {
+            add_unsat(walker, i);
+        } else if (walker->n_true[i] == 1) {
+            walker->breaks[walker->true_vars[i]] += 1;
+        }
+    }
+
+    walker->best_unsat = walker->n_unsat;
+    walker->n_flipped = 0;
+    CREATE_ARRAY(walker->flipped, solver->n_vars);
+    walker->overflowed = false;
+
+    /*
+     * 5. Weigh the break counts for the length of the clauses
+     */
+
+    // These bases are those that ProbSAT found to work best on
+    // random problems with clauses of three, five and seven literals
+    if (n_occurs <= 3 * (uint64_t) walker->n_clauses) {
+        base = 2.5;
+    } else if (n_occurs <= 4 * (uint64_t) walker->n_clauses) {
+        base = 3.1;
+    } else if (n_occurs <= 5 * (uint64_t) walker->n_clauses) {
+        base = 3.7;
+    } else {
+        base = 5.4;
+    }
+
+    walker->weights[0] = 1.0;
+    for (i = 1; i <= MAX_BREAK; ++i) {
+        walker->weights[i] = walker->weights[i - 1] / base;
+    }
+
+    CREATE_ARRAY(walker->scores, walker->max_lits + 1);
+}
+
+static void delete_walker(Walker *walker)
+{
+    DELETE_ARRAY(walker->clauses);
+    DELETE_ARRAY(walker->occur_starts);
+    DELETE_ARRAY(walker->occurs);
+    DELETE_ARRAY(walker->values);
+    DELETE_ARRAY(walker->breaks);
+    DELETE_ARRAY(walker->best);
+    DELETE_ARRAY(walker->n_true);
+    DELETE_ARRAY(walker->true_vars);
+    DELETE_ARRAY(walker->unsat);
+    DELETE_ARRAY(walker->unsat_pos);
+    DELETE_ARRAY(walker->flipped);
+    DELETE_ARRAY(walker->scores);
+}
+
+static unsigned int next_random(Walker *walker)
+{
+    unsigned int state = walker->random;
+
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+
+    walker->random = state;
+    return state;
+}
+
+static bool is_true(const Walker *walker, Literal lit)
+{
+    return walker->values[var_from_lit(lit)] != (lit & 1);
+}
+
+static void add_unsat(Walker *walker, unsigned int index)
+{
+    walker->unsat_pos[index] = walker->n_unsat;
+    walker->unsat[walker->n_unsat++] = index;
+}
+
+static void remove_unsat(Walker *walker, unsigned int index)
+{
+    // The last clause in the list takes the place of this one
+    unsigned int last = walker->unsat[--walker->n_unsat];
+
+    walker->unsat[walker->unsat_pos[index]] = last;
+    walker->unsat_pos[last] = walker->unsat_pos[index];
+}
+
+static void flip(Walker *walker, unsigned int var)
+{
+    Literal made_true;
+    Literal made_false;
+    Offset i;
+    Offset end;
+
+    walker->values[var] = ! walker->values[var];
+    made_true = walker->values[var] ? var << 1 : (var << 1) | 1;
+    made_false = negate(made_true);
+
+    // Clauses gaining a true literal, which this variable is the only
+    // one of if there were none before; otherwise the variable that
+    // was the only one no longer breaks the clause
+    end = walker->occur_starts[made_true + 1];
+    for (i = walker->occur_starts[made_true]; i < end; ++i) {
+        unsigned int index = walker->occurs[i];
+        unsigned int n_true = walker->n_true[index]++;
+        if (n_true == 0) {
+            remove_unsat(walker, index);
+            walker->breaks[var] += 1;
+        } else if (n_true == 1) {
+            walker->breaks[walker->true_vars[index]] -= 1;
+        }
+        walker->true_vars[index] ^= var;
+    }
+
+    // Clauses losing a true literal, which leaves them either
+    // unsatisfied or at the mercy of their last true literal
+    end = walker->occur_starts[made_false + 1];
+    for (i = walker->occur_starts[made_false]; i < end; ++i) {
+        unsigned int index = walker->occurs[i];
+        unsigned int n_true = --walker->n_true[index];
+        walker->true_vars[index] ^= var;
+        if (n_true == 0) {
+            add_unsat(walker, index);
+            walker->breaks[var] -= 1;
+        } else if (n_true == 1) {
+            walker->breaks[walker->true_vars[index]] += 1;
+        }
+    }
+
+    // Past one flip per variable, copying the whole assignment
+    // is no more work than replaying the flips
+    if (walker->n_flipped < walker->solver->n_vars) {
+        walker->flipped[walker->n_flipped++] = var;
+    } else {
+        walker->overflowed = true;
+    }
+}
+
+static void save_best(Walker *walker)
+{
+    unsigned int i;
+
+    if (walker->overflowed) {
+        for (i = 0; i < walker->solver->n_vars; ++i) {
+            walker->best[i] = walker->values[i];
+        }
+    } else {
+        for (i = 0; i < walker->n_flipped; ++i) {
+            unsigned int var = walker->flipped[i];
+            walker->best[var] = walker->values[var];
+        }
+    }
+
+    walker->best_unsat = walker->n_unsat;
+    walker->n_flipped = 0;
+    walker->overflowed = false;
+}
+
+static unsigned int pick_probsat(Walker *walker, const ClauseState *cstate)
+{
+    const signed char *values = walker->solver->values;
+    double total = 0.0;
+    double target;
+    unsigned int n_free = 0;
+    unsigned int last = 0;
+    unsigned int i;
+
+    // Each variable is picked with a probability that falls off
+    // exponentially with the number of clauses it would break
+    for (i = 0; i < cstate->n_lits; ++i) {
+        Literal lit = cstate->lits[i];
+        if (values[lit] == VALUE_UNSET) {
+            unsigned int breaks = walker->breaks[var_from_lit(lit)];
+            double score = walker->weights[breaks < MAX_BREAK ?
+                                           breaks : MAX_BREAK];
+            walker->scores[n_free++] = score;
+            total += score;
+        }
+    }
+
+    target = (next_random(walker) >> 8) * (total / 16777216.0);
+
+    n_free = 0;
+    for (i = 0; i < cstate->n_lits; ++i) {
+        Literal lit = cstate->lits[i];
+        if (values[lit] == VALUE_UNSET) {
+            last = var_from_lit(lit);
+            target -= walker->scores[n_free++];
+            if (target < 0.0) {
+                break;
+            }
+        }
+    }
+
+    // Rounding may leave a sliver for the last variable
+    return last;
+}
+
+static unsigned int pick_walksat(Walker *walker, const ClauseState *cstate)
+{
+    const signed char *values = walker->solver->values;
+    unsigned int best_var = 0;
+    unsigned int best_breaks = (unsigned int) -1;
+    unsigned int n_free = 0;
+    unsigned int choice;
+    unsigned int i;
+
+    for (i = 0; i < cstate->n_lits; ++i) {
+        Literal lit = cstate->lits[i];
+        if (values[lit] == VALUE_UNSET) {
+            unsigned int var = var_from_lit(lit);
+            n_free += 1;
+            if (walker->breaks[var] < best_breaks) {
+                best_breaks = walker->breaks[var];
+                best_var = var;
+            }
+        }
+    }
+
+    // A flip that breaks nothing is always taken, and otherwise
+    // some noise keeps the search from going round in circles
+    if (best_breaks == 0 ||
+        (next_random(walker) & 1023) >= WALKSAT_NOISE) {
+        return best_var;
+    }
+
+    choice = next_random(walker) % n_free;
+    for (i = 0; i < cstate->n_lits; ++i) {
+        Literal lit = cstate->lits[i];
+        if (values[lit] == VALUE_UNSET && choice-- == 0) {
+            return var_from_lit(lit);
+        }
+    }
+
+    return best_var;
+}
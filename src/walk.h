@@ -0,0 +1,19 @@
+
+#ifndef SIMPLESAT_WALK_H
+#define SIMPLESAT_WALK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "solver.h"
+
+// Looks for an assignment satisfying the clauses of the problem by
+// flipping one variable at a time, starting from the saved phases,
+// or at random if `random_start` is set; gives up after `max_flips`
+// flips unless that is zero, or once the search is interrupted
+// The best assignment found is left as the saved phases, and true is
+// returned if it satisfies every clause; the solver must be at level 0
+bool walk(Solver *, uint64_t, bool);
+
+#endif
+
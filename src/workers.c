@@ -0,0 +1,76 @@
+
+#include "workers.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "constants.h"
+#include "utils.h"
+
+unsigned int start_threads(pthread_t *threads,
+                           void *(*run)(void *),
+                           void *tasks,
+                           size_t size,
+                           unsigned int first,
+                           unsigned int end)
+{
+    unsigned int i;
+
+    for (i = first; i < end; ++i) {
+        int status = pthread_create(&threads[i], NULL, run,
+                                    (char *) tasks + i * size);
+        if (status != 0) {
+            fprintf(stderr, PROGRAM_NAME ": Cannot start thread: %s\n",
+                    strerror(status));
+            break;
+        }
+    }
+
+    return i;
+}
+
+void join_threads(pthread_t *threads, unsigned int first, unsigned int end)
+{
+    unsigned int i;
+
+    for (i = first; i < end; ++i) {
+        pthread_join(threads[i], NULL);
+    }
+}
+
+unsigned int run_workers(void *(*run)(void *),
+                         void *tasks,
+                         size_t size,
+                         unsigned int n_tasks)
+{
+    pthread_t *threads;
+    unsigned int n_started;
+
+    CREATE_ARRAY(threads, n_tasks);
+
+    n_started = start_threads(threads, run, tasks, size, 1, n_tasks);
+    run(tasks);
+    join_threads(threads, 1, n_started);
+
+    DELETE_ARRAY(threads);
+
+    return n_started;
+}
+
+bool claim_winner(atomic_uint *winner, atomic_bool *stop, unsigned int index)
+{
+    unsigned int none = WINNER_NONE;
+
+    // Only the first answer counts, the rest were cut short
+    if (atomic_compare_exchange_strong(winner, &none, index)) {
+        atomic_store(stop, true);
+        return true;
+    }
+
+    return false;
+}
+
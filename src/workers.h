@@ -0,0 +1,37 @@
+
+#ifndef SIMPLESAT_WORKERS_H
+#define SIMPLESAT_WORKERS_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Marks the winner among workers as not yet decided
+#define WINNER_NONE ((unsigned int) -1)
+
+// Starts a thread running each of the tasks from the first given up
+// to the last, which lie `size` bytes apart, and stops at the first
+// that cannot be started, giving the index of that one or the end;
+// the workers that did start are left to take over the work of
+// the others, so failing to start one is not an error
+unsigned int start_threads(pthread_t *,
+                           void *(*)(void *),
+                           void *,
+                           size_t,
+                           unsigned int,
+                           unsigned int);
+void join_threads(pthread_t *, unsigned int, unsigned int);
+
+// Runs every task but the first on a thread of its own, and the first
+// on the calling thread, until all of them are done, giving how many
+// of them ran
+unsigned int run_workers(void *(*)(void *), void *, size_t, unsigned int);
+
+// Makes the worker the winner unless another one already is, in which
+// case its answer was found after the others were told to stop and is
+// not taken; the others are told to stop once there is a winner
+bool claim_winner(atomic_uint *, atomic_bool *, unsigned int);
+
+#endif
+
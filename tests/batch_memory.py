@@ -0,0 +1,72 @@
+#!/usr/bin/env python3
+
+"""Checks that the memory budget of a batch applies to each instance alone.
+
+A large generated instance is solved first, with a budget it cannot keep
+to, and then small instances from cnf/ that need next to no memory. The
+large one must run out, and the small ones must still be solved.
+"""
+
+import argparse
+import os
+import random
+import subprocess
+import sys
+import tempfile
+
+# Small enough for the large instance to go over, and far more than
+# any of the small ones need
+MAX_MEMORY = 20
+
+SMALL = ['cnf/quinn.cnf', 'cnf/jnh1.cnf']
+
+
+def write_large(path, n_vars=400000, n_clauses=1200000):
+    # Random 3-SAT well below the threshold, which is satisfiable but
+    # takes a branch for most variables, so the budget is looked at
+    rng = random.Random(1)
+    with open(path, 'w') as stream:
+        stream.write('p cnf %d %d\n' % (n_vars, n_clauses))
+        for _ in range(n_clauses):
+            lits = rng.sample(range(1, n_vars + 1), 3)
+            stream.write(' '.join(str(v if rng.random() < 0.5 else -v)
+                                  for v in lits) + ' 0\n')
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument('--solver', required=True)
+    parser.add_argument('--root', required=True)
+    args = parser.parse_args()
+
+    with tempfile.TemporaryDirectory() as tmp:
+        large = os.path.join(tmp, 'large.cnf')
+        write_large(large)
+
+        files = [large] + [os.path.join(args.root, f) for f in SMALL]
+        result = subprocess.run([args.solver, '--batch', '--threads', '1',
+                                 '--max-memory', str(MAX_MEMORY)] + files,
+                                capture_output=True, text=True)
+
+    if result.returncode != 0:
+        print(result.stderr, end='')
+        return 1
+
+    status = {}
+    for line in result.stdout.splitlines():
+        fields = line.split('\t')
+        status[fields[0]] = fields[1]
+
+    failed = False
+    for path in files:
+        expected = 'UNKNOWN' if path == large else 'SATISFIABLE'
+        got = status.get(path)
+        if got != expected:
+            print('%s: expected %s, got %s' % (path, expected, got))
+            failed = True
+
+    return 1 if failed else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,96 @@
+
+// Checks the incremental API in simplesat.h as a program using the
+// library would: clauses added between searches, assumptions that
+// last for one search, the assumptions a failure is blamed on, and
+// the values given to variables that were never mentioned
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "simplesat.h"
+
+#define CHECK(C) check(C, #C, __LINE__)
+
+static int n_failed = 0;
+
+static void check(int condition, const char *text, int line)
+{
+    if (! condition) {
+        fprintf(stderr, "incremental.c:%d: %s\n", line, text);
+        n_failed += 1;
+    }
+}
+
+static void add_clause(SimpleSAT *sat, const int *lits)
+{
+    for (; *lits != 0; ++lits) {
+        simplesat_add(sat, *lits);
+    }
+    simplesat_add(sat, 0);
+}
+
+int main(void)
+{
+    SimpleSAT *sat = simplesat_create();
+
+    /*
+     * 1. No clauses at all, and no variables either
+     */
+
+    CHECK(simplesat_solve(sat) == SIMPLESAT_SATISFIABLE);
+    CHECK(simplesat_value(sat, 1) == 0);
+
+    /*
+     * 2. Clauses added between searches, with a gap in the numbering
+     */
+
+    add_clause(sat, (int []) {2, 3, 0});
+    add_clause(sat, (int []) {-2, 5, 0});
+
+    CHECK(simplesat_solve(sat) == SIMPLESAT_SATISFIABLE);
+    CHECK(simplesat_value(sat, 2) == 2 || simplesat_value(sat, 2) == -2);
+    CHECK(simplesat_value(sat, 2) < 0 || simplesat_value(sat, 5) == 5);
+    CHECK(simplesat_value(sat, 2) > 0 || simplesat_value(sat, 3) == 3);
+
+    // Variables below the largest, or past it, were never mentioned
+    CHECK(simplesat_value(sat, 1) == 0);
+    CHECK(simplesat_value(sat, -4) == 0);
+    CHECK(simplesat_value(sat, 9) == 0);
+
+    /*
+     * 3. Assumptions, which only hold for the next search
+     */
+
+    simplesat_assume(sat, 2);
+    simplesat_assume(sat, -5);
+    simplesat_assume(sat, 7);
+    CHECK(simplesat_solve(sat) == SIMPLESAT_UNSATISFIABLE);
+    CHECK(simplesat_failed(sat, 2) || simplesat_failed(sat, -5));
+    CHECK(! simplesat_failed(sat, 7));
+
+    simplesat_assume(sat, -2);
+    simplesat_assume(sat, 7);
+    CHECK(simplesat_solve(sat) == SIMPLESAT_SATISFIABLE);
+    CHECK(simplesat_value(sat, 2) == -2);
+    CHECK(simplesat_value(sat, 3) == 3);
+    CHECK(simplesat_value(sat, 7) == 7);
+
+    CHECK(simplesat_solve(sat) == SIMPLESAT_SATISFIABLE);
+
+    /*
+     * 4. Clauses that leave no way out, under no assumptions at all
+     */
+
+    add_clause(sat, (int []) {-3, 0});
+    add_clause(sat, (int []) {-5, 0});
+
+    simplesat_assume(sat, 3);
+    CHECK(simplesat_solve(sat) == SIMPLESAT_UNSATISFIABLE);
+
+    CHECK(simplesat_solve(sat) == SIMPLESAT_UNSATISFIABLE);
+    CHECK(! simplesat_failed(sat, 3));
+
+    simplesat_delete(sat);
+
+    return n_failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
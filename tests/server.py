@@ -0,0 +1,143 @@
+#!/usr/bin/env python3
+
+"""Checks the answers of a server on a Unix socket to each kind of request.
+
+The same instance is solved twice, for the second answer to come from the
+cache, and clauses are added to it by its id and to an id never given out.
+Requests that are too large or cannot be read must be turned away.
+"""
+
+import argparse
+import os
+import signal
+import socket
+import subprocess
+import sys
+import tempfile
+import time
+
+# Small enough for a request to go over without sending it all
+MAX_REQUEST = 1
+
+INSTANCE = 'cnf/quinn.cnf'
+
+# Makes any instance unsatisfiable
+ADDED = b'p cnf 1 2\n1 0\n-1 0\n'
+
+
+def connect(path):
+    for _ in range(100):
+        try:
+            sock = socket.socket(socket.AF_UNIX)
+            sock.connect(path)
+            return sock
+        except OSError:
+            sock.close()
+            time.sleep(0.05)
+    raise RuntimeError('server did not start')
+
+
+def request(path, line, payload=b''):
+    # Each request has a connection of its own, which is closed for
+    # writing once sent so that a missing payload is seen at once
+    sock = connect(path)
+    sock.sendall(line + payload)
+    sock.shutdown(socket.SHUT_WR)
+    answer = b''
+    while True:
+        data = sock.recv(65536)
+        if not data:
+            break
+        answer += data
+    sock.close()
+    return answer.decode()
+
+
+def field(answer, prefix):
+    for line in answer.splitlines():
+        if line.startswith(prefix):
+            return line[len(prefix):]
+    return None
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument('--solver', required=True)
+    parser.add_argument('--root', required=True)
+    args = parser.parse_args()
+
+    with open(os.path.join(args.root, INSTANCE), 'rb') as stream:
+        instance = stream.read()
+
+    failed = []
+
+    def expect(name, answer, status, comment=None):
+        if field(answer, 's ') != status or \
+           (comment is not None and field(answer, 'c ') != comment):
+            failed.append('%s: got %r' % (name, answer[:200]))
+
+    with tempfile.TemporaryDirectory() as tmp:
+        path = os.path.join(tmp, 'simplesat.sock')
+        server = subprocess.Popen([args.solver, '--serve', path,
+                                   '--threads', '1',
+                                   '--max-request', str(MAX_REQUEST)],
+                                  stdout=subprocess.PIPE,
+                                  stderr=subprocess.PIPE, text=True)
+        try:
+            solve = b'solve %d\n' % len(instance)
+
+            first = request(path, solve, instance)
+            expect('solve', first, 'SATISFIABLE')
+            second = request(path, solve, instance)
+            expect('solve again', second, 'SATISFIABLE')
+
+            key = field(first, 'c id ')
+            if key is None or field(second, 'c id ') != key:
+                failed.append('solve again: id %r, then %r'
+                              % (key, field(second, 'c id ')))
+                key = '0'
+
+            added = request(path, b'add %s %d\n' % (key.encode(),
+                                                    len(ADDED)), ADDED)
+            expect('add', added, 'UNSATISFIABLE')
+
+            # An id no other answer has given, unless by a collision
+            unknown = '%016x' % (int(key, 16) ^ 1)
+            answer = request(path, b'add %s %d\n' % (unknown.encode(),
+                                                     len(ADDED)), ADDED)
+            expect('add unknown', answer, 'ERROR', 'Unknown instance')
+
+            size = (MAX_REQUEST << 20) + 1
+            answer = request(path, b'solve %d\n' % size)
+            expect('too large', answer, 'ERROR', 'Instance too large')
+
+            answer = request(path, b'solve some clauses\n', instance)
+            expect('malformed', answer, 'ERROR', 'Invalid request')
+        finally:
+            server.send_signal(signal.SIGTERM)
+            try:
+                output, errors = server.communicate(timeout=30)
+            except subprocess.TimeoutExpired:
+                server.kill()
+                output, errors = server.communicate()
+                failed.append('server did not stop')
+
+    # One line for each request answered, in the order they finished
+    log = [line.split('\t') for line in output.splitlines()]
+    sources = [fields[3] for fields in log if len(fields) == 4]
+    if sources[:2] != ['solved', 'cached']:
+        failed.append('log: expected solved then cached, got %r'
+                      % sources[:2])
+
+    if server.returncode != 0:
+        failed.append('server exited with %d: %s'
+                      % (server.returncode, errors))
+
+    for message in failed:
+        print(message)
+
+    return 1 if failed else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())